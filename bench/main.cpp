@@ -0,0 +1,565 @@
+#include "logger/Logger.h"
+#include "logger/LogSinks.h"
+#include "mt_api/MockMTAPI.h"
+#include "mt_api/NullBroker.h"
+#include "processor/DealProcessor.h"
+#include "config/ConfigFile.h"
+#include "processor/RuleEngine.h"
+#include "persistence/StateJournal.h"
+#include "perf/SamplingProfiler.h"
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <iomanip>
+#include <atomic>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+
+/// ============================================================================
+/// MT5 Deal Processor - Benchmarks
+/// ============================================================================
+///
+/// Micro- and pipeline benchmarks, kept out of the demo executable. Each
+/// runs against mocked or null brokers and prints one table:
+///
+///   --dispatch              Virtual vs. statically-dispatched broker calls
+///   --validate              Per-request vs. batched validation, rules, calendar
+///   --throughput [workers]  Processor ceiling against a null broker
+///   --io                    Log file and journal I/O: syscalls vs. io_uring
+/// ============================================================================
+
+void runDispatchBenchmark();
+void runValidationBenchmark();
+void runThroughputBenchmark(int numWorkers);
+void runIoBenchmark();
+
+int main(int argc, char* argv[]) {
+    bool ran = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--dispatch") {
+            runDispatchBenchmark();
+        } else if (arg == "--validate") {
+            runValidationBenchmark();
+        } else if (arg == "--io") {
+            runIoBenchmark();
+        } else if (arg == "--throughput") {
+            int workers = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                workers = std::max(1, std::atoi(argv[++i]));
+            }
+            runThroughputBenchmark(workers);
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return 1;
+        }
+        ran = true;
+    }
+    if (!ran) {
+        std::cerr << "Usage: " << argv[0] << " [--dispatch] [--validate] [--throughput [workers]] [--io]\n";
+        return 1;
+    }
+    return 0;
+}
+
+/// Times `requests` through a processor instantiated over Broker, synchronously
+/// on this thread. Returns nanoseconds per request.
+template <typename Broker>
+double timeDispatch(Broker& api, Logger& logger, const std::vector<TradeRequest>& requests) {
+    BasicDealProcessor<Broker> processor(api, logger);
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& request : requests) {
+        processor.process(request);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / requests.size();
+}
+
+/// Dispatch benchmark: virtual (IMTBrokerAPI&) vs. static (MockMTAPI&) broker
+/// calls through the full validate -> execute -> track pipeline, with the mock
+/// configured for zero latency, no failures and unlimited margin.
+void runDispatchBenchmark() {
+    const int NUM_REQUESTS = 200000;
+    const int ROUNDS       = 5;
+
+    Logger quiet("", LogLevel::ERROR);   // console only, errors only
+
+    const char* symbols[] = {"EURUSD", "GBPUSD", "USDJPY", "AUDUSD", "USDCAD", "XAUUSD"};
+    auto makeRequests = [&](const std::string& clientId) {
+        RequestIdSequence ids;
+        std::vector<TradeRequest> requests(NUM_REQUESTS);
+        for (int i = 0; i < NUM_REQUESTS; ++i) {
+            auto& req = requests[i];
+            req.clientId  = clientId;
+            req.sequence  = ids.next();
+            req.requestId = RequestIdFormat::format(clientId, req.sequence);
+            req.tradeType = (i & 1) ? TradeType::SELL : TradeType::BUY;
+            req.symbol    = symbols[i % 6];
+            req.volume    = 0.01;
+            req.timestamp = std::chrono::system_clock::now();
+        }
+        return requests;
+    };
+
+    std::cout << "Dispatch benchmark: " << NUM_REQUESTS << " requests x " << ROUNDS
+              << " rounds, zero-latency mock\n";
+
+    double bestVirtual = 1e18, bestStatic = 1e18;
+    for (int round = 0; round < ROUNDS; ++round) {
+        auto requests = makeRequests("Bench-" + std::to_string(round));
+        {
+            MockMTAPI api(0.0, 0, 0, 1e12);
+            IMTBrokerAPI& erased = api;
+            bestVirtual = std::min(bestVirtual, timeDispatch(erased, quiet, requests));
+        }
+        {
+            MockMTAPI api(0.0, 0, 0, 1e12);
+            bestStatic = std::min(bestStatic, timeDispatch(api, quiet, requests));
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "  Virtual dispatch (IMTBrokerAPI&): " << bestVirtual << " ns/request\n"
+              << "  Static dispatch  (MockMTAPI&):    " << bestStatic  << " ns/request\n"
+              << "  Difference:                       " << (bestVirtual - bestStatic)
+              << " ns/request (" << (100.0 * (bestVirtual - bestStatic) / bestVirtual) << "%)\n";
+}
+
+/// Validation benchmark: BasicValidator::validate() per request vs.
+/// validateBatch() over bursts, on the same mix of valid and invalid
+/// requests. Also cross-checks that both paths produce identical results,
+/// and times validate() with a 20-rule RuleEngine set that every request
+/// passes (the cost of evaluating configured rules).
+void runValidationBenchmark() {
+    const int NUM_REQUESTS = 200000;
+    const int BATCH_SIZE   = 256;
+    const int ROUNDS       = 5;
+
+    Logger quiet("", LogLevel::ERROR);   // console only, errors only
+    MockMTAPI api(0.0, 0, 0, 1e12);
+
+    const char* symbols[] = {"EURUSD", "GBPUSD", "USDJPY", "AUDUSD", "USDCAD", "XAUUSD", "FAKEPAIR"};
+    auto makeRequests = [&](const std::string& clientId) {
+        RequestIdSequence ids;
+        std::vector<TradeRequest> requests(NUM_REQUESTS);
+        for (int i = 0; i < NUM_REQUESTS; ++i) {
+            auto& req = requests[i];
+            req.clientId  = clientId;
+            req.sequence  = ids.next();
+            req.requestId = RequestIdFormat::format(clientId, req.sequence);
+            req.tradeType = (i & 1) ? TradeType::SELL : TradeType::BUY;
+            req.symbol    = symbols[i % 50 == 0 ? 6 : i % 6];
+            req.volume    = (i % 37 == 0) ? -1.0 : (i % 41 == 0) ? 500.0 : 0.01 * (1 + i % 10);
+            if (i % 3 == 0)  req.stopLoss   = (i % 43 == 0) ? -1.0 : 1.05;
+            if (i % 5 == 0)  req.takeProfit = 1.20;
+            if (i % 997 == 0 && i > 0) req.requestId = requests[i - 1].requestId;   // duplicate
+            req.timestamp = std::chrono::system_clock::now();
+        }
+        return requests;
+    };
+
+    // 20 rules across all scopes, loose enough that no request is rejected
+    std::string ruleText;
+    const char* ruleSymbols[] = {"EURUSD", "GBPUSD", "USDJPY", "XAUUSD"};
+    for (int i = 0; i < 4; ++i) {
+        std::string sym = ruleSymbols[i];
+        ruleText += "rule.max_volume_" + sym + " = volume <= 1000 for symbol " + sym + "\n"
+                  + "rule.max_notional_" + sym + " = notional <= 1e12 for symbol " + sym + "\n"
+                  + "rule.sl_floor_" + sym + " = stop_loss > 0 for symbol " + sym + "\n";
+    }
+    ruleText += "rule.global_max_volume = volume <= 10000\n"
+                "rule.global_min_volume = volume >= -1e9\n"
+                "rule.global_tp = take_profit >= 0\n"
+                "rule.global_notional = notional < 1e15\n"
+                "rule.blocked_symbols = symbol not_in BTCUSD,ETHUSD\n"
+                "rule.blocked_clients = client not_in Banned-1,Banned-2\n"
+                "rule.client_whitelist = symbol in EURUSD,GBPUSD,USDJPY,AUDUSD,USDCAD,XAUUSD,FAKEPAIR for client Bench-0\n"
+                "rule.client_cap = volume <= 5000 for client Bench-0\n";
+    RuleEngine rules(quiet);
+    rules.load(ConfigFile::parse(ruleText));
+
+    std::cout << "Validation benchmark: " << NUM_REQUESTS << " requests x " << ROUNDS
+              << " rounds, batch " << BATCH_SIZE << "\n";
+
+    double bestScalar = 1e18, bestBatch = 1e18, bestRules = 1e18;
+    size_t mismatches = 0;
+    size_t ruleRejections = 0;   // Per round; the rule set is meant to pass everything
+    for (int round = 0; round < ROUNDS; ++round) {
+        auto requests = makeRequests("Bench-" + std::to_string(round));
+        std::vector<std::optional<TradeResult>> scalarResults(NUM_REQUESTS);
+        std::vector<std::optional<TradeResult>> batchResults(NUM_REQUESTS);
+
+        {
+            BasicValidator<MockMTAPI> validator(api, quiet);
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < NUM_REQUESTS; ++i) {
+                scalarResults[i] = validator.validate(requests[i]);
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            bestScalar = std::min(bestScalar,
+                std::chrono::duration<double, std::nano>(elapsed).count() / NUM_REQUESTS);
+        }
+        {
+            BasicValidator<MockMTAPI> validator(api, quiet);
+            validator.setRules(&rules);
+            size_t rejected = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < NUM_REQUESTS; ++i) {
+                auto result = validator.validate(requests[i]);
+                rejected += result && result->status == TradeStatus::REJECTED;
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            bestRules = std::min(bestRules,
+                std::chrono::duration<double, std::nano>(elapsed).count() / NUM_REQUESTS);
+            ruleRejections = rejected;
+        }
+        {
+            BasicValidator<MockMTAPI> validator(api, quiet);
+            std::vector<const TradeRequest*> batch;
+            std::vector<std::optional<TradeResult>> results;
+            BasicValidator<MockMTAPI>::BatchScratch scratch;
+            auto start = std::chrono::steady_clock::now();
+            for (int begin = 0; begin < NUM_REQUESTS; begin += BATCH_SIZE) {
+                int end = std::min(begin + BATCH_SIZE, NUM_REQUESTS);
+                batch.clear();
+                for (int i = begin; i < end; ++i) batch.push_back(&requests[i]);
+                validator.validateBatch(batch, results, scratch);
+                for (int i = begin; i < end; ++i) batchResults[i] = std::move(results[i - begin]);
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            bestBatch = std::min(bestBatch,
+                std::chrono::duration<double, std::nano>(elapsed).count() / NUM_REQUESTS);
+        }
+
+        for (int i = 0; i < NUM_REQUESTS; ++i) {
+            const auto& a = scalarResults[i];
+            const auto& b = batchResults[i];
+            if (a.has_value() != b.has_value() ||
+                (a && (a->status != b->status || a->errorMessage != b->errorMessage))) {
+                ++mismatches;
+            }
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "  Per-request validate(): " << bestScalar << " ns/request\n"
+              << "  validateBatch():        " << bestBatch  << " ns/request\n"
+              << "  Speedup:                " << std::setprecision(2) << (bestScalar / bestBatch) << "x\n"
+              << "  Result mismatches:      " << mismatches << "\n"
+              << std::setprecision(1)
+              << "  validate() + " << rules.program()->ruleCount() << " rules:  " << bestRules
+              << " ns/request (+" << (bestRules - bestScalar) << ", "
+              << ruleRejections << " rejected by rules)\n";
+
+    // Session calendar: one schedule per symbol plus a default and holidays
+    TradingCalendar calendar;
+    std::string calendarError;
+    if (!calendar.load(ConfigFile::parse(
+            "calendar.session.default = mon-fri 00:00-24:00\n"
+            "calendar.session.EURUSD  = sun 22:00-24:00, mon-thu 00:00-24:00, fri 00:00-21:55\n"
+            "calendar.session.XAUUSD  = mon-fri 01:00-23:55\n"
+            "calendar.holiday.all     = 2026-12-25, 2027-01-01\n"), calendarError)) {
+        std::cout << "  Session calendar check: skipped (" << calendarError << ")\n";
+        return;
+    }
+    auto moment = calendar.at(std::chrono::system_clock::now());
+    const int LOOKUPS = 4000000;
+    size_t open = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < LOOKUPS; ++i) {
+        moment.minuteOfWeek = i % TradingCalendar::MINUTES_PER_WEEK;
+        open += calendar.isOpen(symbols[i % 7], moment);
+    }
+    double lookupNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / LOOKUPS;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < LOOKUPS; ++i) {
+        open += calendar.isOpen(symbols[i % 7], std::chrono::system_clock::now());
+    }
+    double clockNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / LOOKUPS;
+    std::cout << "  Session calendar check: " << lookupNs << " ns/lookup, " << clockNs
+              << " ns with a clock read (" << 100.0 * open / (2 * LOOKUPS) << "% open)\n";
+}
+
+/// Throughput benchmark: the processor's ceiling with the broker taken out of
+/// the picture (NullBroker: instant fills, no locks, no allocations).
+///
+/// Measures (1) process() on one thread - validate, execute, track - and
+/// (2) the full pipeline: one producer submitting, `numWorkers` workers
+/// draining the queue, a completion callback per request, and (4) slow
+/// callbacks run inline vs. on completion threads. Per-core figures
+/// divide by process CPU time, so they stay meaningful when threads
+/// outnumber cores.
+void runThroughputBenchmark(int numWorkers) {
+    const int NUM_REQUESTS = 500000;
+
+    Logger quiet("", LogLevel::ERROR);   // console only, errors only
+
+    const char* symbols[] = {"EURUSD", "GBPUSD", "USDJPY", "AUDUSD", "USDCAD", "XAUUSD"};
+    auto makeRequests = [&](const std::string& clientId) {
+        RequestIdSequence ids;
+        std::vector<TradeRequest> requests(NUM_REQUESTS);
+        for (int i = 0; i < NUM_REQUESTS; ++i) {
+            auto& req = requests[i];
+            req.clientId  = clientId;
+            req.sequence  = ids.next();
+            req.requestId = RequestIdFormat::format(clientId, req.sequence);
+            req.tradeType = (i & 1) ? TradeType::SELL : TradeType::BUY;
+            req.symbol    = symbols[i % 6];
+            req.volume    = 0.01 * (1 + i % 10);
+            req.timestamp = std::chrono::system_clock::now();
+        }
+        return requests;
+    };
+    auto report = [](const char* label, double seconds, double cpuSeconds) {
+        std::cout << "  " << label << std::fixed << std::setprecision(0)
+                  << std::setw(10) << NUM_REQUESTS / seconds << " req/s, "
+                  << std::setw(10) << NUM_REQUESTS / cpuSeconds << " req/s per core ("
+                  << std::setprecision(2) << cpuSeconds / seconds << " cores busy)\n";
+    };
+
+    std::cout << "Throughput benchmark: " << NUM_REQUESTS << " requests, null broker, "
+              << numWorkers << " worker(s), " << std::thread::hardware_concurrency() << " core(s)\n";
+
+    // 1. Synchronous ceiling: validate -> execute -> track on this thread,
+    //    then again under the sampling profiler at 1 kHz
+    for (int hz : {0, 1000}) {
+        auto requests = makeRequests(hz ? "Prof" : "Sync");
+        NullBroker broker;
+        BasicDealProcessor<NullBroker> processor(broker, quiet);
+
+        SamplingProfiler::Options options;
+        options.hz     = hz;
+        options.output = (std::filesystem::temp_directory_path() / "deal_processor_bench.folded").string();
+        SamplingProfiler profiler(options);
+        std::string error;
+        if (hz && !profiler.start(error)) {
+            std::cout << "  (sampling profiler unavailable: " << error << ")\n";
+            continue;
+        }
+
+        std::clock_t cpuStart = std::clock();
+        auto start = std::chrono::steady_clock::now();
+        {
+            SamplingProfiler::ThreadRegistration profiled;
+            for (const auto& request : requests) {
+                processor.process(request);
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double cpu = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+        report(hz ? "process(), 1kHz profile:" : "process(), 1 thread:   ", seconds, cpu);
+        if (hz) {
+            profiler.stop();
+            auto stats = profiler.stats();
+            std::cout << "    samples: " << stats.samples << " (" << stats.dropped << " dropped) over "
+                      << std::setprecision(0) << stats.cpuMs << "ms CPU, " << stats.achievedHz << " of "
+                      << hz << " Hz -> " << options.output << "\n"
+                      << "    overhead: " << std::setprecision(3) << stats.overheadPercent << "% as sampled, "
+                      << stats.requestedOverheadPercent << "% at " << hz << " Hz (per sample "
+                      << std::setprecision(2) << stats.signalUs << "us signal delivery + sigreturn, "
+                      << stats.handlerUs << "us handler)\n"
+                      << "    handler: " << profiler.handlerLatency().summary() << "\n";
+        }
+    }
+
+    // 2. Full pipeline: submit -> queue -> workers -> tracker -> callback,
+    //    then with result_batch 32 (null broker calls end well inside the
+    //    flush deadline, so executed trades batch too)
+    for (int resultBatch : {1, 32}) {
+        auto requests = makeRequests(resultBatch == 1 ? "Pipe" : "Batch");
+        NullBroker broker;
+        ProcessorConfig config;
+        config.numWorkers      = numWorkers;
+        config.resultBatchSize = resultBatch;
+        config.resultFlushUs   = 500;
+        BasicDealProcessor<NullBroker> processor(broker, quiet, config);
+        processor.start();
+
+        std::atomic<int> completed{0};
+        auto onResult = [&completed](const TradeResult&) {
+            completed.fetch_add(1, std::memory_order_relaxed);
+        };
+
+        std::clock_t cpuStart = std::clock();
+        auto start = std::chrono::steady_clock::now();
+        for (auto& request : requests) {
+            processor.submit(std::move(request), onResult);
+        }
+        while (completed.load(std::memory_order_relaxed) < NUM_REQUESTS) {
+            std::this_thread::yield();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double cpu = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+        processor.stop();
+        report(resultBatch == 1 ? "submit() -> workers:   " : "results batched x32:   ", seconds, cpu);
+        std::cout << "    tracker locks/request: " << std::fixed << std::setprecision(3)
+                  << static_cast<double>(processor.resultFlushes()) / NUM_REQUESTS << "\n";
+    }
+
+    // 3. Reactor: submit -> per-client event loop (lock-free inbox) -> async
+    //    send -> answer event -> tracker, flushed once per batch of events
+    {
+        auto requests = makeRequests("Loop");
+        NullBroker broker;
+        ProcessorConfig config;
+        config.model        = ExecutionModel::REACTOR;
+        config.reactorLoops = numWorkers;
+        BasicDealProcessor<NullBroker> processor(broker, quiet, config);
+        processor.start();
+
+        std::atomic<int> completed{0};
+        auto onResult = [&completed](const TradeResult&) {
+            completed.fetch_add(1, std::memory_order_relaxed);
+        };
+
+        std::clock_t cpuStart = std::clock();
+        auto start = std::chrono::steady_clock::now();
+        for (auto& request : requests) {
+            processor.submit(std::move(request), onResult);
+        }
+        while (completed.load(std::memory_order_relaxed) < NUM_REQUESTS) {
+            std::this_thread::yield();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double cpu = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+        processor.stop();
+        report("reactor event loops:   ", seconds, cpu);
+        std::cout << "    tracker locks/request: " << std::fixed << std::setprecision(3)
+                  << static_cast<double>(processor.resultFlushes()) / NUM_REQUESTS << "\n";
+    }
+
+    // 4. Slow callbacks (~20us each) run on the workers vs. handed to two
+    //    completion threads: the workers' execution latency should not move
+    for (int completionThreads : {0, 2}) {
+        const int SLOW_REQUESTS = 20000;
+        auto requests = makeRequests(completionThreads == 0 ? "Inline" : "Exec");
+        requests.resize(SLOW_REQUESTS);
+        for (int i = 0; i < SLOW_REQUESTS; ++i) {
+            requests[i].clientId += "-" + std::to_string(i % 8);   // Spread over executor threads
+        }
+        NullBroker broker;
+        ProcessorConfig config;
+        config.numWorkers        = numWorkers;
+        config.completionThreads = completionThreads;
+        BasicDealProcessor<NullBroker> processor(broker, quiet, config);
+        processor.start();
+
+        std::atomic<int> completed{0};
+        auto onResult = [&completed](const TradeResult&) {
+            auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(20);
+            while (std::chrono::steady_clock::now() < until) {}
+            completed.fetch_add(1, std::memory_order_relaxed);
+        };
+
+        std::clock_t cpuStart = std::clock();
+        auto start = std::chrono::steady_clock::now();
+        for (auto& request : requests) {
+            processor.submit(std::move(request), onResult);
+        }
+        while (completed.load(std::memory_order_relaxed) < SLOW_REQUESTS) {
+            std::this_thread::yield();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double cpu = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+        processor.stop();
+        std::cout << "\n  Slow callbacks, " << (completionThreads == 0 ? "on workers" : "2 completion threads")
+                  << " (" << SLOW_REQUESTS << " requests): " << std::fixed << std::setprecision(0)
+                  << SLOW_REQUESTS / seconds << " req/s, cpu " << std::setprecision(2) << cpu << "s\n"
+                  << "    execution:     " << processor.executionLatency().summary() << "\n"
+                  << "    callback wait: " << processor.callbackWait().summary() << "\n"
+                  << "    callback run:  " << processor.callbackRun().summary() << "\n";
+    }
+}
+
+/// Log file and journal I/O with plain syscalls vs. io_uring, fdatasync on:
+/// syscalls per line / per result and the latency of each flush/commit.
+void runIoBenchmark() {
+    const int LOG_LINES    = 200000;
+    const int LOG_BATCH    = 64;       // Lines per writer batch (one flush each)
+    const int JOURNAL_RESULTS = 20000;
+
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "deal_processor_bench_io";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir, ec);
+
+    auto percentileUs = [](std::vector<double>& samples, double p) {
+        size_t index = std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()));
+        std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+        return samples[index];
+    };
+    auto report = [&](const std::string& label, const IoRing::Stats& stats, int units,
+                      std::vector<double>& latencyUs) {
+        std::cout << "  " << std::left << std::setw(26) << label << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(7) << static_cast<double>(stats.syscalls) / units
+                  << " syscalls/item, p50 " << std::setprecision(1) << std::setw(7) << percentileUs(latencyUs, 0.50)
+                  << " us, p99 " << std::setw(7) << percentileUs(latencyUs, 0.99)
+                  << " us, max " << std::setw(8) << percentileUs(latencyUs, 1.0) << " us\n";
+    };
+
+    std::cout << "I/O benchmark: " << LOG_LINES << " log lines (flush every " << LOG_BATCH << "), "
+              << JOURNAL_RESULTS << " journaled results, fdatasync on, in " << dir.string() << "\n";
+
+    TradeResult result;
+    result.clientId       = "Bench";
+    result.symbol         = "EURUSD";
+    result.status         = TradeStatus::SUCCESS;
+    result.mtTicketId     = "100001";
+    result.executionPrice = 1.0850;
+    result.retryCount     = 0;
+    result.timestamp      = std::chrono::system_clock::now();
+
+    for (bool uring : {false, true}) {
+        IoRing::Options io;
+        io.uring = uring;
+        std::string backend;
+
+        // 1. Log file: writer batches of LOG_BATCH lines, each flushed + synced
+        {
+            FileSink sink((dir / "bench.log").string(), LogLevel::DEBUG, {}, io);
+            sink.setIo(io, true);
+            backend = sink.ioBackend();
+            std::string line(120, 'x');
+            std::vector<double> flushUs;
+            flushUs.reserve(LOG_LINES / LOG_BATCH);
+            for (int i = 0; i < LOG_LINES; i += LOG_BATCH) {
+                for (int j = 0; j < LOG_BATCH; ++j) sink.write(LogLevel::INFO, line);
+                auto start = std::chrono::steady_clock::now();
+                sink.flush();
+                flushUs.push_back(std::chrono::duration<double, std::micro>(
+                    std::chrono::steady_clock::now() - start).count());
+            }
+            report(backend + " log flush:", sink.ioStats(), LOG_LINES, flushUs);
+        }
+
+        // 2. Journal: one commit per result (result_batch = 1), then per 32
+        for (int batch : {1, 32}) {
+            fs::path journalDir = dir / ("journal-" + std::to_string(batch));
+            StateJournal journal(journalDir.string(), {io, true});
+            std::string error;
+            journal.open(1, error);
+            std::vector<double> commitUs;
+            commitUs.reserve(JOURNAL_RESULTS / batch);
+            for (int i = 0; i < JOURNAL_RESULTS; i += batch) {
+                for (int j = 0; j < batch; ++j) {
+                    result.requestId = "Bench-" + std::to_string(i + j);
+                    journal.append(result);
+                }
+                auto start = std::chrono::steady_clock::now();
+                journal.commit();
+                commitUs.push_back(std::chrono::duration<double, std::micro>(
+                    std::chrono::steady_clock::now() - start).count());
+            }
+            journal.sync();   // Commits only hand over; the sync thread groups them
+            report(backend + " journal x" + std::to_string(batch) + ":", journal.io().stats(),
+                   JOURNAL_RESULTS, commitUs);
+        }
+    }
+    fs::remove_all(dir, ec);
+}
@@ -8,18 +8,46 @@ echo "Building MT5 Deal Processor..."
 
 mkdir -p build
 
-g++ -std=c++17 -O2 -Wall -Wextra -Wpedantic -Wno-unused-parameter \
-    -Isrc -pthread \
-    -o build/deal_processor \
-    src/main.cpp \
-    src/logger/Logger.cpp \
-    src/mt_api/MockMTAPI.cpp \
-    src/processor/DealProcessor.cpp \
-    src/tracker/ResultTracker.cpp \
+CXXFLAGS="-std=c++17 -O2 -Wall -Wextra -Wpedantic -Wno-unused-parameter -fno-omit-frame-pointer -Isrc -pthread -rdynamic"
+
+# Everything but main(), shared by the demo and the benchmarks
+CORE_SOURCES="
+    src/config/ConfigFile.cpp
+    src/logger/Logger.cpp
+    src/logger/LogRotator.cpp
+    src/logger/LogSink.cpp
+    src/logger/LogSinks.cpp
+    src/mt_api/MockMTAPI.cpp
+    src/mt_api/BrokerScenario.cpp
+    src/mt_api/NullBroker.cpp
+    src/mt_api/TradeStore.cpp
+    src/mt_api/BrokerRouter.cpp
+    src/mt_api/TradingCalendar.cpp
+    src/persistence/StateJournal.cpp
+    src/persistence/StateSnapshot.cpp
+    src/persistence/StatePersistence.cpp
+    src/persistence/ResultFeed.cpp
+    src/processor/LatencyHistogram.cpp
+    src/processor/CompletionExecutor.cpp
+    src/perf/PerfCounters.cpp
+    src/perf/StageCounters.cpp
+    src/perf/SamplingProfiler.cpp
+    src/io/IoRing.cpp
+    src/reactor/EventLoop.cpp
+    src/processor/DealProcessor.cpp
+    src/processor/BatchValidator.cpp
+    src/processor/RuleEngine.cpp
+    src/processor/ClientSession.cpp
+    src/tracker/ResultTracker.cpp
     src/client/ClientSimulator.cpp
+"
+
+g++ $CXXFLAGS -o build/deal_processor src/main.cpp $CORE_SOURCES -ldl
+g++ $CXXFLAGS -o build/deal_processor_bench bench/main.cpp $CORE_SOURCES -ldl
 
-echo "Build successful: build/deal_processor"
+echo "Build successful: build/deal_processor, build/deal_processor_bench"
 echo ""
 echo "Usage:"
 echo "  ./build/deal_processor          # Normal simulation (5 clients, 50 requests)"
 echo "  ./build/deal_processor --burst   # High-frequency burst test (10 clients, 200 requests)"
+echo "  ./build/deal_processor_bench --throughput   # Benchmarks: --dispatch, --validate, --throughput [workers], --io"
@@ -7,6 +7,7 @@ ClientSimulator::ClientSimulator(const Config& config)
 {}
 
 void ClientSimulator::run(DealProcessor& processor) {
+    session_ = processor.openSession(config_.clientId, config_.creditWindow);
     std::uniform_int_distribution<int> delayDist(config_.minDelayMs, config_.maxDelayMs);
     std::uniform_real_distribution<double> badChance(0.0, 1.0);
 
@@ -19,11 +20,13 @@ void ClientSimulator::run(DealProcessor& processor) {
             request = generateRequest();
         }
 
-        // Submit to processor with callback to capture the result
-        processor.submit(request, [this](const TradeResult& result) {
-            std::lock_guard<std::mutex> lock(resultsMutex_);
-            results_.push_back(result);
-        });
+        // Submit on the session; out of credits means our results are
+        // piling up, so consume some before sending more
+        while (!processor.submit(session_, request)) {
+            if (session_->available() > 0) return;   // Refused with credit to spare: processor stopped
+            if (collect() == 0) session_->waitForResults(std::chrono::milliseconds(100));
+        }
+        collect();
 
         // Simulate delay between client requests
         int delay = delayDist(rng_);
@@ -31,9 +34,9 @@ void ClientSimulator::run(DealProcessor& processor) {
     }
 }
 
-std::vector<TradeResult> ClientSimulator::getResults() const {
-    std::lock_guard<std::mutex> lock(resultsMutex_);
-    return results_;
+size_t ClientSimulator::collect() {
+    if (!session_) return 0;
+    return session_->poll(results_, session_->window());
 }
 
 TradeRequest ClientSimulator::generateRequest() {
@@ -44,7 +47,8 @@ TradeRequest ClientSimulator::generateRequest() {
 
     TradeRequest req;
     req.clientId  = config_.clientId;
-    req.requestId = TradeRequest::generateRequestId(config_.clientId);
+    req.sequence  = idSequence_.next();
+    req.requestId = RequestIdFormat::format(config_.clientId, req.sequence);
     req.tradeType = typeDist(rng_) == 0 ? TradeType::BUY : TradeType::SELL;
     req.symbol    = symbols_[symbolDist(rng_)];
     req.volume    = volumeDist(rng_) * 0.01;  // In lot increments of 0.01
@@ -52,8 +56,12 @@ TradeRequest ClientSimulator::generateRequest() {
 
     // 40% chance to include SL/TP
     if (slTpChance(rng_) < 40) {
-        double basePrice = (req.symbol == "XAUUSD") ? 2035.0 :
-                           (req.symbol == "USDJPY") ? 149.0 : 1.0;
+        // Literal symbols resolve to IDs at compile time
+        static constexpr int XAUUSD = DEFAULT_SYMBOL_TABLE.find("XAUUSD");
+        static constexpr int USDJPY = DEFAULT_SYMBOL_TABLE.find("USDJPY");
+        int symbolId = DEFAULT_SYMBOL_TABLE.find(req.symbol);
+        double basePrice = (symbolId == XAUUSD) ? 2035.0 :
+                           (symbolId == USDJPY) ? 149.0 : 1.0;
         double offset = basePrice * 0.005; // 0.5% offset
         if (req.tradeType == TradeType::BUY) {
             req.stopLoss   = basePrice - offset;
@@ -72,7 +80,8 @@ TradeRequest ClientSimulator::generateBadRequest() {
 
     TradeRequest req;
     req.clientId  = config_.clientId;
-    req.requestId = TradeRequest::generateRequestId(config_.clientId);
+    req.sequence  = idSequence_.next();
+    req.requestId = RequestIdFormat::format(config_.clientId, req.sequence);
     req.timestamp = std::chrono::system_clock::now();
 
     req.isTestBadRequest = true;
@@ -1,15 +1,16 @@
 #pragma once
 
 #include "models/TradeRequest.h"
+#include "models/RequestId.h"
 #include "models/TradeResult.h"
 #include "processor/DealProcessor.h"
+#include "mt_api/SymbolTable.h"
 
 #include <string>
 #include <vector>
 #include <random>
 #include <functional>
-#include <atomic>
-#include <mutex>
+#include <memory>
 
 /// Simulates a client sending trade requests to the Deal Processor.
 /// Each client runs in its own thread, generating random trade requests.
@@ -18,6 +19,10 @@
 ///   - Number of requests to send
 ///   - Delay between requests (simulates real client pacing)
 ///   - Whether to include intentional bad requests (for error handling demo)
+///   - Credit window of its session (requests in flight + results unpolled)
+///
+/// Results come back on the client's ClientSession. The client polls them
+/// whenever it runs out of credits, so it is also the session's consumer.
 class ClientSimulator {
 public:
     struct Config {
@@ -26,6 +31,7 @@ public:
         int         minDelayMs      = 50;   // Min delay between requests
         int         maxDelayMs      = 200;  // Max delay between requests
         bool        sendBadRequests = true;  // Include some invalid requests
+        size_t      creditWindow    = 16;    // Session flow-control window
     };
 
     explicit ClientSimulator(const Config& config);
@@ -34,8 +40,16 @@ public:
     /// This method is designed to be called from a std::thread.
     void run(DealProcessor& processor);
 
-    /// Get results received by this client
-    std::vector<TradeResult> getResults() const;
+    /// Poll whatever results are still waiting on the session (e.g. after
+    /// the processor has stopped). Returns the number collected.
+    size_t collect();
+
+    /// Results received so far, in session sequence order. Only read once
+    /// run() has returned (run() appends to it on the client thread).
+    const std::vector<SessionResult>& results() const { return results_; }
+
+    /// Submits refused for lack of credit.
+    uint64_t creditStalls() const { return session_ ? session_->refused() : 0; }
 
     /// Get the client ID
     const std::string& clientId() const { return config_.clientId; }
@@ -45,12 +59,11 @@ private:
     TradeRequest generateBadRequest();
 
     Config config_;
+    RequestIdSequence idSequence_;   // Leased ID block, private to this client
 
-    std::vector<TradeResult> results_;
-    mutable std::mutex resultsMutex_;
+    std::shared_ptr<ClientSession> session_;
+    std::vector<SessionResult>     results_;
 
     std::mt19937 rng_;
-    std::vector<std::string> symbols_ = {
-        "EURUSD", "GBPUSD", "USDJPY", "AUDUSD", "USDCAD", "XAUUSD"
-    };
+    std::vector<std::string> symbols_{DEFAULT_INSTRUMENTS.begin(), DEFAULT_INSTRUMENTS.end()};
 };
@@ -0,0 +1,86 @@
+#include "config/ConfigFile.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+
+static std::string trim(const std::string& s) {
+    size_t first = s.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) return "";
+    size_t last = s.find_last_not_of(" \t\r\n");
+    return s.substr(first, last - first + 1);
+}
+
+std::optional<ConfigFile> ConfigFile::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) return std::nullopt;
+
+    std::ostringstream text;
+    text << in.rdbuf();
+    ConfigFile config = parse(text.str());
+    config.path_ = path;
+    return config;
+}
+
+ConfigFile ConfigFile::parse(const std::string& text) {
+    ConfigFile config;
+    std::istringstream in(text);
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.resize(hash);
+
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) continue;
+
+        std::string key   = trim(line.substr(0, eq));
+        std::string value = trim(line.substr(eq + 1));
+        if (key.empty()) continue;
+
+        config.set(key, value);
+    }
+    return config;
+}
+
+void ConfigFile::set(const std::string& key, const std::string& value) {
+    if (!values_.count(key)) order_.push_back(key);
+    values_[key] = value;
+}
+
+std::string ConfigFile::getString(const std::string& key, const std::string& fallback) const {
+    auto it = values_.find(key);
+    return it == values_.end() ? fallback : it->second;
+}
+
+double ConfigFile::getDouble(const std::string& key, double fallback) const {
+    auto it = values_.find(key);
+    if (it == values_.end()) return fallback;
+    char* end = nullptr;
+    double value = std::strtod(it->second.c_str(), &end);
+    return (end && *end == '\0' && end != it->second.c_str()) ? value : fallback;
+}
+
+long long ConfigFile::getInt(const std::string& key, long long fallback) const {
+    auto it = values_.find(key);
+    if (it == values_.end()) return fallback;
+    char* end = nullptr;
+    long long value = std::strtoll(it->second.c_str(), &end, 10);
+    return (end && *end == '\0' && end != it->second.c_str()) ? value : fallback;
+}
+
+bool ConfigFile::getBool(const std::string& key, bool fallback) const {
+    auto it = values_.find(key);
+    if (it == values_.end()) return fallback;
+    const std::string& v = it->second;
+    if (v == "true" || v == "1" || v == "yes" || v == "on")  return true;
+    if (v == "false" || v == "0" || v == "no" || v == "off") return false;
+    return fallback;
+}
+
+std::vector<std::string> ConfigFile::keysWithPrefix(const std::string& prefix) const {
+    std::vector<std::string> keys;
+    for (const auto& key : order_) {
+        if (key.compare(0, prefix.size(), prefix) == 0) keys.push_back(key);
+    }
+    return keys;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <unordered_map>
+
+/// Minimal "key = value" configuration file.
+///
+/// Lines starting with '#' (or text after an unquoted '#') are comments;
+/// blank lines are ignored; keys are dot-separated by convention, e.g.
+///   log.site.processor.retry.rate = 20
+/// Values are kept as strings and converted on lookup, so a missing or
+/// malformed entry simply yields the caller's default.
+class ConfigFile {
+public:
+    ConfigFile() = default;
+
+    /// Parse a file. Returns std::nullopt if it cannot be opened.
+    static std::optional<ConfigFile> load(const std::string& path);
+
+    /// Parse configuration text (same syntax as load()).
+    static ConfigFile parse(const std::string& text);
+
+    /// Add or replace an entry.
+    void set(const std::string& key, const std::string& value);
+
+    bool has(const std::string& key) const { return values_.count(key) != 0; }
+
+    std::string getString(const std::string& key, const std::string& fallback = "") const;
+    double      getDouble(const std::string& key, double fallback) const;
+    long long   getInt(const std::string& key, long long fallback) const;
+    bool        getBool(const std::string& key, bool fallback) const;
+
+    /// Keys beginning with `prefix`, in file order.
+    std::vector<std::string> keysWithPrefix(const std::string& prefix) const;
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string                                  path_;
+    std::unordered_map<std::string, std::string> values_;
+    std::vector<std::string>                     order_;
+};
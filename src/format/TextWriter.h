@@ -0,0 +1,223 @@
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+/// Allocation-free text builder over a caller-provided buffer.
+///
+/// Used on the logging path in place of std::ostringstream: no locale, no
+/// heap, no virtual streambuf calls. Output that does not fit is truncated,
+/// but required() keeps counting so the caller can retry with a larger
+/// buffer (same contract as snprintf).
+///
+/// Number formatting matches the iostream defaults the code used before:
+///   appendGeneral(v)    == os << v                       (%g, precision 6)
+///   appendFixed(v, n)   == os << fixed << setprecision(n) << v
+///   appendShortest(v)   -> shortest string that round-trips to v
+class TextWriter {
+public:
+    TextWriter(char* buffer, size_t capacity)
+        : begin_(buffer), capacity_(capacity) {}
+
+    template <size_t N>
+    explicit TextWriter(char (&buffer)[N]) : TextWriter(buffer, N) {}
+
+    TextWriter& append(std::string_view text) {
+        size_t room = size() < capacity_ ? capacity_ - size() : 0;
+        std::memcpy(begin_ + size(), text.data(), text.size() < room ? text.size() : room);
+        required_ += text.size();
+        return *this;
+    }
+
+    TextWriter& append(char c) {
+        if (required_ < capacity_) begin_[required_] = c;
+        ++required_;
+        return *this;
+    }
+
+    TextWriter& appendInt(int64_t value)   { return appendNumber(value); }
+    TextWriter& appendUInt(uint64_t value) { return appendNumber(value); }
+
+    /// Integer with thousands separators, e.g. 12345 -> "12,345".
+    TextWriter& appendGrouped(uint64_t value) {
+        char scratch[32];
+        char* p = scratch + sizeof(scratch);
+        int digits = 0;
+        do {
+            if (digits > 0 && digits % 3 == 0) *--p = ',';
+            *--p = static_cast<char>('0' + value % 10);
+            value /= 10;
+            ++digits;
+        } while (value != 0);
+        return append(std::string_view(p, static_cast<size_t>(scratch + sizeof(scratch) - p)));
+    }
+
+    /// Default iostream formatting (%g with the given significant digits).
+    TextWriter& appendGeneral(double value, int precision = 6) {
+#if defined(__cpp_lib_to_chars)
+        if (appendGeneralFast(value, precision)) return *this;
+        return appendNumber(value, std::chars_format::general, precision);
+#else
+        return appendPrintf("%.*g", precision, value);
+#endif
+    }
+
+    /// Fixed-point with `digits` decimals, e.g. a symbol's price digits.
+    TextWriter& appendFixed(double value, int digits) {
+        if (appendFixedFast(value, digits)) return *this;
+#if defined(__cpp_lib_to_chars)
+        return appendNumber(value, std::chars_format::fixed, digits);
+#else
+        return appendPrintf("%.*f", digits, value);
+#endif
+    }
+
+    /// Shortest representation that parses back to exactly `value`.
+    TextWriter& appendShortest(double value) {
+#if defined(__cpp_lib_to_chars)
+        return appendNumber(value);
+#else
+        return appendPrintf("%.17g", value);
+#endif
+    }
+
+    size_t size() const      { return required_ < capacity_ ? required_ : capacity_; }
+    size_t required() const  { return required_; }
+    bool   truncated() const { return required_ > capacity_; }
+
+    std::string_view view() const { return {begin_, size()}; }
+    std::string      str() const  { return std::string(view()); }
+
+    /// Run `fn(TextWriter&)` against a stack buffer and return the text.
+    /// Falls back to one exactly-sized heap pass if the stack buffer is short.
+    template <size_t StackSize = 256, typename Fn>
+    static std::string render(Fn&& fn) {
+        char buffer[StackSize];
+        TextWriter writer(buffer);
+        fn(writer);
+        if (!writer.truncated()) return writer.str();
+
+        std::string out(writer.required(), '\0');
+        TextWriter exact(out.data(), out.size());
+        fn(exact);
+        return out;
+    }
+
+private:
+    static constexpr int    MAX_FAST_DIGITS = 9;
+    static constexpr double MAX_FAST_SCALED = 1e12;   // keeps rounding error << 1e-3
+
+    static const double* powersOf10() {
+        static constexpr double table[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+            1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16
+        };
+        return table;
+    }
+
+    /// Scale |value| by 10^digits and round half-up to an integer. Returns
+    /// false when the result would be ambiguous (too close to a rounding
+    /// boundary to trust a double multiply) or out of the exact range; the
+    /// caller then uses the exact, slower formatter.
+    static bool scaleAndRound(double magnitude, int digits, uint64_t& rounded) {
+        if (digits < 0 || digits > MAX_FAST_DIGITS) return false;
+        double scaled = magnitude * powersOf10()[digits];
+        if (!(scaled < MAX_FAST_SCALED)) return false;   // also rejects NaN/inf
+        double whole = static_cast<double>(static_cast<uint64_t>(scaled));
+        double frac  = scaled - whole;
+        if (frac > 0.499 && frac < 0.501) return false;
+        rounded = static_cast<uint64_t>(whole) + (frac > 0.5 ? 1 : 0);
+        return true;
+    }
+
+    /// Emit sign, integer part, and `digits` zero-padded decimals of rounded.
+    void appendScaled(bool negative, uint64_t rounded, int digits) {
+        uint64_t unit = static_cast<uint64_t>(powersOf10()[digits]);
+        char scratch[40];
+        char* p = scratch + sizeof(scratch);
+        uint64_t frac = rounded % unit;
+        for (int i = 0; i < digits; ++i) {
+            *--p = static_cast<char>('0' + frac % 10);
+            frac /= 10;
+        }
+        if (digits > 0) *--p = '.';
+        uint64_t whole = rounded / unit;
+        do {
+            *--p = static_cast<char>('0' + whole % 10);
+            whole /= 10;
+        } while (whole != 0);
+        if (negative) *--p = '-';
+        append(std::string_view(p, static_cast<size_t>(scratch + sizeof(scratch) - p)));
+    }
+
+    bool appendFixedFast(double value, int digits) {
+        uint64_t rounded;
+        if (!scaleAndRound(value < 0 ? -value : value, digits, rounded)) return false;
+        appendScaled(std::signbit(value), rounded, digits);
+        return true;
+    }
+
+    /// %g for the common case: decimal exponent in [-4, precision), so the
+    /// output is plain fixed notation with trailing zeros removed.
+    bool appendGeneralFast(double value, int precision) {
+        double magnitude = value < 0 ? -value : value;
+        if (magnitude == 0.0) {
+            append(std::signbit(value) ? "-0" : "0");
+            return true;
+        }
+        if (!(magnitude >= 1e-4) || precision < 1 || precision > MAX_FAST_DIGITS) return false;
+
+        int exponent = -4;
+        while (exponent < precision && magnitude >= powersOf10()[exponent + 4] * 1e-4) ++exponent;
+        --exponent;                                   // floor(log10(magnitude))
+        if (exponent >= precision) return false;
+
+        int digits = precision - 1 - exponent;
+        uint64_t rounded;
+        if (!scaleAndRound(magnitude, digits, rounded)) return false;
+        // Rounding carried into a new leading digit (e.g. 9.999996 -> 10.0000):
+        // %g re-derives the exponent from the rounded value, so defer.
+        if (rounded >= static_cast<uint64_t>(powersOf10()[precision])) return false;
+
+        while (digits > 0 && rounded % 10 == 0) {
+            rounded /= 10;
+            --digits;
+        }
+        appendScaled(std::signbit(value), rounded, digits);
+        return true;
+    }
+
+    template <typename T, typename... Args>
+    TextWriter& appendNumber(T value, Args... args) {
+        // Fast path: format straight into the remaining space.
+        if (required_ < capacity_) {
+            char* first = begin_ + required_;
+            auto res = std::to_chars(first, begin_ + capacity_, value, args...);
+            if (res.ec == std::errc{}) {
+                required_ += static_cast<size_t>(res.ptr - first);
+                return *this;
+            }
+        }
+        // Not enough room: format into scratch so required() stays exact.
+        char scratch[512];
+        auto res = std::to_chars(scratch, scratch + sizeof(scratch), value, args...);
+        return append(std::string_view(scratch, static_cast<size_t>(res.ptr - scratch)));
+    }
+
+#if !defined(__cpp_lib_to_chars)
+    TextWriter& appendPrintf(const char* fmt, int precision, double value) {
+        char scratch[512];
+        int n = std::snprintf(scratch, sizeof(scratch), fmt, precision, value);
+        return append(std::string_view(scratch, n > 0 ? static_cast<size_t>(n) : 0));
+    }
+#endif
+
+    char*  begin_;
+    size_t capacity_;
+    size_t required_ = 0;
+};
@@ -0,0 +1,368 @@
+#include "io/IoRing.h"
+#include "config/ConfigFile.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/// Slots in the registered file table (a log file, a socket, a journal
+/// segment; rotation reuses a slot).
+static constexpr unsigned FILE_SLOTS = 16;
+
+/// Largest single operation handed to the kernel; longer writes complete as
+/// short writes and the rest goes through pwrite.
+static constexpr size_t MAX_OP_BYTES = size_t(1) << 30;
+
+static int ringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int ringEnter(int fd, unsigned toSubmit, unsigned minComplete) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete,
+                                      IORING_ENTER_GETEVENTS, nullptr, 0));
+}
+
+static int ringRegister(int fd, unsigned opcode, const void* arg, unsigned count) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+IoRing::Options IoRing::optionsFrom(const ConfigFile& config) {
+    Options options;
+    options.uring   = config.getString("io.backend", "uring") != "syscalls";
+    options.entries = static_cast<unsigned>(std::clamp(config.getInt("io.ring_entries", 64), 4LL, 4096LL));
+    return options;
+}
+
+IoRing::IoRing(Options options)
+    : options_(options)
+{
+    if (options_.uring && !setupRing(options_.entries)) closeRing();
+}
+
+IoRing::~IoRing() {
+    closeRing();
+}
+
+bool IoRing::setupRing(unsigned entries) {
+    io_uring_params params{};
+    ringFd_ = ringSetup(entries, &params);
+    if (ringFd_ < 0) return false;
+
+    sqEntries_   = params.sq_entries;
+    sqRingBytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingBytes_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single  = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single) sqRingBytes_ = cqRingBytes_ = std::max(sqRingBytes_, cqRingBytes_);
+
+    sqRing_ = ::mmap(nullptr, sqRingBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     ringFd_, IORING_OFF_SQ_RING);
+    if (sqRing_ == MAP_FAILED) {
+        sqRing_ = nullptr;
+        return false;
+    }
+    if (single) {
+        cqRing_ = sqRing_;
+    } else {
+        cqRing_ = ::mmap(nullptr, cqRingBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         ringFd_, IORING_OFF_CQ_RING);
+        if (cqRing_ == MAP_FAILED) {
+            cqRing_ = nullptr;
+            return false;
+        }
+    }
+    sqesBytes_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = ::mmap(nullptr, sqesBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ringFd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) return false;
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    char* sq = static_cast<char*>(sqRing_);
+    char* cq = static_cast<char*>(cqRing_);
+    sqHead_  = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sqTail_  = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    sqMask_  = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    cqHead_  = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cqTail_  = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cqMask_  = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_    = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    // Sparse file table; attachFile() fills slots. Without it files are
+    // simply used unregistered.
+    std::vector<int> empty(FILE_SLOTS, -1);
+    if (ringRegister(ringFd_, IORING_REGISTER_FILES, empty.data(), FILE_SLOTS) == 0) {
+        slotsUsed_.assign(FILE_SLOTS, false);
+    }
+    return true;
+}
+
+void IoRing::closeRing() {
+    if (sqes_) ::munmap(sqes_, sqesBytes_);
+    if (cqRing_ && cqRing_ != sqRing_) ::munmap(cqRing_, cqRingBytes_);
+    if (sqRing_) ::munmap(sqRing_, sqRingBytes_);
+    if (ringFd_ >= 0) ::close(ringFd_);
+    sqes_   = nullptr;
+    cqRing_ = nullptr;
+    sqRing_ = nullptr;
+    ringFd_ = -1;
+    buffersRegistered_ = false;
+    slotsUsed_.clear();
+    for (auto& file : files_) file.slot = -1;
+}
+
+int IoRing::registerBuffer(void* data, size_t size) {
+    buffers_.push_back({data, size});
+    if (!usingUring()) return -1;
+
+    // The table is registered as a whole: replace it with the larger one
+    if (buffersRegistered_) ringRegister(ringFd_, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+    buffersRegistered_ = ringRegister(ringFd_, IORING_REGISTER_BUFFERS, buffers_.data(),
+                                      static_cast<unsigned>(buffers_.size())) == 0;
+    return buffersRegistered_ ? static_cast<int>(buffers_.size() - 1) : -1;
+}
+
+int IoRing::attachFile(int fd) {
+    auto free = std::find_if(files_.begin(), files_.end(), [](const FileSlot& f) { return f.fd < 0; });
+    if (free == files_.end()) free = files_.insert(files_.end(), FileSlot{});
+    free->fd   = fd;
+    free->slot = -1;
+
+    auto slot = std::find(slotsUsed_.begin(), slotsUsed_.end(), false);
+    if (usingUring() && slot != slotsUsed_.end()) {
+        io_uring_files_update update{};
+        update.offset = static_cast<uint32_t>(slot - slotsUsed_.begin());
+        update.fds    = reinterpret_cast<uint64_t>(&fd);
+        if (ringRegister(ringFd_, IORING_REGISTER_FILES_UPDATE, &update, 1) == 1) {
+            *slot      = true;
+            free->slot = static_cast<int>(update.offset);
+        }
+    }
+    return static_cast<int>(free - files_.begin());
+}
+
+void IoRing::releaseFile(int file) {
+    if (file < 0 || static_cast<size_t>(file) >= files_.size()) return;
+    FileSlot& entry = files_[file];
+    if (entry.slot >= 0 && usingUring()) {
+        int none = -1;
+        io_uring_files_update update{};
+        update.offset = static_cast<uint32_t>(entry.slot);
+        update.fds    = reinterpret_cast<uint64_t>(&none);
+        ringRegister(ringFd_, IORING_REGISTER_FILES_UPDATE, &update, 1);
+        slotsUsed_[entry.slot] = false;
+    }
+    entry = FileSlot{};
+}
+
+void IoRing::write(int file, const void* data, size_t size, uint64_t offset, int buffer) {
+    if (size == 0) return;
+    ops_.push_back({OpKind::WRITE, file, static_cast<const char*>(data), size, offset, buffer});
+}
+
+void IoRing::fsync(int file) {
+    ops_.push_back({OpKind::FSYNC, file, nullptr, 0, 0, -1});
+}
+
+void IoRing::send(int file, const void* data, size_t size) {
+    ops_.push_back({OpKind::SEND, file, static_cast<const char*>(data), size, 0, -1});
+}
+
+bool IoRing::submit(std::string* error) {
+    if (ops_.empty()) return true;
+    bool ok = usingUring() ? submitRing(error) : submitSyscalls(error);
+    ops_.clear();
+    return ok;
+}
+
+bool IoRing::submitSyscalls(std::string* error) {
+    bool ok = true;
+    for (auto& op : ops_) {
+        if (int err = runSyscall(op)) {
+            fail(error, op, err);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+int IoRing::runSyscall(Op& op) {
+    int fd = files_[op.file].fd;
+    ++stats_.ops;
+    switch (op.kind) {
+        case OpKind::WRITE:
+            while (op.size > 0) {
+                ++stats_.syscalls;
+                ssize_t n = ::pwrite(fd, op.data, op.size, static_cast<off_t>(op.offset));
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    return -errno;
+                }
+                op.data   += n;
+                op.size   -= static_cast<size_t>(n);
+                op.offset += static_cast<uint64_t>(n);
+            }
+            return 0;
+        case OpKind::FSYNC:
+            ++stats_.syscalls;
+            return ::fdatasync(fd) == 0 ? 0 : -errno;
+        case OpKind::SEND:
+            ++stats_.syscalls;
+            return ::send(fd, op.data, op.size, MSG_DONTWAIT | MSG_NOSIGNAL) >= 0 ? 0 : -errno;
+    }
+    return -EINVAL;
+}
+
+void IoRing::prepare(const Op& op, uint64_t userData) {
+    unsigned tail  = *sqTail_;
+    unsigned index = tail & sqMask_;
+    io_uring_sqe* sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+
+    const FileSlot& file = files_[op.file];
+    if (file.slot >= 0) {
+        sqe->fd     = file.slot;
+        sqe->flags |= IOSQE_FIXED_FILE;
+    } else {
+        sqe->fd = file.fd;
+    }
+
+    switch (op.kind) {
+        case OpKind::WRITE:
+            if (op.buffer >= 0 && buffersRegistered_) {
+                sqe->opcode    = IORING_OP_WRITE_FIXED;
+                sqe->buf_index = static_cast<uint16_t>(op.buffer);
+            } else {
+                sqe->opcode = IORING_OP_WRITE;
+            }
+            sqe->addr = reinterpret_cast<uint64_t>(op.data);
+            sqe->len  = static_cast<uint32_t>(std::min(op.size, MAX_OP_BYTES));
+            sqe->off  = op.offset;
+            break;
+        case OpKind::FSYNC:
+            sqe->opcode      = IORING_OP_FSYNC;
+            sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+            sqe->flags      |= IOSQE_IO_DRAIN;     // After everything queued before it
+            break;
+        case OpKind::SEND:
+            sqe->opcode    = IORING_OP_SEND;
+            sqe->addr      = reinterpret_cast<uint64_t>(op.data);
+            sqe->len       = static_cast<uint32_t>(op.size);
+            sqe->msg_flags = MSG_DONTWAIT | MSG_NOSIGNAL;
+            break;
+    }
+    sqe->user_data = userData;
+
+    sqArray_[index] = index;
+    __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+}
+
+bool IoRing::submitRing(std::string* error) {
+    bool ok = true;
+    for (size_t first = 0; first < ops_.size(); ) {
+        unsigned batch = static_cast<unsigned>(std::min<size_t>(sqEntries_, ops_.size() - first));
+        for (unsigned i = 0; i < batch; ++i) prepare(ops_[first + i], first + i);
+        finished_.assign(batch, 0);
+
+        // One enter submits the batch and waits for all of it
+        unsigned toSubmit = batch;
+        unsigned done     = 0;
+        size_t   shortest = ops_.size();   // First op that needed a pwrite to finish
+        while (done < batch) {
+            ++stats_.syscalls;
+            int ret = ringEnter(ringFd_, toSubmit, batch - done);
+            if (ret < 0) {
+                if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+                int err = -errno;
+
+                // The ring is unusable. The kernel may still run the ops it
+                // took (the first `submitted`): wait for those instead of
+                // repeating them, which would send a datagram twice or
+                // append a record twice
+                unsigned submitted = batch - toSubmit;
+                while (true) {
+                    done += reap(first, shortest, ok, error);
+                    if (done >= submitted) break;
+                    ++stats_.syscalls;
+                    if (ringEnter(ringFd_, 0, submitted - done) < 0 && errno != EINTR) break;
+                }
+                closeRing();
+
+                // Taken but never completed: the outcome is unknown, so
+                // report it rather than risk running it twice
+                for (size_t i = first; i < first + submitted; ++i) {
+                    if (finished_[i - first]) continue;
+                    fail(error, ops_[i], err);
+                    ok = false;
+                }
+                for (size_t i = shortest + 1; i < first + submitted; ++i) {
+                    if (finished_[i - first] && ops_[i].kind == OpKind::FSYNC && runSyscall(ops_[i]) != 0) ok = false;
+                }
+
+                // Never submitted: run these (and from now on everything) with syscalls
+                for (size_t i = first + submitted; i < ops_.size(); ++i) {
+                    if (int e = runSyscall(ops_[i])) {
+                        fail(error, ops_[i], e);
+                        ok = false;
+                    }
+                }
+                return ok;
+            }
+            toSubmit -= std::min<unsigned>(static_cast<unsigned>(ret), toSubmit);
+            done += reap(first, shortest, ok, error);
+        }
+
+        // An fsync that ran before a short write's remainder must run again
+        for (size_t i = shortest + 1; i < first + batch; ++i) {
+            if (ops_[i].kind == OpKind::FSYNC && runSyscall(ops_[i]) != 0) ok = false;
+        }
+        first += batch;
+    }
+    return ok;
+}
+
+unsigned IoRing::reap(size_t first, size_t& shortest, bool& ok, std::string* error) {
+    unsigned reaped = 0;
+    unsigned head = *cqHead_;
+    unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head, ++reaped) {
+        const io_uring_cqe& cqe = cqes_[head & cqMask_];
+        Op& op  = ops_[cqe.user_data];
+        int res = cqe.res;
+        finished_[cqe.user_data - first] = 1;
+        ++stats_.ops;
+
+        if (res == -EINVAL || res == -EOPNOTSUPP) {
+            // Opcode this kernel does not support: do it the old way
+            --stats_.ops;
+            res = runSyscall(op);
+            if (res == 0) continue;
+        }
+        if (res < 0) {
+            fail(error, op, res);
+            ok = false;
+        } else if (op.kind == OpKind::WRITE && static_cast<size_t>(res) < op.size) {
+            op.data   += res;
+            op.size   -= static_cast<size_t>(res);
+            op.offset += static_cast<uint64_t>(res);
+            shortest = std::min<size_t>(shortest, cqe.user_data);
+            if (int err = runSyscall(op)) {
+                fail(error, op, err);
+                ok = false;
+            }
+        }
+    }
+    __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+    return reaped;
+}
+
+void IoRing::fail(std::string* error, const Op& op, int err) {
+    ++stats_.errors;
+    if (!error || !error->empty()) return;
+    const char* what = op.kind == OpKind::WRITE ? "write" : op.kind == OpKind::FSYNC ? "fsync" : "send";
+    *error = std::string(what) + " failed: " + std::strerror(-err);
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sys/uio.h>
+
+class ConfigFile;
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+/// Batched writes, fsyncs and socket sends over io_uring (Linux), with a
+/// fallback to plain syscalls when io_uring is unavailable or disabled.
+///
+/// Callers queue operations (no syscall), then submit() hands the batch to
+/// the kernel with one io_uring_enter and processes the completions on the
+/// calling thread - the owner's I/O thread. Short writes are finished with
+/// pwrite. Buffers and file descriptors can be registered up front,
+/// so the kernel neither pins the pages nor looks the fd up per operation.
+/// With the fallback the same queue runs as pwrite/fdatasync/send calls;
+/// stats() counts the syscalls either way.
+///
+/// Not thread-safe: one ring per I/O thread (a log sink's writer thread,
+/// the journal under the tracker lock or, with fsync, its sync thread).
+class IoRing {
+public:
+    struct Options {
+        bool     uring   = true;    // io.backend = uring | syscalls
+        unsigned entries = 64;      // io.ring_entries: submission queue slots
+    };
+
+    /// io.backend, io.ring_entries.
+    static Options optionsFrom(const ConfigFile& config);
+
+    struct Stats {
+        uint64_t ops      = 0;    // Operations completed (resubmitted remainders included)
+        uint64_t syscalls = 0;    // io_uring_enter calls, or pwrite/fdatasync/send calls
+        uint64_t errors   = 0;
+    };
+
+    explicit IoRing(Options options);
+    ~IoRing();
+
+    IoRing(const IoRing&) = delete;
+    IoRing& operator=(const IoRing&) = delete;
+
+    bool        usingUring() const { return ringFd_ >= 0; }
+    const char* backend() const { return usingUring() ? "io_uring" : "syscalls"; }
+
+    /// Register `size` bytes at `data` for fixed-buffer writes; returns the
+    /// buffer index to pass to write(), or -1 (writes from it then go
+    /// unregistered). The memory must outlive the ring.
+    int registerBuffer(void* data, size_t size);
+
+    /// Add `fd` to the ring's file table; returns the handle to pass to
+    /// write()/fsync()/send(). Call releaseFile() before closing the fd.
+    int  attachFile(int fd);
+    void releaseFile(int file);
+
+    /// Queue a write of [data, data + size) at `offset`. `buffer` is a
+    /// registerBuffer() index whose range contains the data, or -1. The data
+    /// must stay valid until submit() returns.
+    void write(int file, const void* data, size_t size, uint64_t offset, int buffer = -1);
+
+    /// Queue an fdatasync, ordered after every write queued before it.
+    void fsync(int file);
+
+    /// Queue a non-blocking send on a socket (best effort: not retried).
+    void send(int file, const void* data, size_t size);
+
+    size_t queued() const { return ops_.size(); }
+
+    /// Submit everything queued and wait for it to complete. Returns false
+    /// if an operation failed; `error` (optional) describes the first one.
+    bool submit(std::string* error = nullptr);
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    enum class OpKind : uint8_t { WRITE, FSYNC, SEND };
+
+    struct Op {
+        OpKind      kind;
+        int         file;
+        const char* data;
+        size_t      size;
+        uint64_t    offset;
+        int         buffer;
+    };
+
+    struct FileSlot {
+        int fd   = -1;
+        int slot = -1;     // Index in the registered file table, or -1
+    };
+
+    bool setupRing(unsigned entries);
+    void closeRing();
+    bool submitRing(std::string* error);
+    bool submitSyscalls(std::string* error);
+
+    /// Run one operation with a plain syscall (the fallback, or an opcode the
+    /// kernel rejected). Returns 0 or -errno.
+    int  runSyscall(Op& op);
+
+    void prepare(const Op& op, uint64_t userData);
+
+    /// Handle the completions posted so far for the batch starting at op
+    /// `first`; `shortest` tracks the first short write. Returns how many.
+    unsigned reap(size_t first, size_t& shortest, bool& ok, std::string* error);
+    void fail(std::string* error, const Op& op, int err);
+
+    Options               options_;
+    Stats                 stats_;
+    std::vector<Op>       ops_;
+    std::vector<FileSlot> files_;
+    std::vector<iovec>    buffers_;
+    std::vector<bool>     slotsUsed_;
+    std::vector<uint8_t>  finished_;           // submitRing(): completions seen in the current batch
+    bool                  buffersRegistered_ = false;
+
+    // io_uring mappings (ringFd_ < 0: syscall fallback)
+    int            ringFd_    = -1;
+    void*          sqRing_    = nullptr;
+    void*          cqRing_    = nullptr;
+    size_t         sqRingBytes_ = 0;
+    size_t         cqRingBytes_ = 0;
+    io_uring_sqe*  sqes_      = nullptr;
+    size_t         sqesBytes_ = 0;
+    unsigned       sqEntries_ = 0;
+    unsigned*      sqHead_    = nullptr;
+    unsigned*      sqTail_    = nullptr;
+    unsigned*      sqArray_   = nullptr;
+    unsigned       sqMask_    = 0;
+    unsigned*      cqHead_    = nullptr;
+    unsigned*      cqTail_    = nullptr;
+    unsigned       cqMask_    = 0;
+    io_uring_cqe*  cqes_      = nullptr;
+};
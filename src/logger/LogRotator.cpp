@@ -0,0 +1,186 @@
+#include "logger/LogRotator.h"
+
+#include <cerrno>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace fs = std::filesystem;
+
+LogFile::LogFile(const std::string& path)
+    : fd_(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644))
+{
+}
+
+LogFile::~LogFile() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+LogRotator::LogRotator(std::string basePath, LogRotationConfig config, SwapFn swap)
+    : basePath_(std::move(basePath))
+    , config_(std::move(config))
+    , swap_(std::move(swap))
+{
+    // Continue numbering after segments left by earlier runs so retention
+    // treats them as the oldest files.
+    nextSegment_ = highestExistingSegment() + 1;
+    thread_ = std::thread(&LogRotator::run, this);
+}
+
+LogRotator::~LogRotator() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void LogRotator::requestRotation() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (rotationRequested_) return;
+        rotationRequested_ = true;
+    }
+    cv_.notify_one();
+}
+
+void LogRotator::run() {
+    auto deadline = std::chrono::steady_clock::now() + config_.maxAge;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto ready = [this] { return rotationRequested_ || stopping_; };
+            if (config_.maxAge.count() > 0) {
+                cv_.wait_until(lock, deadline, ready);
+            } else {
+                cv_.wait(lock, ready);
+            }
+            if (stopping_) return;
+        }
+
+        rotate();
+        {
+            // Cleared only after the swap so requests raised by lines written
+            // during the rotation don't immediately rotate the fresh file.
+            std::lock_guard<std::mutex> lock(mutex_);
+            rotationRequested_ = false;
+        }
+        deadline = std::chrono::steady_clock::now() + config_.maxAge;
+    }
+}
+
+void LogRotator::rotate() {
+    // Nothing written since the last rotation (e.g. a quiet hour): keep the
+    // file rather than leave an empty segment behind
+    std::error_code ec;
+    if (fs::file_size(basePath_, ec) == 0 && !ec) return;
+
+    // Renaming the open file is safe on POSIX: writers keep appending to the
+    // same inode (now the segment) until the swap below.
+    std::string segment = segmentPath(nextSegment_);
+    fs::rename(basePath_, segment, ec);
+    if (ec) {
+        // The segment number stays free: pruning relies on contiguous numbers
+        std::cerr << "[LogRotator] WARNING: Could not rotate " << basePath_
+                  << ": " << ec.message() << std::endl;
+        return;
+    }
+    ++nextSegment_;
+
+    auto next = std::make_unique<LogFile>(basePath_);
+    if (!next->is_open()) {
+        std::cerr << "[LogRotator] WARNING: Could not open new log file: " << basePath_ << std::endl;
+    }
+
+    // The only step that touches the writers' lock: an O(1) pointer swap.
+    Stream previous = swap_(std::move(next));
+
+    // Close the finished segment off the hot path (the writer flushed its
+    // buffered lines into it during the swap).
+    previous.reset();
+
+    if (config_.compress) {
+        compressSegment(segment);
+    }
+    pruneSegments();
+}
+
+void LogRotator::compressSegment(const std::string& path) {
+    // Run the command directly (no shell): its words, "--", then the path
+    std::vector<std::string> words;
+    std::istringstream command(config_.compressCommand);
+    for (std::string word; command >> word;) words.push_back(word);
+    if (words.empty()) return;
+    words.push_back("--");
+    words.push_back(path);
+
+    std::vector<char*> argv;
+    for (auto& word : words) argv.push_back(word.data());
+    argv.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+    pid_t pid = -1;
+    int   status = -1;
+    int   error = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (error == 0) {
+        while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+    }
+    if (error != 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        std::cerr << "[LogRotator] WARNING: Compression failed, keeping " << path << std::endl;
+    }
+}
+
+void LogRotator::pruneSegments() {
+    if (config_.retention <= 0) return;
+    uint64_t newest = nextSegment_ - 1;
+    if (newest <= static_cast<uint64_t>(config_.retention)) return;
+
+    uint64_t oldestKept = newest - config_.retention + 1;
+    std::error_code ec;
+    for (uint64_t i = oldestKept; i-- > 0;) {
+        bool removedPlain = fs::remove(segmentPath(i), ec);
+        bool removedGz    = fs::remove(segmentPath(i) + ".gz", ec);
+        // Segments are contiguous; the first gap means older ones are gone.
+        if (!removedPlain && !removedGz) break;
+    }
+}
+
+std::string LogRotator::segmentPath(uint64_t index) const {
+    return basePath_ + "." + std::to_string(index);
+}
+
+uint64_t LogRotator::highestExistingSegment() const {
+    fs::path base(basePath_);
+    fs::path dir = base.has_parent_path() ? base.parent_path() : fs::path(".");
+    std::string prefix = base.filename().string() + ".";
+
+    uint64_t highest = 0;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.compare(0, prefix.size(), prefix) != 0) continue;
+
+        std::string rest = name.substr(prefix.size());
+        if (rest.size() > 3 && rest.compare(rest.size() - 3, 3, ".gz") == 0) {
+            rest.resize(rest.size() - 3);
+        }
+        if (rest.empty() || rest.find_first_not_of("0123456789") != std::string::npos) continue;
+        highest = std::max<uint64_t>(highest, std::stoull(rest));
+    }
+    return highest;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+/// Rotation policy for the log file. A limit of zero disables that trigger.
+struct LogRotationConfig {
+    uint64_t             maxBytes  = 0;             // Rotate once the active file reaches this size
+    std::chrono::seconds maxAge{0};                 // Rotate at least this often
+    int                  retention = 5;             // Rotated segments to keep on disk
+    bool                 compress  = true;          // Compress rotated segments in the background
+    std::string          compressCommand = "gzip -f";
+
+    bool enabled() const { return maxBytes > 0 || maxAge.count() > 0; }
+};
+
+/// An open log file: a plain descriptor, created (truncating) on
+/// construction and closed on destruction. FileSink writes it through its
+/// IoRing.
+class LogFile {
+public:
+    explicit LogFile(const std::string& path);
+    ~LogFile();
+
+    LogFile(const LogFile&) = delete;
+    LogFile& operator=(const LogFile&) = delete;
+
+    bool is_open() const { return fd_ >= 0; }
+    int  fd() const { return fd_; }
+
+private:
+    int fd_ = -1;
+};
+
+/// Background log rotation.
+///
+/// Segments are named "<base>.<n>" (or "<base>.<n>.gz" once compressed) with
+/// n increasing, so rotation never renames older segments. All file-system
+/// work - opening the next file, closing/flushing the old one, compression and
+/// pruning - runs on the rotator thread. Writers only ever:
+///   - call requestRotation() (sets a flag, no I/O), and
+///   - hold their own lock for the stream pointer swap done via SwapFn
+///     (FileSink also hands its buffered lines to the old file there).
+class LogRotator {
+public:
+    using Stream = std::unique_ptr<LogFile>;
+    /// Installs `next` as the active stream and returns the previous one.
+    using SwapFn = std::function<Stream(Stream next)>;
+
+    LogRotator(std::string basePath, LogRotationConfig config, SwapFn swap);
+    ~LogRotator();
+
+    LogRotator(const LogRotator&) = delete;
+    LogRotator& operator=(const LogRotator&) = delete;
+
+    /// Ask for a size-triggered rotation. Cheap; safe to call repeatedly.
+    void requestRotation();
+
+    const LogRotationConfig& config() const { return config_; }
+
+private:
+    void run();
+    void rotate();
+    void compressSegment(const std::string& path);
+    void pruneSegments();
+    std::string segmentPath(uint64_t index) const;
+    uint64_t    highestExistingSegment() const;
+
+    std::string        basePath_;
+    LogRotationConfig  config_;
+    SwapFn             swap_;
+    uint64_t           nextSegment_ = 1;
+
+    std::mutex              mutex_;
+    std::condition_variable cv_;
+    bool                    rotationRequested_ = false;
+    bool                    stopping_          = false;
+    std::thread             thread_;
+};
@@ -0,0 +1,83 @@
+#include "logger/LogSink.h"
+
+/// Buffers kept for reuse: enough for a burst of lines, without pinning
+/// the memory of one unusually long line forever.
+static constexpr size_t MAX_SPARE_LINES    = 1024;
+static constexpr size_t MAX_SPARE_CAPACITY = 4096;
+
+AsyncLogSink::AsyncLogSink(std::unique_ptr<LogSink> sink, size_t capacity)
+    : sink_(std::move(sink))
+    , capacity_(capacity)
+{
+    thread_ = std::thread(&AsyncLogSink::run, this);
+}
+
+AsyncLogSink::~AsyncLogSink() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void AsyncLogSink::enqueue(LogLevel level, std::string_view line) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_.size() >= capacity_) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        std::string text;
+        if (!spare_.empty()) {
+            text = std::move(spare_.back());
+            spare_.pop_back();
+        }
+        text.assign(line.data(), line.size());   // Fits the reused capacity almost always
+        pending_.push_back({level, std::move(text)});
+        ++enqueued_;
+    }
+    cv_.notify_one();
+}
+
+bool AsyncLogSink::flush(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    uint64_t target = enqueued_;
+    return drainedCv_.wait_for(lock, timeout, [&] { return written_ >= target; });
+}
+
+LogSinkStats AsyncLogSink::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {sink_->name(), written_, dropped_.load(std::memory_order_relaxed)};
+}
+
+void AsyncLogSink::run() {
+    std::deque<Entry> batch;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return !pending_.empty() || stopping_; });
+            if (pending_.empty()) return;   // stopping and fully drained
+            batch.swap(pending_);
+        }
+
+        for (const auto& entry : batch) {
+            sink_->write(entry.level, entry.line);
+        }
+        sink_->flush();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            written_ += batch.size();
+            for (auto& entry : batch) {
+                if (spare_.size() >= MAX_SPARE_LINES) break;
+                if (entry.line.capacity() <= MAX_SPARE_CAPACITY) spare_.push_back(std::move(entry.line));
+            }
+        }
+        drainedCv_.notify_all();
+        batch.clear();
+    }
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+enum class LogLevel { DEBUG, INFO, WARN, ERROR };
+
+/// Destination for formatted log lines (console, file, memory, socket...).
+///
+/// write()/flush() are only ever called from the sink's own writer thread
+/// (see AsyncLogSink), so implementations need no locking against the
+/// producers. Each sink has its own level filter, independent of the others.
+class LogSink {
+public:
+    LogSink(std::string name, LogLevel minLevel)
+        : name_(std::move(name)), minLevel_(minLevel) {}
+    virtual ~LogSink() = default;
+
+    /// Write one line (without trailing newline).
+    virtual void write(LogLevel level, std::string_view line) = 0;
+
+    /// Called after each batch of writes.
+    virtual void flush() {}
+
+    const std::string& name() const { return name_; }
+
+    bool     accepts(LogLevel level) const { return level >= minLevel(); }
+    LogLevel minLevel() const { return minLevel_.load(std::memory_order_relaxed); }
+    void     setMinLevel(LogLevel level) { minLevel_.store(level, std::memory_order_relaxed); }
+
+private:
+    std::string           name_;
+    std::atomic<LogLevel> minLevel_;
+};
+
+/// Counters reported per sink by Logger::sinkStats().
+struct LogSinkStats {
+    std::string name;
+    uint64_t    written = 0;
+    uint64_t    dropped = 0;
+};
+
+/// Runs a LogSink on a dedicated writer thread behind a bounded queue.
+///
+/// Producers copy the line into a pooled buffer under a short lock; the
+/// writer swaps the whole pending batch out, performs I/O without holding
+/// it, and hands the buffers back to the pool, so a steady stream of lines
+/// allocates nothing. If the sink stalls and the queue fills, new lines are
+/// dropped and counted rather than blocking the trading threads.
+class AsyncLogSink {
+public:
+    AsyncLogSink(std::unique_ptr<LogSink> sink, size_t capacity);
+    ~AsyncLogSink();
+
+    AsyncLogSink(const AsyncLogSink&) = delete;
+    AsyncLogSink& operator=(const AsyncLogSink&) = delete;
+
+    /// Queue a line for writing. Never blocks on I/O; drops when full.
+    void enqueue(LogLevel level, std::string_view line);
+
+    /// Wait until everything queued before this call has been written,
+    /// or until `timeout` expires (a stalled sink must not hang callers).
+    bool flush(std::chrono::milliseconds timeout);
+
+    LogSink&     sink() { return *sink_; }
+    LogSinkStats stats() const;
+
+private:
+    struct Entry {
+        LogLevel    level;
+        std::string line;
+    };
+
+    void run();
+
+    std::unique_ptr<LogSink> sink_;
+    size_t                   capacity_;
+
+    mutable std::mutex       mutex_;
+    std::condition_variable  cv_;          // wakes the writer
+    std::condition_variable  drainedCv_;   // wakes flush() callers
+    std::deque<Entry>        pending_;
+    std::vector<std::string> spare_;       // Written lines' buffers, reused by enqueue()
+    uint64_t                 enqueued_ = 0;
+    uint64_t                 written_  = 0;
+    bool                     stopping_ = false;
+
+    std::atomic<uint64_t>    dropped_{0};
+    std::thread              thread_;
+};
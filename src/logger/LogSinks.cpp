@@ -0,0 +1,214 @@
+#include "logger/LogSinks.h"
+#include "format/TextWriter.h"
+
+#include <iostream>
+#include <cstring>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+/// Log lines buffered between flushes; a fuller buffer is written out early.
+static constexpr size_t FILE_BUFFER_BYTES = 256 * 1024;
+
+void ConsoleSink::write(LogLevel level, std::string_view line) {
+    std::cout.write(line.data(), static_cast<std::streamsize>(line.size()));
+    std::cout.put('\n');
+}
+
+void ConsoleSink::flush() {
+    std::cout.flush();
+}
+
+FileSink::FileSink(const std::string& path, LogLevel minLevel, const LogRotationConfig& rotation,
+                   IoRing::Options io)
+    : LogSink("file", minLevel)
+    , stream_(std::make_unique<LogFile>(path))
+    , buffer_(FILE_BUFFER_BYTES)
+{
+    if (!stream_->is_open()) {
+        std::cerr << "[Logger] WARNING: Could not open log file: " << path << std::endl;
+    }
+    attachIo(io);
+
+    if (rotation.enabled()) {
+        rotateAtBytes_ = rotation.maxBytes;
+        rotator_ = std::make_unique<LogRotator>(path, rotation,
+            [this](LogRotator::Stream next) { return swapStream(std::move(next)); });
+    }
+}
+
+FileSink::~FileSink() {
+    rotator_.reset();
+    std::lock_guard<std::mutex> lock(streamMutex_);
+    writeBuffer(false);
+}
+
+void FileSink::attachIo(IoRing::Options io) {
+    io_ = std::make_unique<IoRing>(io);
+    bufferIndex_ = io_->registerBuffer(buffer_.data(), buffer_.size());
+    ioFile_ = stream_ && stream_->is_open() ? io_->attachFile(stream_->fd()) : -1;
+}
+
+void FileSink::write(LogLevel level, std::string_view line) {
+    std::lock_guard<std::mutex> lock(streamMutex_);
+    if (ioFile_ < 0) return;
+
+    size_t bytes = line.size() + 1;
+    if (buffered_ + bytes > buffer_.size()) writeBuffer(false);
+    if (bytes > buffer_.size()) {
+        // Longer than the whole buffer: write it straight from the line
+        static const char newline = '\n';
+        io_->write(ioFile_, line.data(), line.size(), fileOffset_);
+        io_->write(ioFile_, &newline, 1, fileOffset_ + line.size());
+        fileOffset_ += bytes;
+        writeBuffer(false);
+    } else {
+        std::memcpy(buffer_.data() + buffered_, line.data(), line.size());
+        buffer_[buffered_ + line.size()] = '\n';
+        buffered_ += bytes;
+    }
+
+    bytesWritten_ += bytes;
+    if (rotateAtBytes_ > 0 && bytesWritten_ >= rotateAtBytes_) {
+        // Counted afresh either way: the swap resets it again, and if the
+        // rotation fails the next request comes another maxBytes later
+        // rather than on every line
+        bytesWritten_ = 0;
+        rotator_->requestRotation();
+    }
+}
+
+void FileSink::flush() {
+    std::lock_guard<std::mutex> lock(streamMutex_);
+    writeBuffer(fsync_);
+}
+
+void FileSink::writeBuffer(bool sync) {
+    if (ioFile_ < 0) {
+        buffered_ = 0;
+        return;
+    }
+    if (buffered_ > 0) {
+        io_->write(ioFile_, buffer_.data(), buffered_, fileOffset_, bufferIndex_);
+        fileOffset_ += buffered_;
+        buffered_ = 0;
+    }
+    if (sync && io_->queued() > 0) io_->fsync(ioFile_);
+
+    std::string error;
+    if (!io_->submit(&error) && !warned_) {
+        warned_ = true;
+        std::cerr << "[Logger] WARNING: Log file write failed: " << error << std::endl;
+    }
+}
+
+void FileSink::setIo(IoRing::Options io, bool fsync) {
+    std::lock_guard<std::mutex> lock(streamMutex_);
+    writeBuffer(false);
+    fsync_ = fsync;
+    attachIo(io);
+}
+
+IoRing::Stats FileSink::ioStats() const {
+    std::lock_guard<std::mutex> lock(streamMutex_);
+    return io_->stats();
+}
+
+std::string FileSink::ioBackend() const {
+    std::lock_guard<std::mutex> lock(streamMutex_);
+    return io_->backend();
+}
+
+LogRotator::Stream FileSink::swapStream(LogRotator::Stream next) {
+    std::lock_guard<std::mutex> lock(streamMutex_);
+    writeBuffer(false);     // Lines written before the swap end the old segment
+    io_->releaseFile(ioFile_);
+    std::swap(stream_, next);
+    ioFile_ = stream_ && stream_->is_open() ? io_->attachFile(stream_->fd()) : -1;
+    fileOffset_   = 0;
+    bytesWritten_ = 0;
+    return next;
+}
+
+MemoryRingSink::MemoryRingSink(size_t capacity, LogLevel minLevel)
+    : LogSink("memory", minLevel)
+    , ring_(capacity > 0 ? capacity : 1)
+{}
+
+void MemoryRingSink::write(LogLevel level, std::string_view line) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ring_[next_].assign(line.data(), line.size());
+    next_ = (next_ + 1) % ring_.size();
+    if (next_ == 0) full_ = true;
+}
+
+std::vector<std::string> MemoryRingSink::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> lines;
+    size_t count = full_ ? ring_.size() : next_;
+    size_t start = full_ ? next_ : 0;
+    lines.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        lines.push_back(ring_[(start + i) % ring_.size()]);
+    }
+    return lines;
+}
+
+UdpSyslogSink::UdpSyslogSink(const std::string& host, int port, LogLevel minLevel, std::string tag,
+                             IoRing::Options io)
+    : LogSink("syslog", minLevel)
+    , tag_(std::move(tag))
+    , io_(io)
+    , datagrams_(DATAGRAM_SLOTS * DATAGRAM_BYTES)
+{
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "[Logger] WARNING: Invalid syslog address: " << host << std::endl;
+        return;
+    }
+
+    fd_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd_ < 0) return;
+    // Connected UDP socket: plain send() later, errors surface per datagram.
+    if (::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd_);
+        fd_ = -1;
+        return;
+    }
+    ioFile_ = io_.attachFile(fd_);
+}
+
+UdpSyslogSink::~UdpSyslogSink() {
+    flush();
+    io_.releaseFile(ioFile_);
+    if (fd_ >= 0) ::close(fd_);
+}
+
+void UdpSyslogSink::write(LogLevel level, std::string_view line) {
+    if (fd_ < 0) return;
+
+    // RFC 3164 priority: facility user (1) * 8 + severity.
+    int severity = 7;
+    switch (level) {
+        case LogLevel::DEBUG: severity = 7; break;
+        case LogLevel::INFO:  severity = 6; break;
+        case LogLevel::WARN:  severity = 4; break;
+        case LogLevel::ERROR: severity = 3; break;
+    }
+
+    if (queued_ == DATAGRAM_SLOTS) flush();
+    char* datagram = datagrams_.data() + queued_++ * DATAGRAM_BYTES;
+    TextWriter out(datagram, DATAGRAM_BYTES);
+    out.append('<').appendInt(8 + severity).append('>')
+       .append(tag_).append(": ").append(line);
+    io_.send(ioFile_, datagram, out.size());
+}
+
+void UdpSyslogSink::flush() {
+    // Best effort, like the plain sends: a refused datagram is not retried
+    io_.submit();
+    queued_ = 0;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "logger/LogSink.h"
+#include "logger/LogRotator.h"
+#include "io/IoRing.h"
+
+#include <vector>
+#include <mutex>
+
+/// Writes lines to std::cout.
+class ConsoleSink : public LogSink {
+public:
+    explicit ConsoleSink(LogLevel minLevel = LogLevel::INFO)
+        : LogSink("console", minLevel) {}
+
+    void write(LogLevel level, std::string_view line) override;
+    void flush() override;
+};
+
+/// Appends lines to a file, optionally rotated by a background LogRotator.
+///
+/// Lines collect in a registered buffer; flush() (once per writer batch)
+/// hands it to the kernel through an IoRing - one io_uring_enter for the
+/// write and, with fsync on, the fdatasync after it.
+class FileSink : public LogSink {
+public:
+    FileSink(const std::string& path, LogLevel minLevel = LogLevel::INFO,
+             const LogRotationConfig& rotation = {}, IoRing::Options io = {});
+    ~FileSink() override;
+
+    void write(LogLevel level, std::string_view line) override;
+    void flush() override;
+
+    /// Switch I/O backend (log lines buffered so far are written first), and
+    /// whether every flush is followed by an fdatasync.
+    void setIo(IoRing::Options io, bool fsync);
+
+    IoRing::Stats ioStats() const;
+    std::string   ioBackend() const;
+
+private:
+    LogRotator::Stream swapStream(LogRotator::Stream next);
+
+    /// Write out the buffer (then fdatasync if `sync`). Caller holds streamMutex_.
+    void writeBuffer(bool sync);
+    void attachIo(IoRing::Options io);
+
+    mutable std::mutex          streamMutex_;    // Writer thread vs. rotator swap / setIo()
+    LogRotator::Stream          stream_;
+    std::unique_ptr<IoRing>     io_;
+    int                         ioFile_        = -1;   // stream_ in io_
+    std::vector<char>           buffer_;               // Registered with io_
+    int                         bufferIndex_   = -1;
+    size_t                      buffered_      = 0;
+    uint64_t                    fileOffset_    = 0;    // Bytes handed to the current file
+    bool                        fsync_         = false;
+    bool                        warned_        = false;
+    uint64_t                    bytesWritten_  = 0;
+    uint64_t                    rotateAtBytes_ = 0;
+    std::unique_ptr<LogRotator> rotator_;        // Declared last: joins before the stream closes
+};
+
+/// Keeps the most recent `capacity` lines in memory, e.g. for dumping the
+/// context around an incident without reading the log file.
+class MemoryRingSink : public LogSink {
+public:
+    explicit MemoryRingSink(size_t capacity = 1024, LogLevel minLevel = LogLevel::DEBUG);
+
+    void write(LogLevel level, std::string_view line) override;
+
+    /// Buffered lines, oldest first.
+    std::vector<std::string> snapshot() const;
+
+private:
+    mutable std::mutex       mutex_;
+    std::vector<std::string> ring_;
+    size_t                   next_  = 0;
+    bool                     full_  = false;
+};
+
+/// Sends each line as a syslog-style UDP datagram ("<PRI>tag: line").
+/// Stand-in for a remote collector; sends are non-blocking and best-effort.
+/// Datagrams are queued on an IoRing and sent together at flush() (or when
+/// DATAGRAM_SLOTS are waiting), one io_uring_enter per batch.
+class UdpSyslogSink : public LogSink {
+public:
+    UdpSyslogSink(const std::string& host, int port,
+                  LogLevel minLevel = LogLevel::WARN,
+                  std::string tag = "deal_processor",
+                  IoRing::Options io = {});
+    ~UdpSyslogSink() override;
+
+    void write(LogLevel level, std::string_view line) override;
+    void flush() override;
+
+    bool isOpen() const { return fd_ >= 0; }
+
+private:
+    static constexpr size_t DATAGRAM_BYTES = 1024;
+    static constexpr size_t DATAGRAM_SLOTS = 64;
+
+    int                 fd_ = -1;
+    std::string         tag_;
+    IoRing              io_;
+    int                 ioFile_ = -1;
+    std::vector<char>   datagrams_;     // DATAGRAM_SLOTS x DATAGRAM_BYTES
+    size_t              queued_ = 0;
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/// Throttling settings for one logging call site.
+struct LogSiteConfig {
+    double ratePerSec = 0.0;   // Sustained messages/sec; 0 = unlimited
+    double burst      = 10.0;  // Messages allowed back-to-back before the rate applies
+    double sampleRate = 1.0;   // Probability a message that passed the rate limit is kept
+};
+
+/// Per-call-site rate limiter and sampler.
+///
+/// A call site (e.g. "processor.retry") owns one LogSite; callers check
+/// admit() *before* building the message, so suppressed lines cost neither
+/// formatting nor console I/O. The token bucket is implemented as GCRA on a
+/// single atomic "theoretical arrival time", so admit() is lock-free and
+/// safe to call from every worker at once.
+///
+/// Suppressed messages are counted; Logger::admit() reports the count
+/// ("suppressed 12,345 similar messages") the next time the site is let
+/// through after the report interval, and Logger::reportSuppressed()
+/// flushes whatever is left.
+///
+/// The limits are published as one immutable snapshot behind an atomic
+/// pointer, so admit() never sees half of a reconfiguration (a new rate
+/// with the old burst). Snapshots are kept for the site's lifetime -
+/// reconfiguration is rare - so a reader's pointer never dangles.
+class LogSite {
+public:
+    explicit LogSite(std::string name, const LogSiteConfig& config = {})
+        : name_(std::move(name)) { configure(config); }
+
+    LogSite(const LogSite&) = delete;
+    LogSite& operator=(const LogSite&) = delete;
+
+    /// Apply new limits. Safe while other threads call admit(); concurrent
+    /// configure() calls must be serialized by the caller (Logger does).
+    void configure(const LogSiteConfig& config) {
+        auto limits = std::make_unique<Limits>();
+        limits->config = config;
+        limits->intervalNs = config.ratePerSec > 0.0 ? static_cast<int64_t>(1e9 / config.ratePerSec) : 0;
+        double burst = config.burst < 1.0 ? 1.0 : config.burst;
+        limits->toleranceNs = static_cast<int64_t>(limits->intervalNs * (burst - 1.0));
+        limits->sampleThreshold = config.sampleRate >= 1.0 ? UINT64_MAX
+                                : config.sampleRate <= 0.0 ? 0
+                                : static_cast<uint64_t>(config.sampleRate * 18446744073709551615.0);
+        limits_.store(limits.get(), std::memory_order_release);
+        history_.push_back(std::move(limits));
+    }
+
+    /// True if this message should be logged. Counts it as suppressed otherwise.
+    bool admit() {
+        const Limits& limits = *limits_.load(std::memory_order_acquire);
+        if (passesRateLimit(limits) && passesSample(limits)) return true;
+        suppressed_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    /// Take the suppressed count if at least `intervalNs` has passed since the
+    /// last report (or unconditionally with intervalNs == 0). Returns 0 otherwise.
+    uint64_t takeSuppressed(int64_t intervalNs = 0) {
+        if (suppressed_.load(std::memory_order_relaxed) == 0) return 0;
+        if (intervalNs > 0) {
+            int64_t now  = nowNs();
+            int64_t last = lastReportNs_.load(std::memory_order_relaxed);
+            if (now - last < intervalNs ||
+                !lastReportNs_.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+                return 0;
+            }
+        }
+        return suppressed_.exchange(0, std::memory_order_relaxed);
+    }
+
+    const std::string&   name() const   { return name_; }
+    const LogSiteConfig& config() const { return limits_.load(std::memory_order_acquire)->config; }
+
+private:
+    /// One configuration, precomputed for admit().
+    struct Limits {
+        LogSiteConfig config;
+        int64_t       intervalNs      = 0;            // 0 = no rate limit
+        int64_t       toleranceNs     = 0;
+        uint64_t      sampleThreshold = UINT64_MAX;   // UINT64_MAX = keep all
+    };
+
+    static int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    bool passesRateLimit(const Limits& limits) {
+        int64_t interval = limits.intervalNs;
+        if (interval == 0) return true;
+
+        int64_t tolerance = limits.toleranceNs;
+        int64_t now = nowNs();
+        int64_t tat = tat_.load(std::memory_order_relaxed);
+        while (true) {
+            int64_t start = tat > now ? tat : now;
+            if (start - now > tolerance) return false;   // bucket empty
+            if (tat_.compare_exchange_weak(tat, start + interval, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+    }
+
+    bool passesSample(const Limits& limits) {
+        uint64_t threshold = limits.sampleThreshold;
+        if (threshold == UINT64_MAX) return true;
+        // xorshift64*: cheap thread-local randomness, no shared RNG state.
+        thread_local uint64_t state = 0x9E3779B97F4A7C15ull ^
+            reinterpret_cast<uintptr_t>(&state);
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1Dull < threshold;
+    }
+
+    std::string           name_;
+    std::atomic<const Limits*>                 limits_{nullptr};   // Current snapshot
+    std::vector<std::unique_ptr<const Limits>> history_;           // Every snapshot (guarded by configure's caller)
+    std::atomic<int64_t>  tat_{0};            // GCRA theoretical arrival time
+    std::atomic<uint64_t> suppressed_{0};
+    std::atomic<int64_t>  lastReportNs_{0};
+};
@@ -1,24 +1,28 @@
 #include "logger/Logger.h"
 
 #include <iostream>
+#include <algorithm>
 #include <chrono>
 #include <sstream>
-#include <iomanip>
 #include <thread>
+#include <ctime>
 
-Logger::Logger(const std::string& logFile, LogLevel minLevel)
-    : minLevel_(minLevel)
-{
-    logFile_.open(logFile, std::ios::out | std::ios::trunc);
-    if (!logFile_.is_open()) {
-        std::cerr << "[Logger] WARNING: Could not open log file: " << logFile << std::endl;
+Logger::Logger(const std::string& logFile, LogLevel minLevel, const LogRotationConfig& rotation) {
+    addSink(std::make_unique<ConsoleSink>(minLevel));
+    if (!logFile.empty()) {
+        addSink(std::make_unique<FileSink>(logFile, minLevel, rotation));
     }
 }
 
 Logger::~Logger() {
-    if (logFile_.is_open()) {
-        logFile_.close();
+    flush();
+    for (const auto& stats : sinkStats()) {
+        if (stats.dropped > 0) {
+            std::cerr << "[Logger] WARNING: sink '" << stats.name << "' dropped "
+                      << stats.dropped << " lines (queue full)" << std::endl;
+        }
     }
+    for (auto& sink : sinks_) sink.reset();   // Joins writer threads after draining
 }
 
 void Logger::debug(const std::string& message) { log(LogLevel::DEBUG, message); }
@@ -26,25 +30,186 @@ void Logger::info(const std::string& message)  { log(LogLevel::INFO, message); }
 void Logger::warn(const std::string& message)  { log(LogLevel::WARN, message); }
 void Logger::error(const std::string& message) { log(LogLevel::ERROR, message); }
 
+LogSite& Logger::site(const std::string& name, const LogSiteConfig& defaults) {
+    std::lock_guard<std::mutex> lock(sitesMutex_);
+    auto& slot = sites_[name];
+    if (!slot) {
+        auto it = siteOverrides_.find(name);
+        slot = std::make_unique<LogSite>(name, it != siteOverrides_.end()
+                                               ? applyOverrides(defaults, it->second) : defaults);
+    }
+    return *slot;
+}
+
+bool Logger::admit(LogSite& site, LogLevel level) {
+    if (!isEnabled(level) || !site.admit()) return false;
+
+    uint64_t suppressed = site.takeSuppressed(suppressedReportNs_.load(std::memory_order_relaxed));
+    if (suppressed > 0) {
+        log(level, TextWriter::render([&](TextWriter& out) {
+            out.append('[').append(site.name()).append("] suppressed ")
+               .appendGrouped(suppressed).append(" similar messages");
+        }));
+    }
+    return true;
+}
+
+void Logger::reportSuppressed() {
+    std::lock_guard<std::mutex> lock(sitesMutex_);
+    for (auto& [name, site] : sites_) {
+        uint64_t suppressed = site->takeSuppressed();
+        if (suppressed == 0) continue;
+        log(LogLevel::WARN, TextWriter::render([&](TextWriter& out) {
+            out.append('[').append(name).append("] suppressed ")
+               .appendGrouped(suppressed).append(" similar messages");
+        }));
+    }
+}
+
+void Logger::configure(const ConfigFile& config) {
+    for (const char* name : {"console", "file"}) {
+        if (LogSink* sink = findSink(name)) {
+            setSinkLevel(name, parseLevel(config.getString("log." + std::string(name) + ".level"),
+                                          sink->minLevel()));
+        }
+    }
+
+    if (auto* file = dynamic_cast<FileSink*>(findSink("file"))) {
+        file->setIo(IoRing::optionsFrom(config), config.getBool("log.file.fsync", false));
+    }
+
+    long long memoryLines = config.getInt("log.memory.capacity", 0);
+    if (memoryLines > 0 && !findSink("memory")) {
+        addSink(std::make_unique<MemoryRingSink>(static_cast<size_t>(memoryLines)));
+    }
+
+    if (config.has("log.syslog.host") && !findSink("syslog")) {
+        addSink(std::make_unique<UdpSyslogSink>(
+            config.getString("log.syslog.host"),
+            static_cast<int>(config.getInt("log.syslog.port", 514)),
+            parseLevel(config.getString("log.syslog.level"), LogLevel::WARN),
+            "deal_processor", IoRing::optionsFrom(config)));
+    }
+
+    suppressedReportNs_.store(config.getInt("log.suppressed_report_ms", 1000) * 1000000,
+                              std::memory_order_relaxed);
+
+    const std::string prefix = "log.site.";
+    std::lock_guard<std::mutex> lock(sitesMutex_);
+    for (const auto& key : config.keysWithPrefix(prefix)) {
+        // "log.site.<name>.<field>" - the site name itself may contain dots.
+        size_t dot = key.rfind('.');
+        if (dot <= prefix.size()) continue;
+        std::string name  = key.substr(prefix.size(), dot - prefix.size());
+        std::string field = key.substr(dot + 1);
+
+        siteOverrides_[name].set(field, config.getString(key));
+    }
+
+    // Re-apply to sites that already exist; fields not mentioned keep their values.
+    for (auto& [name, site] : sites_) {
+        auto it = siteOverrides_.find(name);
+        if (it != siteOverrides_.end()) site->configure(applyOverrides(site->config(), it->second));
+    }
+}
+
+LogSiteConfig Logger::applyOverrides(LogSiteConfig base, const ConfigFile& overrides) {
+    base.ratePerSec = overrides.getDouble("rate", base.ratePerSec);
+    base.burst      = overrides.getDouble("burst", base.burst);
+    base.sampleRate = overrides.getDouble("sample", base.sampleRate);
+    return base;
+}
+
 void Logger::log(LogLevel level, const std::string& message) {
-    if (level < minLevel_) return;
+    if (!isEnabled(level)) return;
 
-    std::string formatted = "[" + timestamp() + "] [" + levelStr(level) + "] "
-                          + "[" + threadId() + "] " + message;
+    // Format the whole line once on this thread, on the stack; each sink
+    // copies it into one of its pooled buffers.
+    auto format = [&](TextWriter& out) {
+        out.append('[');
+        appendTimestamp(out);
+        out.append("] [").append(levelStr(level)).append("] [")
+           .append(threadName()).append("] ").append(message);
+    };
+    char buffer[512];
+    TextWriter writer(buffer);
+    format(writer);
+    std::string longLine;
+    std::string_view line = writer.view();
+    if (writer.truncated()) {
+        longLine = TextWriter::render(format);
+        line = longLine;
+    }
+
+    size_t count = sinkCount_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        if (sinks_[i]->sink().accepts(level)) {
+            sinks_[i]->enqueue(level, line);
+        }
+    }
+}
 
-    std::lock_guard<std::mutex> lock(mutex_);
+LogSink* Logger::addSink(std::unique_ptr<LogSink> sink, size_t queueCapacity) {
+    std::lock_guard<std::mutex> lock(sinksMutex_);
+    size_t count = sinkCount_.load(std::memory_order_relaxed);
+    if (count == MAX_SINKS) return nullptr;
 
-    // Write to console
-    std::cout << formatted << std::endl;
+    sinks_[count] = std::make_unique<AsyncLogSink>(std::move(sink), queueCapacity);
+    sinkCount_.store(count + 1, std::memory_order_release);
+    updateGate();
+    return &sinks_[count]->sink();
+}
 
-    // Write to file
-    if (logFile_.is_open()) {
-        logFile_ << formatted << std::endl;
-        logFile_.flush();
+LogSink* Logger::findSink(const std::string& name) {
+    size_t count = sinkCount_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        if (sinks_[i]->sink().name() == name) return &sinks_[i]->sink();
     }
+    return nullptr;
+}
+
+bool Logger::setSinkLevel(const std::string& name, LogLevel level) {
+    LogSink* sink = findSink(name);
+    if (!sink) return false;
+    std::lock_guard<std::mutex> lock(sinksMutex_);
+    sink->setMinLevel(level);
+    updateGate();
+    return true;
+}
+
+void Logger::updateGate() {
+    LogLevel lowest = LogLevel::ERROR;
+    size_t count = sinkCount_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; ++i) lowest = std::min(lowest, sinks_[i]->sink().minLevel());
+    gateLevel_.store(lowest, std::memory_order_relaxed);
 }
 
-std::string Logger::levelStr(LogLevel level) const {
+void Logger::flush(std::chrono::milliseconds timeout) {
+    size_t count = sinkCount_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        sinks_[i]->flush(timeout);
+    }
+}
+
+std::vector<LogSinkStats> Logger::sinkStats() const {
+    size_t count = sinkCount_.load(std::memory_order_acquire);
+    std::vector<LogSinkStats> stats;
+    stats.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        stats.push_back(sinks_[i]->stats());
+    }
+    return stats;
+}
+
+LogLevel Logger::parseLevel(const std::string& text, LogLevel fallback) {
+    if (text == "DEBUG" || text == "debug") return LogLevel::DEBUG;
+    if (text == "INFO"  || text == "info")  return LogLevel::INFO;
+    if (text == "WARN"  || text == "warn")  return LogLevel::WARN;
+    if (text == "ERROR" || text == "error") return LogLevel::ERROR;
+    return fallback;
+}
+
+const char* Logger::levelStr(LogLevel level) const {
     switch (level) {
         case LogLevel::DEBUG: return "DEBUG";
         case LogLevel::INFO:  return "INFO ";
@@ -54,20 +219,41 @@ std::string Logger::levelStr(LogLevel level) const {
     return "?????";
 }
 
-std::string Logger::timestamp() const {
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
+void Logger::appendTimestamp(TextWriter& out) const {
+    // "YYYY-mm-dd HH:MM:SS." is rebuilt at most once per second per thread;
+    // every other line only patches the three millisecond digits. This keeps
+    // localtime() (global lock + possible TZ re-read in glibc) off the hot path.
+    struct SecondCache {
+        int64_t second = -1;
+        char    text[24] = {};   // "YYYY-mm-dd HH:MM:SS.mmm"
+    };
+    thread_local SecondCache cache;
+
+    auto sinceEpoch = std::chrono::system_clock::now().time_since_epoch();
+    int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(sinceEpoch).count();
+    int64_t second = ms / 1000;
+
+    if (second != cache.second) {
+        std::time_t time = static_cast<std::time_t>(second);
+        std::tm local{};
+        localtime_r(&time, &local);
+        std::strftime(cache.text, sizeof(cache.text), "%Y-%m-%d %H:%M:%S.", &local);
+        cache.second = second;
+    }
 
-    std::ostringstream oss;
-    oss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S")
-        << "." << std::setfill('0') << std::setw(3) << ms.count();
-    return oss.str();
+    int millis = static_cast<int>(ms % 1000);
+    cache.text[20] = static_cast<char>('0' + millis / 100);
+    cache.text[21] = static_cast<char>('0' + millis / 10 % 10);
+    cache.text[22] = static_cast<char>('0' + millis % 10);
+    out.append(std::string_view(cache.text, 23));
 }
 
-std::string Logger::threadId() const {
-    std::ostringstream oss;
-    oss << "Thread-" << std::this_thread::get_id();
-    return oss.str();
+const std::string& Logger::threadName() const {
+    // Built once per thread; the id never changes for the thread's lifetime.
+    thread_local const std::string name = [] {
+        std::ostringstream oss;
+        oss << "Thread-" << std::this_thread::get_id();
+        return oss.str();
+    }();
+    return name;
 }
@@ -1,17 +1,37 @@
 #pragma once
 
+#include "format/TextWriter.h"
+#include "logger/LogSink.h"
+#include "logger/LogSinks.h"
+#include "logger/LogSite.h"
+#include "config/ConfigFile.h"
+
 #include <string>
-#include <fstream>
+#include <array>
+#include <vector>
 #include <mutex>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
 
-enum class LogLevel { DEBUG, INFO, WARN, ERROR };
-
-/// Thread-safe logger that writes to both console and a log file.
-/// Uses a mutex to prevent interleaved output from multiple worker threads.
+/// Thread-safe logger with pluggable sinks.
+///
+/// Each line is formatted once on the calling thread (into a stack buffer)
+/// and copied to every sink whose level admits it. Sinks (console, file,
+/// memory ring, syslog socket) run on their own writer threads behind
+/// bounded queues, so a slow terminal no longer throttles the workers; a
+/// stalled sink drops lines and counts them instead of blocking. By default
+/// a console and a file sink are installed, both at `minLevel`; the file
+/// sink rotates per LogRotationConfig.
+///
+/// Levels are per sink: a line is formatted when at least one sink wants
+/// it, so e.g. a DEBUG file sink works behind an INFO console.
 class Logger {
 public:
     explicit Logger(const std::string& logFile = "deal_processor.log",
-                    LogLevel minLevel = LogLevel::INFO);
+                    LogLevel minLevel = LogLevel::INFO,
+                    const LogRotationConfig& rotation = {});
     ~Logger();
 
     void debug(const std::string& message);
@@ -21,12 +41,81 @@ public:
 
     void log(LogLevel level, const std::string& message);
 
+    /// Install an additional sink. Safe while other threads log (configure()
+    /// adds sinks at runtime); sinks are never removed before the Logger is
+    /// destroyed. Returns nullptr once MAX_SINKS are installed.
+    LogSink* addSink(std::unique_ptr<LogSink> sink, size_t queueCapacity = DEFAULT_QUEUE_CAPACITY);
+
+    /// Find an installed sink by name ("console", "file", "memory", "syslog").
+    LogSink* findSink(const std::string& name);
+
+    /// Change one sink's level. Use this rather than LogSink::setMinLevel()
+    /// so the logger's gate (the lowest sink level) follows.
+    bool setSinkLevel(const std::string& name, LogLevel level);
+
+    /// Block until every sink has written what was logged before the call
+    /// (bounded by `timeout` per sink). Use before writing to std::cout directly.
+    void flush(std::chrono::milliseconds timeout = std::chrono::seconds(2));
+
+    /// Written/dropped counters per sink.
+    std::vector<LogSinkStats> sinkStats() const;
+
+    static LogLevel parseLevel(const std::string& text, LogLevel fallback);
+
+    static constexpr size_t DEFAULT_QUEUE_CAPACITY = 65536;
+    static constexpr size_t MAX_SINKS              = 8;
+
+    /// True if some sink would write a line at `level`.
+    bool isEnabled(LogLevel level) const { return level >= gateLevel_.load(std::memory_order_relaxed); }
+
+    /// Get (or create) the rate limiter for a named call site. The returned
+    /// reference stays valid for the Logger's lifetime; callers keep it.
+    /// `defaults` apply unless the loaded configuration overrides them.
+    LogSite& site(const std::string& name, const LogSiteConfig& defaults = {});
+
+    /// Check a throttled call site before building its message:
+    ///   if (logger.admit(site, LogLevel::WARN)) logger.warn(...);
+    /// Emits the site's pending "suppressed N similar messages" line when due.
+    bool admit(LogSite& site, LogLevel level);
+
+    /// Log any suppressed counts not reported yet (e.g. at shutdown).
+    void reportSuppressed();
+
+    /// Apply "log.*" settings:
+    ///   log.console.level             = DEBUG | INFO | WARN | ERROR
+    ///   log.file.level                = ...
+    ///   log.file.fsync                = fdatasync after every batch written
+    ///   io.backend / io.ring_entries  = file and syslog sink I/O (IoRing::optionsFrom)
+    ///   log.memory.capacity           = lines kept in a MemoryRingSink (0 = none)
+    ///   log.syslog.host / .port       = UDP collector (adds an UdpSyslogSink)
+    ///   log.syslog.level              = ...
+    ///   log.suppressed_report_ms      = 1000
+    ///   log.site.<name>.rate          = messages/sec (0 = unlimited)
+    ///   log.site.<name>.burst         = messages
+    ///   log.site.<name>.sample        = 0.0 .. 1.0
+    void configure(const ConfigFile& config);
+
 private:
-    std::string levelStr(LogLevel level) const;
-    std::string timestamp() const;
-    std::string threadId() const;
+    const char*        levelStr(LogLevel level) const;
+    void               appendTimestamp(TextWriter& out) const;
+    const std::string& threadName() const;
+
+    static LogSiteConfig applyOverrides(LogSiteConfig base, const ConfigFile& overrides);
+
+    /// Recompute gateLevel_ from the installed sinks.
+    void updateGate();
+
+    // Installed sinks: slots [0, sinkCount_) are set and never change, so
+    // log() walks them without a lock; addSink() fills the next slot under
+    // sinksMutex_ and then publishes the new count.
+    std::array<std::unique_ptr<AsyncLogSink>, MAX_SINKS> sinks_;
+    std::atomic<size_t>                                  sinkCount_{0};
+    std::mutex                                           sinksMutex_;
+    std::atomic<LogLevel>                                gateLevel_{LogLevel::ERROR};   // Lowest sink level
 
-    std::ofstream logFile_;
-    LogLevel      minLevel_;
-    std::mutex    mutex_;
+    // Throttled call sites (see site()/admit())
+    std::unordered_map<std::string, std::unique_ptr<LogSite>> sites_;
+    std::unordered_map<std::string, ConfigFile>               siteOverrides_;
+    std::mutex                                                sitesMutex_;
+    std::atomic<int64_t>                                      suppressedReportNs_{1000000000};
 };
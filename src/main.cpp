@@ -1,13 +1,23 @@
 #include "logger/Logger.h"
 #include "mt_api/MockMTAPI.h"
+#include "mt_api/BrokerRouter.h"
 #include "processor/DealProcessor.h"
 #include "client/ClientSimulator.h"
+#include "config/ConfigFile.h"
+#include "processor/RuleEngine.h"
+#include "persistence/StatePersistence.h"
+#include "perf/SamplingProfiler.h"
+#include "persistence/ResultFeed.h"
 
 #include <iostream>
 #include <memory>
 #include <vector>
 #include <thread>
 #include <chrono>
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+#include <filesystem>
 
 /// ============================================================================
 /// MT5 Deal Processor - Self-Contained Demo
@@ -30,10 +40,44 @@
 ///   - DealGet               : Post-execution ticket verification
 /// ============================================================================
 
-void runNormalSimulation(Logger& logger, IMTBrokerAPI& api);
-void runBurstSimulation(Logger& logger, IMTBrokerAPI& api);
+void runNormalSimulation(Logger& logger, IMTBrokerAPI& api, const ConfigFile& config, const RuleEngine& rules,
+                         const TradingCalendar& calendar, StatePersistence* state, ResultFeed* feed);
+void runBurstSimulation(Logger& logger, IMTBrokerAPI& api, const ConfigFile& config, const RuleEngine& rules,
+                        const TradingCalendar& calendar, StatePersistence* state, ResultFeed* feed);
+int  runFeedTail(const ConfigFile& config, const std::string& consumer, uint64_t fromSequence);
+std::unique_ptr<MockMTAPI> makeMockBroker(const std::string& scenarioPath, const ConfigFile& config, Logger& logger);
+void attachState(DealProcessor& processor, StatePersistence& state, const ConfigFile& config, Logger& logger);
+void applyExecutionModel(ProcessorConfig& procConfig, const ConfigFile& config);
+void logSessions(Logger& logger, const std::vector<std::unique_ptr<ClientSimulator>>& clients);
+void logRecentFailures(Logger& logger, const ResultTracker& tracker);
 
 int main(int argc, char* argv[]) {
+    // Determine which mode to run and where runtime settings live
+    bool burstMode     = false;
+    std::string configPath = "deal_processor.conf";
+    std::string scenarioPath;
+    std::string tailConsumer;
+    uint64_t    tailFrom = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--burst") {
+            burstMode = true;
+        } else if (arg == "--config" && i + 1 < argc) {
+            configPath = argv[++i];
+        } else if (arg == "--scenario" && i + 1 < argc) {
+            scenarioPath = argv[++i];
+        } else if (arg == "--tail-feed" && i + 1 < argc) {
+            tailConsumer = argv[++i];
+        } else if (arg == "--from" && i + 1 < argc) {
+            tailFrom = std::strtoull(argv[++i], nullptr, 10);
+        }
+    }
+
+    if (!tailConsumer.empty()) {
+        auto tailConfig = ConfigFile::load(configPath);
+        return runFeedTail(tailConfig ? *tailConfig : ConfigFile(), tailConsumer, tailFrom);
+    }
+
     std::cout << "================================================================\n"
               << "  MT5 Deal Processor - Self-Contained Demo\n"
               << "  Hentec Trading - C++ Developer Task\n"
@@ -44,11 +88,147 @@ int main(int argc, char* argv[]) {
               << "  testing. All other errors are real validation failures.\n"
               << "================================================================\n\n";
 
-    // Initialize logger
-    Logger logger("deal_processor.log", LogLevel::INFO);
+    // Initialize logger (rotates at 64 MB or hourly, keeps 5 compressed segments)
+    LogRotationConfig rotation;
+    rotation.maxBytes  = 64ull * 1024 * 1024;
+    rotation.maxAge    = std::chrono::hours(1);
+    rotation.retention = 5;
+    Logger logger("deal_processor.log", LogLevel::INFO, rotation);
+
+    // Optional runtime configuration (log rate limits/sampling, ...)
+    ConfigFile config;
+    if (auto loaded = ConfigFile::load(configPath)) {
+        config = std::move(*loaded);
+        logger.configure(config);
+        logger.info("Loaded configuration from " + configPath);
+    }
+
+    // Validation rules: "rule.*" entries, from rules.file if set, hot-reloaded
+    RuleEngine rules(logger);
+    std::string rulesPath = config.getString("rules.file", configPath);
+    if (auto rulesConfig = rulesPath == configPath ? std::optional<ConfigFile>(config)
+                                                   : ConfigFile::load(rulesPath)) {
+        rules.load(*rulesConfig);
+    }
+    // Watch only a file that exists: nothing to reload otherwise
+    std::error_code rulesMissing;
+    if (long long reloadMs = config.getInt("rules.reload_ms", 1000);
+        reloadMs > 0 && std::filesystem::exists(rulesPath, rulesMissing)) {
+        rules.watch(rulesPath, std::chrono::milliseconds(reloadMs));
+    }
 
-    // Initialize mock MT5 API (3% random failure rate for realistic testing)
-    MockMTAPI api(0.03);
+    // Trading sessions per symbol ("calendar.*"), enforced by the validator
+    // and by the mock server
+    TradingCalendar calendar;
+    if (std::string error; !calendar.load(config, error)) {
+        logger.error("Invalid trading calendar: " + error);
+        logger.flush();
+        return 1;
+    }
+    for (const auto& line : calendar.describe()) logger.info(line);
+
+    // Initialize mock MT5 API: 3% random failure rate for realistic testing,
+    // or the latency/failure models of a scenario file (--scenario / broker.scenario)
+    if (scenarioPath.empty()) scenarioPath = config.getString("broker.scenario");
+    auto primary = makeMockBroker(scenarioPath, config, logger);
+    if (!primary) {
+        logger.flush();
+        return 1;
+    }
+    primary->setCalendar(&calendar);
+    IMTBrokerAPI* broker = primary.get();
+
+    // Optional multi-server routing: one mock backend per router.backends entry,
+    // each with its own scenario (router.backend.<name>.scenario)
+    std::vector<std::unique_ptr<MockMTAPI>> backends;
+    std::vector<std::string> backendServers;   // Name of backends[i]
+    std::unique_ptr<BrokerRouter> router;
+    std::string backendList = config.getString("router.backends");
+    std::replace(backendList.begin(), backendList.end(), ',', ' ');
+    std::istringstream backendNames(backendList);
+    for (std::string name; backendNames >> name; ) {
+        if (!router) router = std::make_unique<BrokerRouter>(logger, BrokerRouter::optionsFrom(config));
+        std::string prefix = "router.backend." + name + ".";
+        auto backend = makeMockBroker(config.getString(prefix + "scenario", scenarioPath), config, logger);
+        if (!backend) {
+            logger.flush();
+            return 1;
+        }
+        BackendConfig backendConfig;
+        backendConfig.threads    = static_cast<int>(config.getInt(prefix + "threads", backendConfig.threads));
+        backendConfig.queueLimit = static_cast<int>(config.getInt(prefix + "queue_limit", backendConfig.queueLimit));
+        backend->setCalendar(&calendar);
+        router->addBackend(name, *backend, backendConfig);
+        backends.push_back(std::move(backend));
+        backendServers.push_back(name);
+    }
+    if (router) {
+        if (!router->configure(config)) {
+            logger.flush();
+            return 1;
+        }
+        logger.info("Routing trades across " + std::to_string(backends.size()) + " broker backends");
+        broker = router.get();
+    }
+    IMTBrokerAPI& api = *broker;
+
+    // The router answers synchronously and would block a reactor loop
+    if (router && config.getString("processor.mode") == "reactor") {
+        logger.warn("processor.mode = reactor is not supported with router.backends - using worker threads");
+        config.set("processor.mode", "threads");
+    }
+
+    // Optional warm restart: results, dedup set and account state persisted
+    // under state.dir (snapshot + journal tail)
+    std::unique_ptr<StatePersistence> state;
+    if (std::string stateDir = config.getString("state.dir"); !stateDir.empty()) {
+        // Accounts are keyed by (server, login): the backends share the login
+        std::vector<std::pair<std::string, MockMTAPI*>> mocks;
+        if (backends.empty()) mocks.emplace_back("primary", primary.get());
+        for (size_t i = 0; i < backends.size(); ++i) mocks.emplace_back(backendServers[i], backends[i].get());
+
+        state = std::make_unique<StatePersistence>(logger, stateDir, StateJournal::optionsFrom(config));
+        state->setRetainResults(static_cast<size_t>(std::max(0LL, config.getInt("state.retain_results", 1000000))));
+        state->open();
+        for (const AccountState& restored : state->restoredAccounts()) {
+            for (auto& [server, mock] : mocks) {
+                if (server == restored.server && mock->accountState().login == restored.account.login) {
+                    mock->restoreAccount(restored.account);
+                }
+            }
+        }
+        state->setAccountSource([mocks] {
+            std::vector<AccountState> snapshot;
+            for (const auto& [server, mock] : mocks) snapshot.push_back({server, mock->accountState()});
+            return snapshot;
+        });
+    }
+
+    // Optional change-data-capture feed of every tracked result (feed.dir),
+    // tailed by downstream consumers with --tail-feed
+    std::unique_ptr<ResultFeed> feed;
+    if (std::string feedDir = config.getString("feed.dir"); !feedDir.empty()) {
+        feed = std::make_unique<ResultFeed>(feedDir, ResultFeed::optionsFrom(config));
+        if (std::string error; !feed->open(error)) {
+            logger.error("Result feed unavailable (" + error + "); results will not be published");
+            feed.reset();
+        } else {
+            logger.info("Result feed " + feedDir + ": next sequence " + std::to_string(feed->nextSequence()));
+        }
+    }
+
+    // Optional built-in sampling profiler (profiler.hz): worker and loop
+    // stacks tagged with their pipeline stage, exported as folded stacks
+    std::unique_ptr<SamplingProfiler> profiler;
+    if (auto options = SamplingProfiler::optionsFrom(config); options.hz > 0) {
+        profiler = std::make_unique<SamplingProfiler>(options);
+        if (std::string error; !profiler->start(error)) {
+            logger.error("Sampling profiler unavailable (" + error + ")");
+            profiler.reset();
+        } else {
+            logger.info("Sampling profiler at " + std::to_string(options.hz) + " Hz, exporting to " + options.output);
+        }
+    }
 
     // Connect to "MT5 server" (simulated)
     logger.info("Connecting to MT5 server...");
@@ -80,17 +260,32 @@ int main(int argc, char* argv[]) {
                      " FreeMargin=$" + std::to_string(account->freeMargin));
     }
 
-    // Determine which simulation to run
-    bool burstMode = false;
-    if (argc > 1 && std::string(argv[1]) == "--burst") {
-        burstMode = true;
-    }
-
+    logger.flush();
     std::cout << "\n";
     if (burstMode) {
-        runBurstSimulation(logger, api);
+        runBurstSimulation(logger, api, config, rules, calendar, state.get(), feed.get());
     } else {
-        runNormalSimulation(logger, api);
+        runNormalSimulation(logger, api, config, rules, calendar, state.get(), feed.get());
+    }
+
+    if (router) {
+        for (const auto& line : router->backendSummary()) logger.info(line);
+    }
+    if (feed) {
+        logger.info("Result feed: next sequence " + std::to_string(feed->nextSequence()) + ", " +
+                    std::to_string(feed->dropped()) + " results dropped (no spare segment ready)");
+    }
+    if (profiler) {
+        profiler->stop();
+        auto stats = profiler->stats();
+        std::ostringstream oss;
+        oss << "Sampling profiler: " << stats.samples << " samples (" << stats.dropped << " dropped) over "
+            << std::fixed << std::setprecision(1) << stats.cpuMs << "ms CPU (" << std::setprecision(0)
+            << stats.achievedHz << " of " << profiler->options().hz << " Hz), overhead "
+            << std::setprecision(3) << stats.overheadPercent << "% (" << stats.requestedOverheadPercent
+            << "% at the requested rate), per sample " << std::setprecision(2) << stats.signalUs
+            << "us signal + " << stats.handlerUs << "us handler -> " << profiler->options().output;
+        logger.info(oss.str());
     }
 
     // Disconnect
@@ -100,16 +295,114 @@ int main(int argc, char* argv[]) {
     return 0;
 }
 
+/// Mock broker with the default 3% failure model, or the given scenario file.
+/// Returns nullptr (after logging) if the scenario cannot be loaded.
+std::unique_ptr<MockMTAPI> makeMockBroker(const std::string& scenarioPath, const ConfigFile& config, Logger& logger) {
+    BrokerScenario scenario = BrokerScenario::uniform(10, 100, 0.03);
+    if (!scenarioPath.empty()) {
+        auto scenarioConfig = ConfigFile::load(scenarioPath);
+        std::string error;
+        auto loaded = scenarioConfig ? BrokerScenario::fromConfig(*scenarioConfig, error) : std::nullopt;
+        if (!loaded) {
+            logger.error("Cannot load broker scenario " + scenarioPath + ": " +
+                         (scenarioConfig ? error : "file not found"));
+            return nullptr;
+        }
+        scenario = std::move(*loaded);
+        logger.info(scenario.describe());
+    }
+    auto api = std::make_unique<MockMTAPI>(std::move(scenario));
+    api->configureTradeStore(static_cast<size_t>(config.getInt("broker.expected_trades", 4096)),
+                             static_cast<size_t>(config.getInt("broker.trade_retention", 0)));
+    return api;
+}
+
+/// Warm restart: reload persisted results into the processor (tracker +
+/// dedup set), skip the request ID sequence past them, then journal new
+/// results and snapshot every state.snapshot_ms.
+void attachState(DealProcessor& processor, StatePersistence& state, const ConfigFile& config, Logger& logger) {
+    auto stats = state.restoreResults([&](const TradeResult& result) { processor.restoreResult(result); });
+    if (stats.anySequence) RequestIdAllocator::reserveThrough(stats.maxSequence);
+    if (stats.snapshotResults + stats.journalResults > 0) {
+        std::ostringstream oss;
+        oss << "Warm restart: " << stats.snapshotResults << " results from snapshot ("
+            << stats.mappedBytes / 1024 << " KB mapped), " << stats.journalResults
+            << " from journal tail, " << stats.accounts << " accounts in "
+            << std::fixed << std::setprecision(2) << stats.elapsedMs << "ms";
+        logger.info(oss.str());
+    }
+
+    ResultTracker& tracker = processor.getTracker();
+    tracker.setJournal(&state.journal());
+    state.start([&tracker](uint64_t& closed, std::string& error) { return tracker.rotateJournal(closed, error); },
+                std::chrono::milliseconds(config.getInt("state.snapshot_ms", 5000)));
+}
+
+/// Read the execution model into `procConfig`: processor.mode (threads |
+/// reactor), processor.reactor_loops and processor.completion_threads.
+void applyExecutionModel(ProcessorConfig& procConfig, const ConfigFile& config) {
+    if (config.getString("processor.mode", "threads") == "reactor") {
+        procConfig.model = ExecutionModel::REACTOR;
+    }
+    procConfig.reactorLoops      = static_cast<int>(config.getInt("processor.reactor_loops", 0));
+    procConfig.completionThreads = static_cast<int>(config.getInt("processor.completion_threads", 0));
+}
+
+/// Drain each client's session and report its result stream: results
+/// received, last sequence number, and submits held back by flow control.
+void logSessions(Logger& logger, const std::vector<std::unique_ptr<ClientSimulator>>& clients) {
+    for (const auto& client : clients) {
+        client->collect();
+        const auto& results = client->results();
+        logger.info("Session " + client->clientId() + ": " + std::to_string(results.size()) +
+                    " results, last seq " + std::to_string(results.empty() ? 0 : results.back().sequence) +
+                    ", credit stalls " + std::to_string(client->creditStalls()));
+    }
+}
+
+/// Per-instrument failures over the last five minutes, answered from the
+/// tracker's indexes (the kind of question ops asks during an incident).
+void logRecentFailures(Logger& logger, const ResultTracker& tracker) {
+    auto since = std::chrono::system_clock::now() - std::chrono::minutes(5);
+    for (std::string_view symbol : DEFAULT_INSTRUMENTS) {
+        size_t failures = tracker.count(ResultQuery().forSymbol(std::string(symbol)).failuresOnly().since(since));
+        if (failures == 0) continue;
+        size_t exhausted = tracker.count(ResultQuery().forSymbol(std::string(symbol))
+                                             .withStatus(TradeStatus::RETRY_EXHAUSTED).since(since));
+        logger.info("Failures for " + std::string(symbol) + " in the last 5 min: " +
+                    std::to_string(failures) + " (" + std::to_string(exhausted) + " retry-exhausted)");
+    }
+}
+
+/// Execution latency vs. the latency of delivering results, measured
+/// separately so a slow callback shows up as such.
+template <typename Processor>
+void logLatency(Logger& logger, const Processor& processor) {
+    logger.info("Latency execution: " + processor.executionLatency().summary());
+    logger.info("Latency callback wait: " + processor.callbackWait().summary());
+    logger.info("Latency callback run: " + processor.callbackRun().summary());
+}
+
 /// Normal simulation: multiple clients sending requests at normal pace
-void runNormalSimulation(Logger& logger, IMTBrokerAPI& api) {
+void runNormalSimulation(Logger& logger, IMTBrokerAPI& api, const ConfigFile& config, const RuleEngine& rules,
+                         const TradingCalendar& calendar, StatePersistence* state, ResultFeed* feed) {
     logger.info("=== NORMAL SIMULATION: 5 clients, 10 requests each ===");
 
     ProcessorConfig procConfig;
     procConfig.numWorkers  = 4;
     procConfig.maxRetries  = 3;
     procConfig.retryBaseMs = 100;
+    procConfig.validationBatchSize = static_cast<int>(config.getInt("processor.validation_batch", 1));
+    procConfig.resultBatchSize     = static_cast<int>(config.getInt("processor.result_batch", 1));
+    procConfig.resultFlushUs       = static_cast<int>(config.getInt("processor.result_flush_us", 500));
+    procConfig.perfCounters        = config.getBool("processor.perf_counters", false);
+    applyExecutionModel(procConfig, config);
 
     DealProcessor processor(api, logger, procConfig);
+    processor.setRules(&rules);
+    processor.setCalendar(&calendar);
+    if (state) attachState(processor, *state, config, logger);
+    if (feed) processor.getTracker().setFeed(feed);
     processor.start();
 
     // Create 5 client simulators
@@ -156,8 +449,13 @@ void runNormalSimulation(Logger& logger, IMTBrokerAPI& api) {
 
     auto endTime = std::chrono::steady_clock::now();
 
-    // Stop processor
+    // Stop processor; let the async log sinks catch up before printing directly
     processor.stop();
+    if (state) state->stop();
+    logSessions(logger, clients);
+    logRecentFailures(logger, processor.getTracker());
+    logLatency(logger, processor);
+    logger.flush();
 
     // Print results
     auto totalMs = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
@@ -173,18 +471,29 @@ void runNormalSimulation(Logger& logger, IMTBrokerAPI& api) {
               << " req/sec\n";
 
     processor.getTracker().printSummary();
+    if (procConfig.perfCounters) processor.stageCounters().print(std::cout);
 }
 
 /// Burst simulation: high-frequency burst to test stability (bonus feature)
-void runBurstSimulation(Logger& logger, IMTBrokerAPI& api) {
+void runBurstSimulation(Logger& logger, IMTBrokerAPI& api, const ConfigFile& config, const RuleEngine& rules,
+                        const TradingCalendar& calendar, StatePersistence* state, ResultFeed* feed) {
     logger.info("=== BURST SIMULATION: 10 clients, 20 requests each, minimal delay ===");
 
     ProcessorConfig procConfig;
     procConfig.numWorkers  = 8;  // More workers for burst
     procConfig.maxRetries  = 2;
     procConfig.retryBaseMs = 50;
+    procConfig.validationBatchSize = static_cast<int>(config.getInt("processor.validation_batch", 1));
+    procConfig.resultBatchSize     = static_cast<int>(config.getInt("processor.result_batch", 1));
+    procConfig.resultFlushUs       = static_cast<int>(config.getInt("processor.result_flush_us", 500));
+    procConfig.perfCounters        = config.getBool("processor.perf_counters", false);
+    applyExecutionModel(procConfig, config);
 
     DealProcessor processor(api, logger, procConfig);
+    processor.setRules(&rules);
+    processor.setCalendar(&calendar);
+    if (state) attachState(processor, *state, config, logger);
+    if (feed) processor.getTracker().setFeed(feed);
     processor.start();
 
     // 10 clients, 20 requests each, near-zero delay = 200 requests as fast as possible
@@ -228,6 +537,11 @@ void runBurstSimulation(Logger& logger, IMTBrokerAPI& api) {
     auto endTime = std::chrono::steady_clock::now();
 
     processor.stop();
+    if (state) state->stop();
+    logSessions(logger, clients);
+    logRecentFailures(logger, processor.getTracker());
+    logLatency(logger, processor);
+    logger.flush();
 
     auto totalMs = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
     int totalRequests = NUM_CLIENTS * REQUESTS_PER_CLIENT;
@@ -241,4 +555,47 @@ void runBurstSimulation(Logger& logger, IMTBrokerAPI& api) {
               << "    Lost requests:      0 (verified by tracker)\n";
 
     processor.getTracker().printSummary();
+    if (procConfig.perfCounters) processor.stageCounters().print(std::cout);
+}
+
+/// Downstream consumer: print the feed from the consumer's saved cursor (or
+/// --from), following new results until the feed is idle for
+/// feed.tail_idle_ms (0 = follow forever), then save the cursor.
+int runFeedTail(const ConfigFile& config, const std::string& consumer, uint64_t fromSequence) {
+    std::string feedDir = config.getString("feed.dir");
+    if (feedDir.empty()) {
+        std::cerr << "--tail-feed needs feed.dir in the configuration\n";
+        return 1;
+    }
+    auto idleLimit = std::chrono::milliseconds(config.getInt("feed.tail_idle_ms", 2000));
+
+    FeedReader reader(feedDir);
+    uint64_t start = fromSequence > 0 ? fromSequence : FeedReader::loadCursor(feedDir, consumer).value_or(1);
+    if (std::string error; !reader.seek(start, error)) {
+        std::cerr << "Cannot open result feed: " << error << "\n";
+        return 1;
+    }
+
+    uint64_t received = 0;
+    auto lastData = std::chrono::steady_clock::now();
+    for (;;) {
+        size_t n = reader.poll([&](uint64_t sequence, TradeResult&& result) {
+            std::cout << "#" << sequence << " " << result.clientId << " " << result.symbol << " "
+                      << result.toString() << "\n";
+        });
+        if (n > 0) {
+            received += n;
+            lastData = std::chrono::steady_clock::now();
+            FeedReader::saveCursor(feedDir, consumer, reader.cursor());
+            continue;
+        }
+        if (idleLimit.count() > 0 && std::chrono::steady_clock::now() - lastData >= idleLimit) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    FeedReader::saveCursor(feedDir, consumer, reader.cursor());
+    std::cout << "Consumer " << consumer << ": " << received << " results, next sequence "
+              << reader.cursor() << ", " << reader.skipped() << " skipped (retention or corruption), "
+              << reader.corrupt() << " corrupt records\n";
+    return 0;
 }
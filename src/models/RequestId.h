@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+/// Process-wide source of request sequence numbers.
+///
+/// Producers never touch this per request: they lease a contiguous block of
+/// sequence numbers and hand them out locally (see RequestIdSequence). The
+/// shared counter is therefore hit once per BLOCK_SIZE IDs instead of once
+/// per ID, which keeps client threads from bouncing the same cache line.
+class RequestIdAllocator {
+public:
+    static constexpr uint64_t BLOCK_SIZE = 4096;
+
+    /// Lease [first, first + count) from the global sequence space.
+    static uint64_t leaseBlock(uint64_t count = BLOCK_SIZE) {
+        return next_.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    /// Never hand out `seq` or anything below it again (warm restart: the
+    /// previous run's IDs are already in the dedup set).
+    static void reserveThrough(uint64_t seq) {
+        uint64_t current = next_.load(std::memory_order_relaxed);
+        while (current <= seq &&
+               !next_.compare_exchange_weak(current, seq + 1, std::memory_order_relaxed)) {
+        }
+    }
+
+private:
+    static inline std::atomic<uint64_t> next_{0};
+};
+
+/// Per-producer sequence generator backed by leased blocks.
+/// Not thread-safe by design: each client owns its own instance.
+class RequestIdSequence {
+public:
+    explicit RequestIdSequence(uint64_t blockSize = RequestIdAllocator::BLOCK_SIZE)
+        : blockSize_(blockSize) {}
+
+    /// Next compact 64-bit request ID (globally unique within the process).
+    uint64_t next() {
+        if (next_ == end_) {
+            next_ = RequestIdAllocator::leaseBlock(blockSize_);
+            end_  = next_ + blockSize_;
+        }
+        return next_++;
+    }
+
+private:
+    uint64_t blockSize_;
+    uint64_t next_ = 0;
+    uint64_t end_  = 0;
+};
+
+/// Renders the string form of a request ID: "<clientId>-<seq>", with the
+/// sequence zero-padded to at least MIN_DIGITS (same output as the former
+/// setfill('0') << setw(6) formatting).
+struct RequestIdFormat {
+    static constexpr int    MIN_DIGITS     = 6;
+    static constexpr size_t MAX_SEQ_DIGITS = 20;   // uint64_t max
+
+    /// Number of decimal digits in value (1 for zero).
+    static int decimalLength(uint64_t value) {
+        int n = 1;
+        while (value >= 10000) { value /= 10000; n += 4; }
+        return n + (value >= 10) + (value >= 100) + (value >= 1000);
+    }
+
+    /// Write exactly Width zero-padded digits, two at a time from a pair
+    /// table. The trip count is a compile-time constant, so the loop unrolls
+    /// into straight-line code with no per-digit branches.
+    template <int Width>
+    static void renderFixed(char* out, uint64_t value) {
+        static_assert(Width > 0 && Width <= static_cast<int>(MAX_SEQ_DIGITS), "bad width");
+        char* p = out + Width;
+        for (int i = 0; i < Width / 2; ++i) {
+            p -= 2;
+            std::memcpy(p, &digitPairs()[(value % 100) * 2], 2);
+            value /= 100;
+        }
+        if (Width & 1) {
+            *--p = static_cast<char>('0' + value % 10);
+        }
+    }
+
+    /// Runtime-width variant used for sequences past the fixed-width range.
+    static void renderWidth(char* out, uint64_t value, int width) {
+        char* p = out + width;
+        while (p - out >= 2) {
+            p -= 2;
+            std::memcpy(p, &digitPairs()[(value % 100) * 2], 2);
+            value /= 100;
+        }
+        if (p != out) *--p = static_cast<char>('0' + value % 10);
+    }
+
+    /// Render seq into out (at least MAX_SEQ_DIGITS bytes). Returns length.
+    static size_t renderSequence(char* out, uint64_t seq) {
+        if (seq < 1000000) {
+            renderFixed<MIN_DIGITS>(out, seq);
+            return MIN_DIGITS;
+        }
+        int width = decimalLength(seq);
+        renderWidth(out, seq, width);
+        return static_cast<size_t>(width);
+    }
+
+    static std::string format(const std::string& clientId, uint64_t seq) {
+        char digits[MAX_SEQ_DIGITS];
+        size_t n = renderSequence(digits, seq);
+
+        std::string id;
+        id.reserve(clientId.size() + 1 + n);
+        id.append(clientId);
+        id.push_back('-');
+        id.append(digits, n);
+        return id;
+    }
+
+    /// Sequence part of a formatted ID ("<clientId>-<seq>"); false if the
+    /// ID does not end in "-<digits>".
+    static bool parseSequence(const std::string& id, uint64_t& seq) {
+        size_t dash = id.rfind('-');
+        if (dash == std::string::npos || dash + 1 == id.size() ||
+            id.size() - dash - 1 > MAX_SEQ_DIGITS - 1) {
+            return false;
+        }
+        seq = 0;
+        for (size_t i = dash + 1; i < id.size(); ++i) {
+            if (id[i] < '0' || id[i] > '9') return false;
+            seq = seq * 10 + static_cast<uint64_t>(id[i] - '0');
+        }
+        return true;
+    }
+
+    static const char* digitPairs() {
+        static constexpr char pairs[201] =
+            "00010203040506070809"
+            "10111213141516171819"
+            "20212223242526272829"
+            "30313233343536373839"
+            "40414243444546474849"
+            "50515253545556575859"
+            "60616263646566676869"
+            "70717273747576777879"
+            "80818283848586878889"
+            "90919293949596979899";
+        return pairs;
+    }
+};
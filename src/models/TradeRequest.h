@@ -3,15 +3,15 @@
 #include <string>
 #include <chrono>
 #include <optional>
-#include <atomic>
-#include <sstream>
-#include <iomanip>
+#include "models/RequestId.h"
+#include "format/TextWriter.h"
 
 enum class TradeType { BUY, SELL };
 
 struct TradeRequest {
     std::string clientId;
     std::string requestId;
+    uint64_t    sequence = 0;   // Compact binary form of requestId (hot-path key)
     TradeType   tradeType;
     std::string symbol;
     double      volume;
@@ -20,26 +20,33 @@ struct TradeRequest {
     std::chrono::system_clock::time_point timestamp;
     bool isTestBadRequest = false;  // Flagged when intentionally invalid for error testing
 
-    // Generate unique request IDs
+    // Generate unique request IDs. Producers that create many requests should
+    // own a RequestIdSequence and call RequestIdFormat::format() directly;
+    // this helper keeps one leased sequence per calling thread.
     static std::string generateRequestId(const std::string& clientId) {
-        static std::atomic<uint64_t> counter{0};
-        std::ostringstream oss;
-        oss << clientId << "-" << std::setfill('0') << std::setw(6) << counter.fetch_add(1);
-        return oss.str();
+        thread_local RequestIdSequence sequence;
+        return RequestIdFormat::format(clientId, sequence.next());
     }
 
     std::string tradeTypeStr() const {
+        return std::string(tradeTypeName());
+    }
+
+    const char* tradeTypeName() const {
         return tradeType == TradeType::BUY ? "BUY" : "SELL";
     }
 
+    /// Write the log form of the request into `out` (never allocates).
+    void formatTo(TextWriter& out) const {
+        if (isTestBadRequest) out.append("[INTENTIONAL-BAD-REQUEST] ");
+        out.append('[').append(requestId).append("] ")
+           .append(clientId).append(' ').append(tradeTypeName()).append(' ')
+           .append(symbol).append(' ').appendGeneral(volume).append(" lots");
+        if (stopLoss)   out.append(" SL=").appendGeneral(*stopLoss);
+        if (takeProfit) out.append(" TP=").appendGeneral(*takeProfit);
+    }
+
     std::string toString() const {
-        std::ostringstream oss;
-        if (isTestBadRequest) oss << "[INTENTIONAL-BAD-REQUEST] ";
-        oss << "[" << requestId << "] "
-            << clientId << " " << tradeTypeStr() << " "
-            << symbol << " " << volume << " lots";
-        if (stopLoss)   oss << " SL=" << *stopLoss;
-        if (takeProfit) oss << " TP=" << *takeProfit;
-        return oss.str();
+        return TextWriter::render([this](TextWriter& out) { formatTo(out); });
     }
 };
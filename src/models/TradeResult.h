@@ -2,8 +2,7 @@
 
 #include <string>
 #include <chrono>
-#include <sstream>
-#include <iomanip>
+#include "format/TextWriter.h"
 
 enum class TradeStatus {
     SUCCESS,
@@ -18,6 +17,7 @@ enum class TradeStatus {
 struct TradeResult {
     std::string requestId;
     std::string clientId;
+    std::string symbol;           // Instrument of the request (set by the processor)
     TradeStatus status;
     std::string mtTicketId;      // MT5 deal ticket (empty on failure)
     double      executionPrice;   // Fill price (0.0 on failure)
@@ -26,6 +26,10 @@ struct TradeResult {
     std::chrono::system_clock::time_point timestamp;
 
     std::string statusStr() const {
+        return std::string(statusName());
+    }
+
+    const char* statusName() const {
         switch (status) {
             case TradeStatus::SUCCESS:          return "SUCCESS";
             case TradeStatus::REJECTED:         return "REJECTED";
@@ -45,18 +49,22 @@ struct TradeResult {
                status == TradeStatus::REJECTED;
     }
 
-    std::string toString() const {
-        std::ostringstream oss;
-        oss << "[" << requestId << "] " << statusStr();
+    /// Write the log form of the result into `out` (never allocates).
+    /// priceDigits lets callers that know the symbol use its SymbolInfo::digits.
+    void formatTo(TextWriter& out, int priceDigits = 5) const {
+        out.append('[').append(requestId).append("] ").append(statusName());
         if (isSuccess()) {
-            oss << " Ticket=#" << mtTicketId
-                << " Price=" << std::fixed << std::setprecision(5) << executionPrice;
+            out.append(" Ticket=#").append(mtTicketId)
+               .append(" Price=").appendFixed(executionPrice, priceDigits);
         } else {
-            oss << " Error: " << errorMessage;
+            out.append(" Error: ").append(errorMessage);
         }
         if (retryCount > 0) {
-            oss << " (retries=" << retryCount << ")";
+            out.append(" (retries=").appendInt(retryCount).append(')');
         }
-        return oss.str();
+    }
+
+    std::string toString() const {
+        return TextWriter::render([this](TextWriter& out) { formatTo(out); });
     }
 };
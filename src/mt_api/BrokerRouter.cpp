@@ -0,0 +1,380 @@
+#include "mt_api/BrokerRouter.h"
+
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <unordered_set>
+
+/// Weight of the newest sample in a backend's smoothed latency.
+static constexpr double LATENCY_EWMA_ALPHA = 0.2;
+
+/// Split a backend list: "ldn, ny" or "ldn ny".
+static std::vector<std::string> splitNames(const std::string& text) {
+    std::vector<std::string> names;
+    std::string current;
+    for (char c : text) {
+        if (c == ',' || c == ' ' || c == '\t') {
+            if (!current.empty()) names.push_back(std::move(current));
+            current.clear();
+        } else {
+            current += c;
+        }
+    }
+    if (!current.empty()) names.push_back(std::move(current));
+    return names;
+}
+
+BrokerRouter::BrokerRouter(Logger& logger, Options options)
+    : logger_(logger)
+    , options_(options)
+{
+}
+
+BrokerRouter::~BrokerRouter() {
+    for (auto& backend : backends_) backend->queue.shutdown();
+    for (auto& backend : backends_) {
+        for (auto& t : backend->threads) {
+            if (t.joinable()) t.join();
+        }
+    }
+}
+
+BrokerRouter::Options BrokerRouter::optionsFrom(const ConfigFile& config) {
+    Options options;
+    options.policy = config.getString("router.policy", "latency") == "first"
+                   ? RoutingPolicy::FIRST : RoutingPolicy::LATENCY;
+    options.failureThreshold = static_cast<int>(std::max(1LL, config.getInt("router.failure_threshold", 3)));
+    options.cooldown     = std::chrono::milliseconds(config.getInt("router.cooldown_ms", 2000));
+    options.queueTimeout = std::chrono::milliseconds(config.getInt("router.queue_timeout_ms", 500));
+    return options;
+}
+
+void BrokerRouter::addBackend(const std::string& name, IMTBrokerAPI& api, const BackendConfig& config) {
+    auto backend = std::make_unique<Backend>();
+    backend->name   = name;
+    backend->api    = &api;
+    backend->config = config;
+    backend->config.threads    = std::max(1, config.threads);
+    backend->config.queueLimit = std::max(0, config.queueLimit);
+
+    Backend& ref = *backend;
+    backends_.push_back(std::move(backend));
+    for (int i = 0; i < ref.config.threads; ++i) {
+        ref.threads.emplace_back(&BrokerRouter::executorLoop, this, std::ref(ref));
+    }
+}
+
+BrokerRouter::Backend* BrokerRouter::findBackend(const std::string& name) const {
+    for (const auto& backend : backends_) {
+        if (backend->name == name) return backend.get();
+    }
+    return nullptr;
+}
+
+void BrokerRouter::routeSymbol(const std::string& symbol, std::vector<std::string> backends) {
+    std::vector<Backend*> route;
+    for (const auto& name : backends) {
+        if (Backend* b = findBackend(name)) route.push_back(b);
+    }
+    symbolRoutes_[symbol] = std::move(route);
+}
+
+void BrokerRouter::routeClientGroup(const std::string& clientPrefix, std::vector<std::string> backends) {
+    std::vector<Backend*> route;
+    for (const auto& name : backends) {
+        if (Backend* b = findBackend(name)) route.push_back(b);
+    }
+    clientRoutes_.emplace_back(clientPrefix, std::move(route));
+    // Longest prefix wins: keep the most specific groups first
+    std::stable_sort(clientRoutes_.begin(), clientRoutes_.end(),
+                     [](const auto& a, const auto& b) { return a.first.size() > b.first.size(); });
+}
+
+bool BrokerRouter::configure(const ConfigFile& config) {
+    struct Route { bool client; std::string key; std::string names; };
+    std::vector<Route> routes;
+    for (const auto& key : config.keysWithPrefix("router.symbol.")) {
+        routes.push_back({false, key.substr(14), config.getString(key)});
+    }
+    for (const auto& key : config.keysWithPrefix("router.client.")) {
+        routes.push_back({true, key.substr(14), config.getString(key)});
+    }
+
+    for (const auto& route : routes) {
+        auto names = splitNames(route.names);
+        for (const auto& name : names) {
+            if (!findBackend(name)) {
+                logger_.error("Router: route for " + std::string(route.client ? "client group " : "symbol ") +
+                              route.key + " names unknown backend '" + name + "'");
+                return false;
+            }
+        }
+        if (route.client) {
+            routeClientGroup(route.key, std::move(names));
+        } else {
+            routeSymbol(route.key, std::move(names));
+        }
+    }
+    return true;
+}
+
+bool BrokerRouter::connect(const std::string& server, int login, const std::string& password) {
+    bool any = false;
+    for (auto& backend : backends_) {
+        if (backend->api->connect(server, login, password)) {
+            any = true;
+        } else {
+            logger_.warn("Router: backend " + backend->name + " failed to connect");
+            std::lock_guard<std::mutex> lock(backend->stateMutex);
+            backend->consecutiveFailures = options_.failureThreshold;
+            backend->unhealthyUntil = std::chrono::steady_clock::now() + options_.cooldown;
+        }
+    }
+    connected_ = any;
+    return any;
+}
+
+void BrokerRouter::disconnect() {
+    for (auto& backend : backends_) backend->api->disconnect();
+    connected_ = false;
+}
+
+bool BrokerRouter::isConnected() const {
+    return connected_;
+}
+
+bool BrokerRouter::isHealthy(const Backend& backend, std::chrono::steady_clock::time_point now) const {
+    std::lock_guard<std::mutex> lock(backend.stateMutex);
+    return backend.unhealthyUntil <= now;
+}
+
+double BrokerRouter::score(const Backend& backend) const {
+    double latency;
+    {
+        std::lock_guard<std::mutex> lock(backend.stateMutex);
+        latency = backend.ewmaLatencyMs;
+    }
+    // Expected wait: smoothed service time, scaled by how many requests are
+    // already ahead per executor thread. Unmeasured backends score 0 and so
+    // get tried first.
+    double ahead = static_cast<double>(backend.queued.load(std::memory_order_relaxed)) /
+                   backend.config.threads;
+    return latency * (1.0 + ahead);
+}
+
+std::vector<BrokerRouter::Backend*> BrokerRouter::candidatesForSymbol(const std::string& symbol) {
+    std::vector<Backend*> order;
+    auto it = symbolRoutes_.find(symbol);
+    if (it != symbolRoutes_.end()) {
+        order = it->second;
+    } else {
+        for (auto& backend : backends_) order.push_back(backend.get());
+    }
+    return order;
+}
+
+std::vector<BrokerRouter::Backend*> BrokerRouter::candidates(const TradeRequest& request) {
+    std::vector<Backend*> order;
+    bool grouped = false;
+    for (const auto& [prefix, route] : clientRoutes_) {
+        if (request.clientId.compare(0, prefix.size(), prefix) == 0) {
+            order = route;
+            grouped = true;
+            break;
+        }
+    }
+    if (!grouped) order = candidatesForSymbol(request.symbol);
+
+    if (options_.policy == RoutingPolicy::LATENCY && order.size() > 1) {
+        std::vector<std::pair<double, Backend*>> scored;
+        scored.reserve(order.size());
+        for (Backend* b : order) scored.emplace_back(score(*b), b);
+        std::stable_sort(scored.begin(), scored.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+        for (size_t i = 0; i < scored.size(); ++i) order[i] = scored[i].second;
+    }
+
+    // Healthy backends first; unhealthy ones stay on the list as a last
+    // resort rather than failing the trade outright.
+    auto now = std::chrono::steady_clock::now();
+    std::stable_partition(order.begin(), order.end(),
+                          [&](const Backend* b) { return isHealthy(*b, now); });
+    return order;
+}
+
+void BrokerRouter::recordOutcome(Backend& backend, const TradeResult& result, double latencyMs) {
+    bool markedDown = false;
+    bool recovered  = false;
+    {
+        std::lock_guard<std::mutex> lock(backend.stateMutex);
+        ++backend.routed;
+        backend.ewmaLatencyMs = backend.routed == 1
+            ? latencyMs
+            : LATENCY_EWMA_ALPHA * latencyMs + (1.0 - LATENCY_EWMA_ALPHA) * backend.ewmaLatencyMs;
+
+        auto now = std::chrono::steady_clock::now();
+        if (result.status == TradeStatus::CONNECTION_ERROR) {
+            ++backend.failures;
+            if (++backend.consecutiveFailures >= options_.failureThreshold &&
+                backend.unhealthyUntil <= now) {
+                backend.unhealthyUntil = now + options_.cooldown;
+                markedDown = true;
+            }
+        } else {
+            recovered = backend.consecutiveFailures >= options_.failureThreshold;
+            backend.consecutiveFailures = 0;
+            backend.unhealthyUntil = {};
+        }
+    }
+    if (markedDown) {
+        logger_.warn("Router: backend " + backend.name + " marked unhealthy for " +
+                     std::to_string(options_.cooldown.count()) + "ms");
+    } else if (recovered) {
+        logger_.info("Router: backend " + backend.name + " recovered");
+    }
+}
+
+void BrokerRouter::recordOverflow(Backend& backend) {
+    std::lock_guard<std::mutex> lock(backend.stateMutex);
+    ++backend.overflows;
+}
+
+void BrokerRouter::recordTimeout(Backend& backend) {
+    std::lock_guard<std::mutex> lock(backend.stateMutex);
+    ++backend.timeouts;
+}
+
+void BrokerRouter::executorLoop(Backend& backend) {
+    while (auto job = backend.queue.pop()) {
+        int expected = Job::QUEUED;
+        if (!(*job)->state.compare_exchange_strong(expected, Job::RUNNING)) {
+            // The caller gave up waiting and failed over; never execute it.
+            backend.queued.fetch_sub(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        TradeResult result = backend.api->executeTrade((*job)->request);
+        double latencyMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+
+        recordOutcome(backend, result, latencyMs);
+        backend.queued.fetch_sub(1, std::memory_order_relaxed);
+        (*job)->promise.set_value(std::move(result));
+    }
+}
+
+TradeResult BrokerRouter::executeTrade(const TradeRequest& request) {
+    TradeResult lastError;
+    lastError.requestId      = request.requestId;
+    lastError.clientId       = request.clientId;
+    lastError.status         = TradeStatus::CONNECTION_ERROR;
+    lastError.executionPrice = 0.0;
+    lastError.retryCount     = 0;
+    lastError.timestamp      = std::chrono::system_clock::now();
+    lastError.errorMessage   = "No broker backend available";
+
+    for (Backend* backend : candidates(request)) {
+        int capacity = backend->config.threads + backend->config.queueLimit;
+        if (backend->queued.load(std::memory_order_relaxed) >= capacity) {
+            recordOverflow(*backend);
+            lastError.errorMessage = "Broker backend " + backend->name + " busy";
+            continue;
+        }
+
+        auto job = std::make_shared<Job>();
+        job->request = request;
+        auto future = job->promise.get_future();
+        backend->queued.fetch_add(1, std::memory_order_relaxed);
+        backend->queue.push(job);
+
+        if (future.wait_for(options_.queueTimeout) == std::future_status::timeout) {
+            int expected = Job::QUEUED;
+            if (job->state.compare_exchange_strong(expected, Job::CANCELLED)) {
+                // Still waiting behind a slow server: withdraw it and fail over.
+                recordTimeout(*backend);
+                lastError.errorMessage = "Broker backend " + backend->name + " queue timeout";
+                continue;
+            }
+            // Already executing: the fill may happen, so wait for its answer.
+        }
+
+        TradeResult result = future.get();
+        if (result.status == TradeStatus::CONNECTION_ERROR) {
+            lastError = std::move(result);
+            continue;
+        }
+        if (result.isSuccess()) {
+            result.mtTicketId.insert(0, backend->name + ":");
+        }
+        return result;
+    }
+    return lastError;
+}
+
+std::optional<TradeResult> BrokerRouter::getTicketInfo(const std::string& ticketId) {
+    size_t colon = ticketId.find(':');
+    if (colon == std::string::npos) return std::nullopt;
+    Backend* backend = findBackend(ticketId.substr(0, colon));
+    if (!backend) return std::nullopt;
+
+    auto info = backend->api->getTicketInfo(ticketId.substr(colon + 1));
+    if (info && !info->mtTicketId.empty()) {
+        info->mtTicketId.insert(0, backend->name + ":");
+    }
+    return info;
+}
+
+std::optional<SymbolInfo> BrokerRouter::getSymbolInfo(const std::string& symbol) {
+    auto order = candidatesForSymbol(symbol);
+    auto now = std::chrono::steady_clock::now();
+    std::stable_partition(order.begin(), order.end(),
+                          [&](const Backend* b) { return isHealthy(*b, now); });
+    for (Backend* backend : order) {
+        if (auto info = backend->api->getSymbolInfo(symbol)) return info;
+    }
+    return std::nullopt;
+}
+
+std::optional<AccountInfo> BrokerRouter::getAccountInfo(int login) {
+    auto now = std::chrono::steady_clock::now();
+    std::optional<AccountInfo> fallback;
+    for (auto& backend : backends_) {
+        if (isHealthy(*backend, now)) {
+            if (auto info = backend->api->getAccountInfo(login)) return info;
+        } else if (!fallback) {
+            fallback = backend->api->getAccountInfo(login);
+        }
+    }
+    return fallback;
+}
+
+std::vector<std::string> BrokerRouter::getSymbols() {
+    std::vector<std::string> symbols;
+    std::unordered_set<std::string> seen;
+    for (auto& backend : backends_) {
+        for (auto& symbol : backend->api->getSymbols()) {
+            if (seen.insert(symbol).second) symbols.push_back(std::move(symbol));
+        }
+    }
+    return symbols;
+}
+
+std::vector<std::string> BrokerRouter::backendSummary() const {
+    std::vector<std::string> lines;
+    auto now = std::chrono::steady_clock::now();
+    for (const auto& backend : backends_) {
+        std::lock_guard<std::mutex> lock(backend->stateMutex);
+        std::ostringstream oss;
+        oss << "Backend " << backend->name
+            << (backend->unhealthyUntil > now ? " [UNHEALTHY]" : " [healthy]")
+            << " routed=" << backend->routed
+            << " conn_errors=" << backend->failures
+            << " overflows=" << backend->overflows
+            << " timeouts=" << backend->timeouts
+            << " queued=" << backend->queued.load(std::memory_order_relaxed)
+            << " latency~" << std::fixed << std::setprecision(1) << backend->ewmaLatencyMs << "ms";
+        lines.push_back(oss.str());
+    }
+    return lines;
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "mt_api/IMTBrokerAPI.h"
+#include "queue/ThreadSafeQueue.h"
+#include "config/ConfigFile.h"
+#include "logger/Logger.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <chrono>
+#include <unordered_map>
+
+/// Per-backend settings.
+struct BackendConfig {
+    int threads    = 4;     // Executor threads (= concurrent DealerSend calls)
+    int queueLimit = 64;    // Requests waiting for this backend before it counts as full
+};
+
+/// How to pick among healthy candidate backends.
+enum class RoutingPolicy {
+    FIRST,      // First healthy backend in the route's order
+    LATENCY     // Lowest smoothed latency x (1 + queued requests)
+};
+
+/// IMTBrokerAPI that spreads trades over several broker backends.
+///
+/// Routing: a request's candidates come from (in order of precedence) a
+/// client-group route (client ID prefix), a symbol route, or all backends;
+/// the policy then orders the healthy ones. Unhealthy backends are skipped.
+///
+/// Isolation: every backend has its own bounded queue and executor threads.
+/// A processor worker hands its trade to the chosen backend and waits; if the
+/// backend is full, or the trade is still queued after queueTimeout, the
+/// worker moves on to the next candidate. A slow or stuck server therefore
+/// ties up only its own threads, never the workers serving the others. A
+/// trade that has started executing is always waited for, so failover can
+/// never produce a second fill.
+///
+/// Failover: a CONNECTION_ERROR (or full/timed-out queue) tries the next
+/// candidate. failureThreshold consecutive connection errors mark a backend
+/// unhealthy for `cooldown`; after that it gets traffic again and one
+/// success clears it. Full and timed-out queues are only counted: the trade
+/// never reached the server, so they change neither its health nor its
+/// smoothed latency (the queue depth already weighs in the LATENCY score).
+///
+/// Ticket IDs are namespaced as "<backend>:<ticket>" so getTicketInfo can
+/// find the right server.
+class BrokerRouter final : public IMTBrokerAPI {
+public:
+    struct Options {
+        RoutingPolicy             policy           = RoutingPolicy::LATENCY;
+        int                       failureThreshold = 3;
+        std::chrono::milliseconds cooldown{2000};
+        std::chrono::milliseconds queueTimeout{500};
+    };
+
+    BrokerRouter(Logger& logger, Options options);
+    ~BrokerRouter() override;
+
+    BrokerRouter(const BrokerRouter&) = delete;
+    BrokerRouter& operator=(const BrokerRouter&) = delete;
+
+    /// Register a backend (before connect()). The router does not own `api`.
+    void addBackend(const std::string& name, IMTBrokerAPI& api, const BackendConfig& config = {});
+
+    /// Route `symbol` to these backends, in preference order.
+    void routeSymbol(const std::string& symbol, std::vector<std::string> backends);
+
+    /// Route clients whose ID starts with `clientPrefix` to these backends.
+    void routeClientGroup(const std::string& clientPrefix, std::vector<std::string> backends);
+
+    /// Read "router.*" routes and options. Backends must already be added.
+    /// Returns false (and logs) on a route naming an unknown backend.
+    bool configure(const ConfigFile& config);
+
+    /// Parse "router.policy", "router.failure_threshold", ... into Options.
+    static Options optionsFrom(const ConfigFile& config);
+
+    bool connect(const std::string& server, int login, const std::string& password) override;
+    void disconnect() override;
+    bool isConnected() const override;
+
+    std::optional<SymbolInfo>  getSymbolInfo(const std::string& symbol) override;
+    std::optional<AccountInfo> getAccountInfo(int login) override;
+    TradeResult                executeTrade(const TradeRequest& request) override;
+    std::optional<TradeResult> getTicketInfo(const std::string& ticketId) override;
+    std::vector<std::string>   getSymbols() override;
+
+    /// One line per backend: health, smoothed latency, queue depth, counts.
+    std::vector<std::string> backendSummary() const;
+
+private:
+    struct Job {
+        enum State : int { QUEUED, RUNNING, CANCELLED };
+
+        TradeRequest             request;
+        std::promise<TradeResult> promise;
+        std::atomic<int>         state{QUEUED};
+    };
+
+    struct Backend {
+        std::string                          name;
+        IMTBrokerAPI*                        api = nullptr;
+        BackendConfig                        config;
+        ThreadSafeQueue<std::shared_ptr<Job>> queue;
+        std::vector<std::thread>             threads;
+        std::atomic<int>                     queued{0};
+
+        // Health and latency, updated after every trade
+        mutable std::mutex                    stateMutex;
+        int                                   consecutiveFailures = 0;
+        std::chrono::steady_clock::time_point unhealthyUntil{};
+        double                                ewmaLatencyMs = 0.0;
+        uint64_t                              routed   = 0;
+        uint64_t                              failures = 0;
+        uint64_t                              overflows = 0;   // Queue full on arrival
+        uint64_t                              timeouts  = 0;   // Withdrawn after queueTimeout
+    };
+
+    std::vector<Backend*> candidates(const TradeRequest& request);
+    std::vector<Backend*> candidatesForSymbol(const std::string& symbol);
+    bool   isHealthy(const Backend& backend, std::chrono::steady_clock::time_point now) const;
+    double score(const Backend& backend) const;
+    void   recordOutcome(Backend& backend, const TradeResult& result, double latencyMs);
+    void   recordOverflow(Backend& backend);
+    void   recordTimeout(Backend& backend);
+    Backend* findBackend(const std::string& name) const;
+
+    void executorLoop(Backend& backend);
+
+    Logger&                                               logger_;
+    Options                                               options_;
+    std::vector<std::unique_ptr<Backend>>                 backends_;
+    std::unordered_map<std::string, std::vector<Backend*>> symbolRoutes_;
+    std::vector<std::pair<std::string, std::vector<Backend*>>> clientRoutes_;
+    std::atomic<bool>                                     connected_{false};
+};
@@ -0,0 +1,239 @@
+#include "mt_api/BrokerScenario.h"
+
+#include <sstream>
+#include <cmath>
+#include <cstdlib>
+
+static bool parseNumber(const std::string& text, double& value) {
+    char* end = nullptr;
+    value = std::strtod(text.c_str(), &end);
+    return end != text.c_str() && *end == '\0' && std::isfinite(value);
+}
+
+static std::vector<std::string> splitWords(const std::string& text) {
+    std::istringstream in(text);
+    std::vector<std::string> words;
+    for (std::string word; in >> word; ) words.push_back(word);
+    return words;
+}
+
+std::optional<LatencyModel> LatencyModel::parse(const std::string& spec, std::string& error) {
+    std::vector<std::string> words = splitWords(spec);
+    if (words.empty()) {
+        error = "empty latency spec";
+        return std::nullopt;
+    }
+
+    std::vector<double> args;
+    for (size_t i = 1; i < words.size(); ++i) {
+        double value;
+        if (!parseNumber(words[i], value) || value < 0.0) {
+            error = "invalid number '" + words[i] + "' in latency spec";
+            return std::nullopt;
+        }
+        args.push_back(value);
+    }
+
+    LatencyModel model;
+    const std::string& kind = words[0];
+    if (kind == "none" && args.empty()) {
+        model.kind = Kind::NONE;
+    } else if (kind == "fixed" && args.size() == 1) {
+        model = {Kind::FIXED, args[0], 0.0, 0.0};
+    } else if (kind == "uniform" && args.size() == 2 && args[0] <= args[1]) {
+        model = {Kind::UNIFORM, args[0], args[1], 0.0};
+    } else if (kind == "lognormal" && args.size() == 2 && args[0] > 0.0) {
+        model = {Kind::LOGNORMAL, args[0], args[1], 0.0};
+    } else if (kind == "pareto" && (args.size() == 2 || args.size() == 3) && args[0] > 0.0 && args[1] > 0.0) {
+        model = {Kind::PARETO, args[0], args[1], args.size() == 3 ? args[2] : 0.0};
+    } else {
+        error = "bad latency spec '" + spec + "'";
+        return std::nullopt;
+    }
+    return model;
+}
+
+double LatencyModel::sampleMs(std::mt19937& rng) const {
+    switch (kind) {
+        case Kind::NONE:
+            return 0.0;
+        case Kind::FIXED:
+            return a;
+        case Kind::UNIFORM:
+            return std::uniform_real_distribution<double>(a, b)(rng);
+        case Kind::LOGNORMAL:
+            return std::lognormal_distribution<double>(std::log(a), b)(rng);
+        case Kind::PARETO: {
+            // Inverse CDF: scale / U^(1/alpha), U in (0, 1]
+            double u = 1.0 - std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+            double ms = a / std::pow(u, 1.0 / b);
+            return cap > 0.0 && ms > cap ? cap : ms;
+        }
+    }
+    return 0.0;
+}
+
+std::string LatencyModel::describe() const {
+    std::ostringstream oss;
+    switch (kind) {
+        case Kind::NONE:      oss << "none"; break;
+        case Kind::FIXED:     oss << "fixed " << a << "ms"; break;
+        case Kind::UNIFORM:   oss << "uniform " << a << "-" << b << "ms"; break;
+        case Kind::LOGNORMAL: oss << "lognormal median=" << a << "ms sigma=" << b; break;
+        case Kind::PARETO:
+            oss << "pareto scale=" << a << "ms alpha=" << b;
+            if (cap > 0.0) oss << " cap=" << cap << "ms";
+            break;
+    }
+    return oss.str();
+}
+
+bool OutageWindow::contains(std::chrono::milliseconds elapsed) const {
+    if (elapsed < start) return false;
+    auto offset = elapsed - start;
+    if (period.count() > 0) offset %= period;
+    return offset < duration;
+}
+
+BrokerScenario BrokerScenario::uniform(double minMs, double maxMs, double timeoutRate) {
+    BrokerScenario scenario;
+    scenario.latency_ = maxMs > 0.0 ? LatencyModel::uniform(minMs, maxMs) : LatencyModel{};
+    scenario.normal_.timeout = timeoutRate;
+    return scenario;
+}
+
+static bool readRate(const ConfigFile& config, const std::string& key, double& rate, std::string& error) {
+    if (!config.has(key)) return true;
+    if (!parseNumber(config.getString(key), rate) || rate < 0.0 || rate > 1.0) {
+        error = key + ": expected a probability in [0, 1]";
+        return false;
+    }
+    return true;
+}
+
+std::optional<BrokerScenario> BrokerScenario::fromConfig(const ConfigFile& config, std::string& error) {
+    BrokerScenario scenario;
+    scenario.name_ = config.getString("scenario.name", config.path().empty() ? "custom" : config.path());
+
+    if (config.has("latency")) {
+        auto model = LatencyModel::parse(config.getString("latency"), error);
+        if (!model) { error = "latency: " + error; return std::nullopt; }
+        scenario.latency_ = *model;
+    }
+    const std::string symbolPrefix = "latency.symbol.";
+    for (const auto& key : config.keysWithPrefix(symbolPrefix)) {
+        auto model = LatencyModel::parse(config.getString(key), error);
+        if (!model) { error = key + ": " + error; return std::nullopt; }
+        scenario.symbolLatency_[key.substr(symbolPrefix.size())] = *model;
+    }
+    if (!readRate(config, "latency.stall_probability", scenario.stallProbability_, error)) return std::nullopt;
+    scenario.stallMs_ = config.getDouble("latency.stall_ms", 0.0);
+
+    bool ok = readRate(config, "failure.timeout",       scenario.normal_.timeout, error)
+           && readRate(config, "failure.margin",        scenario.normal_.margin,  error)
+           && readRate(config, "failure.reject",        scenario.normal_.reject,  error)
+           && readRate(config, "failure.burst.enter",   scenario.burstEnter_,     error)
+           && readRate(config, "failure.burst.exit",    scenario.burstExit_,      error);
+    if (!ok) return std::nullopt;
+
+    // Burst rates default to the normal ones, so a file can override only some
+    scenario.burst_ = scenario.normal_;
+    ok = readRate(config, "failure.burst.timeout", scenario.burst_.timeout, error)
+      && readRate(config, "failure.burst.margin",  scenario.burst_.margin,  error)
+      && readRate(config, "failure.burst.reject",  scenario.burst_.reject,  error);
+    if (!ok) return std::nullopt;
+    scenario.timeoutMs_ = config.getDouble("failure.timeout_ms", 0.0);
+
+    for (const auto& key : config.keysWithPrefix("outage.")) {
+        std::vector<std::string> words = splitWords(config.getString(key));
+        double start, duration, period = 0.0;
+        bool valid = (words.size() == 2 || (words.size() == 4 && words[2] == "every"))
+                  && parseNumber(words[0], start) && parseNumber(words[1], duration)
+                  && (words.size() == 2 || parseNumber(words[3], period));
+        if (!valid || start < 0.0 || duration <= 0.0 || period < 0.0) {
+            error = key + ": expected '<start_ms> <duration_ms> [every <period_ms>]'";
+            return std::nullopt;
+        }
+        OutageWindow window;
+        window.start    = std::chrono::milliseconds(static_cast<long long>(start));
+        window.duration = std::chrono::milliseconds(static_cast<long long>(duration));
+        window.period   = std::chrono::milliseconds(static_cast<long long>(period));
+        scenario.outages_.push_back(window);
+    }
+
+    return scenario;
+}
+
+double BrokerScenario::sampleLatencyMs(const std::string& symbol, std::mt19937& rng) const {
+    const LatencyModel* model = &latency_;
+    if (!symbolLatency_.empty() && !symbol.empty()) {
+        auto it = symbolLatency_.find(symbol);
+        if (it != symbolLatency_.end()) model = &it->second;
+    }
+
+    double ms = model->sampleMs(rng);
+    if (stallProbability_ > 0.0 &&
+        std::uniform_real_distribution<double>(0.0, 1.0)(rng) < stallProbability_) {
+        ms += stallMs_;
+    }
+    return ms;
+}
+
+std::optional<TradeStatus> BrokerScenario::drawFailure(std::mt19937& rng) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    // Step the normal/burst chain first, then draw from the current state
+    if (inBurst_) {
+        if (burstExit_ > 0.0 && unit(rng) < burstExit_) inBurst_ = false;
+    } else if (burstEnter_ > 0.0 && unit(rng) < burstEnter_) {
+        inBurst_ = true;
+    }
+
+    const FailureRates& rates = inBurst_ ? burst_ : normal_;
+    double total = rates.timeout + rates.margin + rates.reject;
+    if (total <= 0.0) return std::nullopt;
+
+    double draw = unit(rng);
+    if (draw < rates.timeout)                               return TradeStatus::CONNECTION_ERROR;
+    if (draw < rates.timeout + rates.margin)                return TradeStatus::MARGIN_ERROR;
+    if (draw < total)                                       return TradeStatus::REJECTED;
+    return std::nullopt;
+}
+
+bool BrokerScenario::inOutage(std::chrono::steady_clock::time_point now) const {
+    if (outages_.empty()) return false;
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - start_);
+    for (const auto& window : outages_) {
+        if (window.contains(elapsed)) return true;
+    }
+    return false;
+}
+
+bool BrokerScenario::hasLatency() const {
+    if (latency_.kind != LatencyModel::Kind::NONE || stallProbability_ > 0.0 || timeoutMs_ > 0.0) return true;
+    for (const auto& [symbol, model] : symbolLatency_) {
+        if (model.kind != LatencyModel::Kind::NONE) return true;
+    }
+    return false;
+}
+
+bool BrokerScenario::hasFailures() const {
+    auto any = [](const FailureRates& r) { return r.timeout > 0.0 || r.margin > 0.0 || r.reject > 0.0; };
+    return any(normal_) || (burstEnter_ > 0.0 && any(burst_));
+}
+
+std::string BrokerScenario::describe() const {
+    std::ostringstream oss;
+    oss << "Broker scenario '" << name_ << "': latency " << latency_.describe();
+    if (!symbolLatency_.empty()) oss << " (+" << symbolLatency_.size() << " per-symbol)";
+    if (stallProbability_ > 0.0) oss << ", stalls " << stallProbability_ << " x " << stallMs_ << "ms";
+    oss << ", failures timeout=" << normal_.timeout << " margin=" << normal_.margin
+        << " reject=" << normal_.reject;
+    if (burstEnter_ > 0.0) {
+        oss << ", bursts enter=" << burstEnter_ << " exit=" << burstExit_
+            << " (timeout=" << burst_.timeout << " margin=" << burst_.margin
+            << " reject=" << burst_.reject << ")";
+    }
+    if (!outages_.empty()) oss << ", " << outages_.size() << " outage window(s)";
+    return oss.str();
+}
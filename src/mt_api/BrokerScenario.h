@@ -0,0 +1,121 @@
+#pragma once
+
+#include "models/TradeResult.h"
+#include "config/ConfigFile.h"
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <unordered_map>
+#include <random>
+#include <chrono>
+
+/// Distribution of simulated broker round-trip times.
+///
+/// Spec syntax (scenario files):
+///   none                          respond instantly
+///   fixed <ms>
+///   uniform <min_ms> <max_ms>
+///   lognormal <median_ms> <sigma>  heavy right tail, most calls near the median
+///   pareto <scale_ms> <alpha> [cap_ms]  power-law tail (alpha <= 2: very heavy)
+struct LatencyModel {
+    enum class Kind { NONE, FIXED, UNIFORM, LOGNORMAL, PARETO };
+
+    Kind   kind = Kind::NONE;
+    double a    = 0.0;      // fixed/min/median/scale (ms)
+    double b    = 0.0;      // max/sigma/alpha
+    double cap  = 0.0;      // Pareto upper bound (ms, 0 = none)
+
+    static std::optional<LatencyModel> parse(const std::string& spec, std::string& error);
+
+    static LatencyModel uniform(double minMs, double maxMs) { return {Kind::UNIFORM, minMs, maxMs, 0.0}; }
+
+    double sampleMs(std::mt19937& rng) const;
+    std::string describe() const;
+};
+
+/// Per-call probabilities of each injected failure.
+struct FailureRates {
+    double timeout = 0.0;   // CONNECTION_ERROR (retryable)
+    double margin  = 0.0;   // MARGIN_ERROR
+    double reject  = 0.0;   // REJECTED (dealer requote/reject)
+};
+
+/// A window during which the broker refuses every call.
+struct OutageWindow {
+    std::chrono::milliseconds start{0};      // From scenario start
+    std::chrono::milliseconds duration{0};
+    std::chrono::milliseconds period{0};     // Repeat interval (0 = once)
+
+    bool contains(std::chrono::milliseconds elapsed) const;
+};
+
+/// Adverse-conditions model for MockMTAPI, loaded from a scenario file:
+///
+///   latency                    = lognormal 25 0.8
+///   latency.symbol.XAUUSD      = pareto 40 1.5 5000
+///   latency.stall_probability  = 0.001        # occasional multi-second stall
+///   latency.stall_ms           = 3000
+///   failure.timeout            = 0.01         # normal state, per call
+///   failure.margin             = 0.002
+///   failure.reject             = 0.005
+///   failure.timeout_ms         = 0            # extra wait before a timeout
+///   failure.burst.enter        = 0.01         # normal -> burst, per call
+///   failure.burst.exit         = 0.2          # burst -> normal, per call
+///   failure.burst.timeout      = 0.6          # rates while in a burst
+///   outage.<name>              = <start_ms> <duration_ms> [every <period_ms>]
+///
+/// Failures follow a two-state Markov chain (normal / burst), so errors come
+/// in clusters like they do when a real gateway degrades.
+///
+/// Not thread-safe on its own: MockMTAPI calls it under its RNG mutex.
+class BrokerScenario {
+public:
+    BrokerScenario() = default;
+
+    /// The original MockMTAPI behaviour: uniform latency, flat timeout rate.
+    static BrokerScenario uniform(double minMs, double maxMs, double timeoutRate);
+
+    /// Build from a scenario file's entries. Returns std::nullopt and sets
+    /// `error` on a malformed entry.
+    static std::optional<BrokerScenario> fromConfig(const ConfigFile& config, std::string& error);
+
+    /// Round-trip time for one call on `symbol`, stalls included.
+    double sampleLatencyMs(const std::string& symbol, std::mt19937& rng) const;
+
+    /// Default-model latency (calls without a symbol, e.g. connect()).
+    double sampleLatencyMs(std::mt19937& rng) const { return sampleLatencyMs("", rng); }
+
+    /// Advance the failure chain one step and draw an injected failure, if any.
+    std::optional<TradeStatus> drawFailure(std::mt19937& rng);
+
+    /// True while a scheduled outage is in effect.
+    bool inOutage(std::chrono::steady_clock::time_point now) const;
+
+    double timeoutMs() const { return timeoutMs_; }
+    bool   hasLatency() const;
+    bool   hasFailures() const;
+    bool   inBurst() const { return inBurst_; }
+
+    /// One-line summary for the startup log.
+    std::string describe() const;
+
+    const std::string& name() const { return name_; }
+
+private:
+    std::string                                    name_ = "default";
+    LatencyModel                                   latency_;
+    std::unordered_map<std::string, LatencyModel>  symbolLatency_;
+    double                                         stallProbability_ = 0.0;
+    double                                         stallMs_          = 0.0;
+
+    FailureRates                                   normal_;
+    FailureRates                                   burst_;
+    double                                         burstEnter_ = 0.0;
+    double                                         burstExit_  = 1.0;
+    bool                                           inBurst_    = false;
+    double                                         timeoutMs_  = 0.0;
+
+    std::vector<OutageWindow>                      outages_;
+    std::chrono::steady_clock::time_point          start_ = std::chrono::steady_clock::now();
+};
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <vector>
+#include <functional>
 #include "models/TradeRequest.h"
 #include "models/TradeResult.h"
 
@@ -38,6 +39,7 @@ struct AccountInfo {
 ///   getSymbolInfo()   -> IMTManagerAPI::SymbolGet() + SymbolInfoGet()
 ///   getAccountInfo()  -> IMTManagerAPI::UserAccountGet()
 ///   executeTrade()    -> IMTManagerAPI::DealerSend()
+///   executeTradeAsync() -> IMTManagerAPI::DealerSend() + IMTDealerSink::OnDealerResult
 ///   getTicketInfo()   -> IMTManagerAPI::DealGet()
 ///   getSymbols()      -> IMTManagerAPI::SymbolNext() iteration
 class IMTBrokerAPI {
@@ -65,6 +67,16 @@ public:
     /// margin check, symbol trade limits, session filters, price validation.
     virtual TradeResult executeTrade(const TradeRequest& request) = 0;
 
+    using TradeCallback = std::function<void(TradeResult)>;
+
+    /// Asynchronous DealerSend (DealerSend with an IMTDealerSink): returns at
+    /// once and calls `done` with the answer later, possibly on another
+    /// thread. The default answers inline via executeTrade(), which suits
+    /// brokers that never wait.
+    virtual void executeTradeAsync(const TradeRequest& request, TradeCallback done) {
+        done(executeTrade(request));
+    }
+
     /// Get deal info by ticket (DealGet)
     virtual std::optional<TradeResult> getTicketInfo(const std::string& ticketId) = 0;
 
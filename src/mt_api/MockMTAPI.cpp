@@ -1,24 +1,120 @@
 #include "mt_api/MockMTAPI.h"
 #include <thread>
+#include <queue>
+#include <condition_variable>
 #include <cmath>
 #include <sstream>
 #include <iomanip>
+#include <cstdlib>
+#include <cctype>
+#include <cerrno>
+
+/// The mock server's answer thread: delivers asynchronous DealerSend
+/// answers once their simulated latency has passed, the way the real
+/// Manager API calls IMTDealerSink::OnDealerResult from its network thread.
+class MockMTAPI::AnswerThread {
+public:
+    AnswerThread() : thread_(&AnswerThread::run, this) {}
+
+    ~AnswerThread() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_one();
+        thread_.join();
+    }
+
+    void schedule(std::chrono::steady_clock::time_point due, std::function<void()> answer) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_.push({due, order_++, std::move(answer)});
+        }
+        cv_.notify_one();
+    }
+
+private:
+    struct Answer {
+        std::chrono::steady_clock::time_point due;
+        uint64_t                              order;
+        std::function<void()>                 send;
+        bool operator>(const Answer& other) const {
+            return due != other.due ? due > other.due : order > other.order;
+        }
+    };
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopping_) {
+            if (pending_.empty()) {
+                cv_.wait(lock);
+                continue;
+            }
+            auto due = pending_.top().due;
+            if (std::chrono::steady_clock::now() < due) {
+                cv_.wait_until(lock, due);
+                continue;
+            }
+            auto send = std::move(const_cast<Answer&>(pending_.top()).send);
+            pending_.pop();
+            lock.unlock();
+            send();
+            lock.lock();
+        }
+    }
+
+    std::mutex              mutex_;
+    std::condition_variable cv_;
+    std::priority_queue<Answer, std::vector<Answer>, std::greater<Answer>> pending_;
+    uint64_t                order_ = 0;
+    bool                    stopping_ = false;
+    std::thread             thread_;
+};
+
+MockMTAPI::~MockMTAPI() = default;
 
 MockMTAPI::MockMTAPI(double failureRate)
-    : failureRate_(failureRate)
-    , rng_(std::random_device{}())
+    : MockMTAPI(failureRate, 10, 100)
+{}
+
+MockMTAPI::MockMTAPI(double failureRate, int minLatencyMs, int maxLatencyMs, double initialBalance)
+    : MockMTAPI(BrokerScenario::uniform(minLatencyMs, maxLatencyMs, failureRate), initialBalance)
+{}
+
+MockMTAPI::MockMTAPI(BrokerScenario scenario, double initialBalance)
+    : rng_(std::random_device{}())
+    , scenario_(std::move(scenario))
+    , latencyEnabled_(scenario_.hasLatency())
+    , failuresEnabled_(scenario_.hasFailures())
 {
     // Initialize symbol database with realistic forex pairs
     // These mirror what MT5 SymbolGet() would return from the server
-    symbols_["EURUSD"] = {"EURUSD", 1.08450, 1.08465, 0.01, 100.0, 0.01, 5, true};
-    symbols_["GBPUSD"] = {"GBPUSD", 1.26320, 1.26340, 0.01, 100.0, 0.01, 5, true};
-    symbols_["USDJPY"] = {"USDJPY", 149.850, 149.865, 0.01, 100.0, 0.01, 3, true};
-    symbols_["AUDUSD"] = {"AUDUSD", 0.65230, 0.65248, 0.01, 100.0, 0.01, 5, true};
-    symbols_["USDCAD"] = {"USDCAD", 1.35720, 1.35738, 0.01, 100.0, 0.01, 5, true};
-    symbols_["XAUUSD"] = {"XAUUSD", 2035.50, 2036.00, 0.01,  50.0, 0.01, 2, true};
+    addSymbol({"EURUSD", 1.08450, 1.08465, 0.01, 100.0, 0.01, 5, true});
+    addSymbol({"GBPUSD", 1.26320, 1.26340, 0.01, 100.0, 0.01, 5, true});
+    addSymbol({"USDJPY", 149.850, 149.865, 0.01, 100.0, 0.01, 3, true});
+    addSymbol({"AUDUSD", 0.65230, 0.65248, 0.01, 100.0, 0.01, 5, true});
+    addSymbol({"USDCAD", 1.35720, 1.35738, 0.01, 100.0, 0.01, 5, true});
+    addSymbol({"XAUUSD", 2035.50, 2036.00, 0.01,  50.0, 0.01, 2, true});
+
+    // Initialize demo account (default $100,000 balance)
+    account_ = {12345, initialBalance, initialBalance, initialBalance, 0.0, "USD"};
+}
+
+void MockMTAPI::addSymbol(const SymbolInfo& info) {
+    size_t id = static_cast<size_t>(symbolIds_.intern(info.name));
+    if (id >= symbols_.size()) {
+        symbols_.resize(id + 1);
+        symbolListed_.resize(id + 1, false);
+    }
+    symbols_[id] = info;
+    symbolListed_[id] = true;
+}
 
-    // Initialize demo account with $100,000 balance
-    account_ = {12345, 100000.0, 100000.0, 100000.0, 0.0, "USD"};
+const SymbolInfo* MockMTAPI::findSymbol(const std::string& symbol) const {
+    // Known instruments resolve via the compile-time perfect hash (no locks)
+    int id = symbolIds_.resolve(symbol);
+    if (id < 0 || static_cast<size_t>(id) >= symbols_.size() || !symbolListed_[id]) return nullptr;
+    return &symbols_[id];
 }
 
 bool MockMTAPI::connect(const std::string& server, int login, const std::string& password) {
@@ -41,11 +137,11 @@ bool MockMTAPI::isConnected() const {
 std::optional<SymbolInfo> MockMTAPI::getSymbolInfo(const std::string& symbol) {
     // Simulates IMTManagerAPI::SymbolGet(symbol, &info)
     // followed by IMTManagerAPI::SymbolInfoGet(symbol, &tick) for live prices
-    auto it = symbols_.find(symbol);
-    if (it == symbols_.end()) return std::nullopt;
+    const SymbolInfo* listed = findSymbol(symbol);
+    if (!listed) return std::nullopt;
 
     // Add small random price variation to simulate live market
-    SymbolInfo info = it->second;
+    SymbolInfo info = *listed;
     std::lock_guard<std::mutex> lock(rngMutex_);
     double variation = (failDist_(rng_) - 0.5) * 0.0010; // +/- 0.5 pips
     info.bid += variation;
@@ -69,55 +165,125 @@ TradeResult MockMTAPI::executeTrade(const TradeRequest& request) {
     // 3. It returns a proper deal ticket on success
     // 4. Unlike direct deal creation, it respects trading hours and symbol restrictions
 
+    TradeResult result = openTrade(request);
+
+    // Scheduled outage: the gateway refuses the call outright
+    if (scenario_.inOutage(std::chrono::steady_clock::now())) {
+        result.status = TradeStatus::CONNECTION_ERROR;
+        result.errorMessage = "MT5 server unavailable (scheduled outage)";
+        return result;
+    }
+
+    // Simulate network + server processing delay
+    simulateLatency(request.symbol);
+
+    // Simulate injected failures (connection timeouts, margin calls, dealer rejects)
+    auto failure = injectedFailure();
+    if (failure == TradeStatus::CONNECTION_ERROR && scenario_.timeoutMs() > 0.0) {
+        std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(scenario_.timeoutMs()));
+    }
+    return settleTrade(request, std::move(result), failure);
+}
+
+void MockMTAPI::executeTradeAsync(const TradeRequest& request, TradeCallback done) {
+    // Same answers as executeTrade(), but the latency (and a timeout's wait)
+    // elapses on the answer thread instead of the caller's.
+    TradeResult result = openTrade(request);
+    if (scenario_.inOutage(std::chrono::steady_clock::now())) {
+        result.status = TradeStatus::CONNECTION_ERROR;
+        result.errorMessage = "MT5 server unavailable (scheduled outage)";
+        done(std::move(result));
+        return;
+    }
+
+    double ms = 0.0;
+    if (latencyEnabled_) {
+        std::lock_guard<std::mutex> lock(rngMutex_);
+        ms = scenario_.sampleLatencyMs(request.symbol, rng_);
+    }
+    auto failure = injectedFailure();
+    if (failure == TradeStatus::CONNECTION_ERROR) ms += scenario_.timeoutMs();
+    if (ms <= 0.0) {
+        done(settleTrade(request, std::move(result), failure));
+        return;
+    }
+
+    std::call_once(answersStarted_, [this] { answers_ = std::make_unique<AnswerThread>(); });
+    auto due = std::chrono::steady_clock::now() +
+               std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                   std::chrono::duration<double, std::milli>(ms));
+    answers_->schedule(due, [this, request, result = std::move(result), failure, done = std::move(done)]() mutable {
+        done(settleTrade(request, std::move(result), failure));
+    });
+}
+
+TradeResult MockMTAPI::openTrade(const TradeRequest& request) const {
     TradeResult result;
     result.requestId = request.requestId;
     result.clientId = request.clientId;
     result.retryCount = 0;
     result.timestamp = std::chrono::system_clock::now();
+    return result;
+}
 
-    // Simulate network + server processing delay
-    simulateLatency();
-
-    // Simulate random connection failure
-    if (shouldFail()) {
-        result.status = TradeStatus::CONNECTION_ERROR;
-        result.errorMessage = "MT5 server connection timeout during DealerSend()";
+TradeResult MockMTAPI::settleTrade(const TradeRequest& request, TradeResult result,
+                                   std::optional<TradeStatus> failure) {
+    if (failure) {
+        result.status = *failure;
+        switch (*failure) {
+            case TradeStatus::CONNECTION_ERROR:
+                result.errorMessage = "MT5 server connection timeout during DealerSend()";
+                break;
+            case TradeStatus::MARGIN_ERROR:
+                result.errorMessage = "Insufficient margin (server-side margin check)";
+                break;
+            default:
+                result.errorMessage = "Dealer rejected request (requote)";
+                break;
+        }
         return result;
     }
 
     // Step 1: Symbol validation (SymbolGet check)
-    auto symbolInfo = symbols_.find(request.symbol);
-    if (symbolInfo == symbols_.end()) {
+    const SymbolInfo* symbolInfo = findSymbol(request.symbol);
+    if (!symbolInfo) {
         result.status = TradeStatus::INVALID_PARAMS;
         result.errorMessage = "Symbol '" + request.symbol + "' not found (SymbolGet failed)";
         return result;
     }
 
-    if (!symbolInfo->second.tradeAllowed) {
+    if (!symbolInfo->tradeAllowed) {
         result.status = TradeStatus::REJECTED;
         result.errorMessage = "Trading disabled for symbol '" + request.symbol + "'";
         return result;
     }
 
+    // Trading session (the server's per-symbol Sessions schedule)
+    if (calendar_ && !calendar_->isOpen(request.symbol, result.timestamp)) {
+        result.status = TradeStatus::REJECTED;
+        result.errorMessage = "Market closed for symbol '" + request.symbol + "' (outside trading session)";
+        return result;
+    }
+
     // Step 2: Volume validation (server-side check in DealerSend)
-    if (request.volume < symbolInfo->second.minVolume ||
-        request.volume > symbolInfo->second.maxVolume) {
+    if (request.volume < symbolInfo->minVolume ||
+        request.volume > symbolInfo->maxVolume) {
         result.status = TradeStatus::INVALID_PARAMS;
         result.errorMessage = "Volume " + std::to_string(request.volume) +
                               " outside allowed range [" +
-                              std::to_string(symbolInfo->second.minVolume) + ", " +
-                              std::to_string(symbolInfo->second.maxVolume) + "]";
+                              std::to_string(symbolInfo->minVolume) + ", " +
+                              std::to_string(symbolInfo->maxVolume) + "]";
         return result;
     }
 
     // Check volume step alignment (use rounding tolerance for floating-point)
-    double steps = request.volume / symbolInfo->second.volumeStep;
+    double steps = request.volume / symbolInfo->volumeStep;
     double rounded = std::round(steps);
     if (std::fabs(steps - rounded) > 1e-6) {
         result.status = TradeStatus::INVALID_PARAMS;
         result.errorMessage = "Volume " + std::to_string(request.volume) +
                               " not aligned to step " +
-                              std::to_string(symbolInfo->second.volumeStep);
+                              std::to_string(symbolInfo->volumeStep);
         return result;
     }
 
@@ -140,45 +306,42 @@ TradeResult MockMTAPI::executeTrade(const TradeRequest& request) {
     }
 
     // Step 4: Execute - generate fill price and ticket
-    double price = generatePrice(request.symbol, request.tradeType);
-    std::string ticket = generateTicketId();
+    double price = generatePrice(*symbolInfo, request.tradeType);
+    uint64_t ticket = ticketCounter_.fetch_add(1);
 
     result.status = TradeStatus::SUCCESS;
-    result.mtTicketId = ticket;
+    result.mtTicketId = std::to_string(ticket);
     result.executionPrice = price;
 
-    // Store in executed trades map (for DealGet lookups later)
-    {
-        std::lock_guard<std::mutex> lock(tradesMutex_);
-        executedTrades_[ticket] = result;
-    }
+    // Store in executed trades (for DealGet lookups later)
+    executedTrades_.insert(ticket, result);
 
     return result;
 }
 
 std::optional<TradeResult> MockMTAPI::getTicketInfo(const std::string& ticketId) {
     // Simulates IMTManagerAPI::DealGet(ticket, &deal)
-    std::lock_guard<std::mutex> lock(tradesMutex_);
-    auto it = executedTrades_.find(ticketId);
-    if (it == executedTrades_.end()) return std::nullopt;
-    return it->second;
+    // Digits only: strtoull would accept leading whitespace, '+' and even
+    // "-1" (wrapping to ULLONG_MAX)
+    if (ticketId.empty() || !std::isdigit(static_cast<unsigned char>(ticketId[0]))) return std::nullopt;
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long ticket = std::strtoull(ticketId.c_str(), &end, 10);
+    if (errno == ERANGE || *end != '\0') return std::nullopt;
+    return executedTrades_.find(ticket);
 }
 
 std::vector<std::string> MockMTAPI::getSymbols() {
     // Simulates iterating via IMTManagerAPI::SymbolNext()
     std::vector<std::string> result;
     result.reserve(symbols_.size());
-    for (const auto& [name, info] : symbols_) {
-        result.push_back(name);
+    for (size_t id = 0; id < symbols_.size(); ++id) {
+        if (symbolListed_[id]) result.push_back(symbols_[id].name);
     }
     return result;
 }
 
-double MockMTAPI::generatePrice(const std::string& symbol, TradeType type) {
-    auto it = symbols_.find(symbol);
-    if (it == symbols_.end()) return 0.0;
-
-    const auto& info = it->second;
+double MockMTAPI::generatePrice(const SymbolInfo& info, TradeType type) {
     // BUY executes at ASK price, SELL executes at BID price
     double basePrice = (type == TradeType::BUY) ? info.ask : info.bid;
 
@@ -188,21 +351,21 @@ double MockMTAPI::generatePrice(const std::string& symbol, TradeType type) {
     return basePrice + slippage;
 }
 
-std::string MockMTAPI::generateTicketId() {
-    uint64_t id = ticketCounter_.fetch_add(1);
-    return std::to_string(id);
-}
+void MockMTAPI::simulateLatency(const std::string& symbol) {
+    if (!latencyEnabled_) return;
 
-void MockMTAPI::simulateLatency() {
-    int ms;
+    double ms;
     {
         std::lock_guard<std::mutex> lock(rngMutex_);
-        ms = latencyDist_(rng_);
+        ms = scenario_.sampleLatencyMs(symbol, rng_);
+    }
+    if (ms > 0.0) {
+        std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(ms));
     }
-    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
 }
 
-bool MockMTAPI::shouldFail() {
+std::optional<TradeStatus> MockMTAPI::injectedFailure() {
+    if (!failuresEnabled_) return std::nullopt;
     std::lock_guard<std::mutex> lock(rngMutex_);
-    return failDist_(rng_) < failureRate_;
+    return scenario_.drawFailure(rng_);
 }
@@ -1,10 +1,14 @@
 #pragma once
 
 #include "mt_api/IMTBrokerAPI.h"
-#include <unordered_map>
+#include "mt_api/SymbolTable.h"
+#include "mt_api/BrokerScenario.h"
+#include "mt_api/TradeStore.h"
+#include "mt_api/TradingCalendar.h"
 #include <mutex>
 #include <random>
 #include <atomic>
+#include <memory>
 
 /// Mock implementation of the MT5 Manager API for demo/testing.
 ///
@@ -13,11 +17,52 @@
 /// - Account margin tracking (decreases with each trade)
 /// - Random execution delays (simulates network + server processing)
 /// - Configurable failure rate for rejection testing
+/// - Optionally, per-symbol trading sessions (TradingCalendar)
+/// - Optionally, a BrokerScenario: heavy-tailed/per-symbol latency, failure
+///   bursts, injected margin/reject errors and scheduled outages
 /// - Thread-safe (multiple workers can call executeTrade concurrently)
-class MockMTAPI : public IMTBrokerAPI {
+///
+/// Declared `final` so code holding a MockMTAPI& (e.g. a statically-dispatched
+/// BasicDealProcessor<MockMTAPI>) gets direct, inlinable calls.
+class MockMTAPI final : public IMTBrokerAPI {
 public:
     explicit MockMTAPI(double failureRate = 0.05);
 
+    /// Latency range in ms (0/0 = respond instantly) and starting balance.
+    MockMTAPI(double failureRate, int minLatencyMs, int maxLatencyMs,
+              double initialBalance = 100000.0);
+
+    /// Latency and failures driven by a scenario (see BrokerScenario).
+    explicit MockMTAPI(BrokerScenario scenario, double initialBalance = 100000.0);
+
+    ~MockMTAPI() override;
+
+    const BrokerScenario& scenario() const { return scenario_; }
+
+    /// Size the executed-trades store for `expectedTrades` and keep at most
+    /// `retention` of them (0 = all). Call before trading starts.
+    void configureTradeStore(size_t expectedTrades, size_t retention) {
+        executedTrades_.reset(expectedTrades, retention);
+    }
+
+    const TradeStore& tradeStore() const { return executedTrades_; }
+
+    /// Reject trades outside each symbol's trading session (nullptr = always
+    /// open). The calendar must outlive the broker.
+    void setCalendar(const TradingCalendar* calendar) {
+        calendar_ = calendar && !calendar->empty() ? calendar : nullptr;
+    }
+
+    /// Simulated account state, for snapshots and warm restart.
+    AccountInfo accountState() const {
+        std::lock_guard<std::mutex> lock(accountMutex_);
+        return account_;
+    }
+    void restoreAccount(const AccountInfo& account) {
+        std::lock_guard<std::mutex> lock(accountMutex_);
+        account_ = account;
+    }
+
     bool connect(const std::string& server, int login, const std::string& password) override;
     void disconnect() override;
     bool isConnected() const override;
@@ -25,33 +70,50 @@ public:
     std::optional<SymbolInfo>  getSymbolInfo(const std::string& symbol) override;
     std::optional<AccountInfo> getAccountInfo(int login) override;
     TradeResult                executeTrade(const TradeRequest& request) override;
+    void                       executeTradeAsync(const TradeRequest& request, TradeCallback done) override;
     std::optional<TradeResult> getTicketInfo(const std::string& ticketId) override;
     std::vector<std::string>   getSymbols() override;
 
 private:
-    double generatePrice(const std::string& symbol, TradeType type);
-    std::string generateTicketId();
-    void simulateLatency();
-    bool shouldFail();
+    class AnswerThread;
+
+    /// Result skeleton stamped at the time of the call.
+    TradeResult openTrade(const TradeRequest& request) const;
+    /// Server-side checks and fill, once the latency has passed.
+    TradeResult settleTrade(const TradeRequest& request, TradeResult result, std::optional<TradeStatus> failure);
+
+    void addSymbol(const SymbolInfo& info);
+    const SymbolInfo* findSymbol(const std::string& symbol) const;
+    double generatePrice(const SymbolInfo& info, TradeType type);
+    void simulateLatency(const std::string& symbol = "");
+    std::optional<TradeStatus> injectedFailure();
 
     bool                    connected_ = false;
-    double                  failureRate_;
     std::atomic<uint64_t>   ticketCounter_{100000};
 
-    // Symbol database with base prices
-    std::unordered_map<std::string, SymbolInfo> symbols_;
+    // Symbol database with base prices, indexed by dense symbol ID
+    SymbolRegistry          symbolIds_;
+    std::vector<SymbolInfo> symbols_;
+    std::vector<bool>       symbolListed_;
 
     // Simulated account state
     AccountInfo account_;
     mutable std::mutex accountMutex_;
 
-    // Executed trades stored for getTicketInfo lookup
-    std::unordered_map<std::string, TradeResult> executedTrades_;
-    mutable std::mutex tradesMutex_;
+    const TradingCalendar* calendar_ = nullptr;
+
+    // Executed trades stored for getTicketInfo lookup (sharded, numeric tickets)
+    TradeStore executedTrades_;
 
     // Random number generation (per-thread safe via thread_local in .cpp)
     std::mt19937 rng_;
     std::uniform_real_distribution<double> failDist_{0.0, 1.0};
-    std::uniform_int_distribution<int> latencyDist_{10, 100};
+    BrokerScenario                     scenario_;         // Latency/failure model (guarded by rngMutex_)
+    bool                               latencyEnabled_ = true;
+    bool                               failuresEnabled_ = true;
     mutable std::mutex rngMutex_;
+
+    // Answers to executeTradeAsync(), started on first use
+    std::unique_ptr<AnswerThread> answers_;
+    std::once_flag                answersStarted_;
 };
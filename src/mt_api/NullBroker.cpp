@@ -0,0 +1,64 @@
+#include "mt_api/NullBroker.h"
+
+/// Distinguishes broker instances in the per-thread ticket ranges (addresses
+/// can be reused, IDs are not).
+static std::atomic<uint64_t> nextInstanceId{1};
+
+NullBroker::NullBroker(bool keepHistory)
+    : keepHistory_(keepHistory)
+    , instanceId_(nextInstanceId.fetch_add(1))
+{
+    // Same specs as MockMTAPI, fixed prices (no live-market variation)
+    const SymbolInfo specs[] = {
+        {"EURUSD", 1.08450, 1.08465, 0.01, 100.0, 0.01, 5, true},
+        {"GBPUSD", 1.26320, 1.26340, 0.01, 100.0, 0.01, 5, true},
+        {"USDJPY", 149.850, 149.865, 0.01, 100.0, 0.01, 3, true},
+        {"AUDUSD", 0.65230, 0.65248, 0.01, 100.0, 0.01, 5, true},
+        {"USDCAD", 1.35720, 1.35738, 0.01, 100.0, 0.01, 5, true},
+        {"XAUUSD", 2035.50, 2036.00, 0.01,  50.0, 0.01, 2, true},
+    };
+    for (const auto& spec : specs) {
+        symbols_[DEFAULT_SYMBOL_TABLE.find(spec.name)] = spec;
+    }
+
+    account_ = {12345, 1e12, 1e12, 1e12, 0.0, "USD"};
+}
+
+bool NullBroker::connect(const std::string& server, int login, const std::string& password) {
+    connected_ = true;
+    account_.login = login;
+    return true;
+}
+
+void NullBroker::disconnect() {
+    connected_ = false;
+}
+
+bool NullBroker::isConnected() const {
+    return connected_;
+}
+
+std::optional<AccountInfo> NullBroker::getAccountInfo(int login) {
+    if (login != account_.login) return std::nullopt;
+    return account_;
+}
+
+std::optional<TradeResult> NullBroker::getTicketInfo(const std::string& ticketId) {
+    if (!keepHistory_) return std::nullopt;
+    std::lock_guard<std::mutex> lock(historyMutex_);
+    auto it = history_.find(ticketId);
+    if (it == history_.end()) return std::nullopt;
+    return it->second;
+}
+
+std::vector<std::string> NullBroker::getSymbols() {
+    std::vector<std::string> result;
+    result.reserve(symbols_.size());
+    for (const auto& info : symbols_) result.push_back(info.name);
+    return result;
+}
+
+void NullBroker::remember(const TradeResult& result) {
+    std::lock_guard<std::mutex> lock(historyMutex_);
+    history_[result.mtTicketId] = result;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "mt_api/IMTBrokerAPI.h"
+#include "mt_api/SymbolTable.h"
+#include "models/RequestId.h"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+/// Broker that fills every order instantly, for measuring the processor's
+/// own throughput ceiling.
+///
+/// Unlike MockMTAPI it never sleeps, draws no random numbers and takes no
+/// locks on the trade path:
+///   - symbols are a fixed table indexed by the compile-time perfect hash;
+///   - tickets are numeric, handed out from per-thread leased ranges (one
+///     atomic add per TICKET_BLOCK fills) and rendered into the result's
+///     small-string buffer, so no heap allocation for the ticket either;
+///   - fills are not remembered unless keepHistory is set (getTicketInfo
+///     then works, at the cost of a mutex-guarded map insert per fill).
+///
+/// Validation still happens in the processor; the broker only repeats the
+/// symbol check it needs to pick a fill price.
+class NullBroker final : public IMTBrokerAPI {
+public:
+    static constexpr uint64_t TICKET_BLOCK = 4096;
+    static constexpr uint64_t FIRST_TICKET = 100000000;
+
+    explicit NullBroker(bool keepHistory = false);
+
+    bool connect(const std::string& server, int login, const std::string& password) override;
+    void disconnect() override;
+    bool isConnected() const override;
+
+    std::optional<SymbolInfo>  getSymbolInfo(const std::string& symbol) override {
+        int id = DEFAULT_SYMBOL_TABLE.find(symbol);
+        if (id < 0) return std::nullopt;
+        return symbols_[id];
+    }
+
+    std::optional<AccountInfo> getAccountInfo(int login) override;
+
+    TradeResult executeTrade(const TradeRequest& request) override {
+        TradeResult result;
+        result.requestId = request.requestId;
+        result.clientId  = request.clientId;
+        result.timestamp = request.timestamp;   // No clock read: the fill is "instant"
+
+        int id = DEFAULT_SYMBOL_TABLE.find(request.symbol);
+        if (id < 0) {
+            result.status = TradeStatus::INVALID_PARAMS;
+            result.errorMessage = "Unknown symbol";
+            return result;
+        }
+
+        const SymbolInfo& info = symbols_[id];
+        result.status         = TradeStatus::SUCCESS;
+        result.executionPrice = request.tradeType == TradeType::BUY ? info.ask : info.bid;
+
+        char digits[RequestIdFormat::MAX_SEQ_DIGITS];
+        uint64_t ticket = nextTicket();
+        int width = RequestIdFormat::decimalLength(ticket);
+        RequestIdFormat::renderWidth(digits, ticket, width);
+        result.mtTicketId.assign(digits, static_cast<size_t>(width));
+
+        if (keepHistory_) remember(result);
+        return result;
+    }
+
+    std::optional<TradeResult> getTicketInfo(const std::string& ticketId) override;
+    std::vector<std::string>   getSymbols() override;
+
+private:
+    uint64_t nextTicket() {
+        // Per-thread range; `owner` guards against a thread switching brokers.
+        struct Range { uint64_t owner = 0; uint64_t next = 0; uint64_t end = 0; };
+        thread_local Range range;
+        if (range.owner != instanceId_ || range.next == range.end) {
+            range.owner = instanceId_;
+            range.next  = nextBlock_.fetch_add(TICKET_BLOCK, std::memory_order_relaxed);
+            range.end   = range.next + TICKET_BLOCK;
+        }
+        return range.next++;
+    }
+
+    void remember(const TradeResult& result);
+
+    bool                                              connected_ = false;
+    bool                                              keepHistory_;
+    uint64_t                                          instanceId_;
+    std::atomic<uint64_t>                             nextBlock_{FIRST_TICKET};
+    std::array<SymbolInfo, DEFAULT_INSTRUMENTS.size()> symbols_;
+    AccountInfo                                       account_;
+
+    std::mutex                                        historyMutex_;   // keepHistory only
+    std::unordered_map<std::string, TradeResult>      history_;
+};
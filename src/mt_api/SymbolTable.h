@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <cstdint>
+
+/// Instrument universe the demo broker and clients trade.
+inline constexpr std::array<std::string_view, 6> DEFAULT_INSTRUMENTS = {
+    "EURUSD", "GBPUSD", "USDJPY", "AUDUSD", "USDCAD", "XAUUSD"
+};
+
+/// Perfect hash over a fixed symbol list, built at compile time.
+///
+/// Symbols map to dense IDs 0..N-1 (their position in the list). The
+/// constructor searches for a multiplier that places every symbol in its own
+/// slot, so a lookup is one multiplicative hash over the first 8 bytes, one
+/// table load and one string compare - no hashing of the whole std::string,
+/// no bucket chains. Declared constexpr, literal lookups fold to constants:
+///   static constexpr int XAU = DEFAULT_SYMBOL_TABLE.find("XAUUSD");   // == 5
+template <size_t N>
+class PerfectSymbolHash {
+public:
+    static constexpr size_t TABLE_BITS = N <= 4 ? 3 : N <= 8 ? 4 : N <= 16 ? 5 : N <= 32 ? 6 : 8;
+    static constexpr size_t TABLE_SIZE = size_t{1} << TABLE_BITS;
+    static_assert(N * 2 <= TABLE_SIZE, "symbol list too large for PerfectSymbolHash");
+
+    constexpr explicit PerfectSymbolHash(const std::array<std::string_view, N>& symbols)
+        : symbols_(symbols)
+    {
+        for (uint64_t candidate = 0x9E3779B97F4A7C15ull; ; candidate += 0x632BE59BD9B4E019ull) {
+            multiplier_ = candidate | 1;
+            if (tryBuild()) return;
+        }
+    }
+
+    /// Dense ID of `symbol`, or -1 if it is not in the list.
+    constexpr int find(std::string_view symbol) const {
+        int id = slots_[slot(symbol)];
+        return (id >= 0 && symbols_[id] == symbol) ? id : -1;
+    }
+
+    constexpr std::string_view name(int id) const { return symbols_[id]; }
+    static constexpr size_t size() { return N; }
+
+private:
+    /// First 8 bytes packed little-endian, mixed with the length.
+    static constexpr uint64_t prefixWord(std::string_view s) {
+        uint64_t word = 0;
+        size_t n = s.size() < 8 ? s.size() : 8;
+        for (size_t i = 0; i < n; ++i) {
+            word |= static_cast<uint64_t>(static_cast<unsigned char>(s[i])) << (8 * i);
+        }
+        return word ^ (static_cast<uint64_t>(s.size()) << 59);
+    }
+
+    constexpr size_t slot(std::string_view s) const {
+        return static_cast<size_t>((prefixWord(s) * multiplier_) >> (64 - TABLE_BITS));
+    }
+
+    constexpr bool tryBuild() {
+        for (auto& entry : slots_) entry = -1;
+        for (size_t i = 0; i < N; ++i) {
+            size_t s = slot(symbols_[i]);
+            if (slots_[s] >= 0) return false;
+            slots_[s] = static_cast<int>(i);
+        }
+        return true;
+    }
+
+    std::array<std::string_view, N> symbols_;
+    std::array<int, TABLE_SIZE>     slots_{};
+    uint64_t                        multiplier_ = 0;
+};
+
+inline constexpr PerfectSymbolHash<DEFAULT_INSTRUMENTS.size()> DEFAULT_SYMBOL_TABLE{DEFAULT_INSTRUMENTS};
+
+/// Runtime symbol -> dense ID resolution.
+///
+/// Known instruments resolve through the compile-time perfect hash without
+/// locking. Anything else falls back to a dynamic map (IDs continue after the
+/// static ones), so unknown or newly listed symbols still work.
+class SymbolRegistry {
+public:
+    static constexpr int UNKNOWN = -1;
+
+    /// ID of an already-known symbol, or UNKNOWN.
+    int resolve(std::string_view symbol) const {
+        int id = DEFAULT_SYMBOL_TABLE.find(symbol);
+        if (id >= 0) return id;
+
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = dynamic_.find(std::string(symbol));
+        return it == dynamic_.end() ? UNKNOWN : it->second;
+    }
+
+    /// ID for `symbol`, registering it if needed.
+    int intern(std::string_view symbol) {
+        int id = resolve(symbol);
+        if (id != UNKNOWN) return id;
+
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto [it, inserted] = dynamic_.emplace(std::string(symbol), nextId_);
+        if (inserted) ++nextId_;
+        return it->second;
+    }
+
+    /// Upper bound (exclusive) of IDs handed out so far.
+    int size() const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return nextId_;
+    }
+
+private:
+    mutable std::shared_mutex            mutex_;
+    std::unordered_map<std::string, int> dynamic_;
+    int                                  nextId_ = static_cast<int>(DEFAULT_SYMBOL_TABLE.size());
+};
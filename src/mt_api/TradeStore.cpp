@@ -0,0 +1,138 @@
+#include "mt_api/TradeStore.h"
+
+/// Smallest power of two >= 2 * n (load factor <= 0.5), at least 16.
+static size_t tableSizeFor(size_t n) {
+    size_t size = 16;
+    while (size < 2 * n) size <<= 1;
+    return size;
+}
+
+TradeStore::TradeStore(size_t expectedTrades, size_t retention) {
+    reset(expectedTrades, retention);
+}
+
+void TradeStore::reset(size_t expectedTrades, size_t retention) {
+    retention_ = retention;
+
+    size_t perShardRetention = retention == 0 ? 0 : (retention + SHARD_COUNT - 1) / SHARD_COUNT;
+    size_t perShardExpected  = (expectedTrades + SHARD_COUNT - 1) / SHARD_COUNT;
+    if (perShardRetention > 0) perShardExpected = perShardRetention;
+
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.slots.assign(tableSizeFor(perShardExpected), Slot{});
+        shard.mask     = shard.slots.size() - 1;
+        shard.count    = 0;
+        shard.ring.assign(perShardRetention, 0);
+        shard.ringHead = 0;
+        shard.evicted  = 0;
+    }
+}
+
+long TradeStore::findSlot(const Shard& shard, uint64_t ticket) {
+    size_t i = home(shard, ticket);
+    for (size_t d = 0; ; ++d, i = (i + 1) & shard.mask) {
+        const Slot& slot = shard.slots[i];
+        if (slot.ticket == ticket) return static_cast<long>(i);
+        // Robin Hood invariant: had the ticket been here, it would sit no
+        // further from home than this entry does.
+        if (slot.ticket == 0 || distance(shard, slot.ticket, i) < d) return -1;
+    }
+}
+
+void TradeStore::place(Shard& shard, uint64_t ticket, const TradeResult& result) {
+    Slot carried{ticket, result};
+    size_t i = home(shard, carried.ticket);
+    for (size_t d = 0; ; ++d, i = (i + 1) & shard.mask) {
+        Slot& slot = shard.slots[i];
+        if (slot.ticket == 0) {
+            slot = std::move(carried);
+            ++shard.count;
+            return;
+        }
+        if (slot.ticket == carried.ticket) {
+            slot.result = std::move(carried.result);
+            return;
+        }
+        // Robin Hood: take the slot from an entry closer to its home.
+        size_t existing = distance(shard, slot.ticket, i);
+        if (existing < d) {
+            std::swap(slot, carried);
+            d = existing;
+        }
+    }
+}
+
+void TradeStore::erase(Shard& shard, uint64_t ticket) {
+    long found = findSlot(shard, ticket);
+    if (found < 0) return;
+
+    // Backward-shift deletion: pull the rest of the run back one slot until
+    // an empty slot or an entry already at home, so no tombstones are needed.
+    size_t hole = static_cast<size_t>(found);
+    for (size_t next = (hole + 1) & shard.mask;
+         shard.slots[next].ticket != 0 && distance(shard, shard.slots[next].ticket, next) > 0;
+         next = (next + 1) & shard.mask) {
+        shard.slots[hole] = std::move(shard.slots[next]);
+        hole = next;
+    }
+    shard.slots[hole].ticket = 0;
+    shard.slots[hole].result = TradeResult{};
+    --shard.count;
+}
+
+void TradeStore::grow(Shard& shard) {
+    std::vector<Slot> old(shard.slots.size() * 2);
+    old.swap(shard.slots);
+    shard.mask  = shard.slots.size() - 1;
+    shard.count = 0;
+    for (auto& slot : old) {
+        if (slot.ticket != 0) place(shard, slot.ticket, slot.result);
+    }
+}
+
+void TradeStore::insert(uint64_t ticket, const TradeResult& result) {
+    Shard& shard = shardFor(ticket);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    if (!shard.ring.empty()) {
+        uint64_t oldest = shard.ring[shard.ringHead];
+        if (oldest != 0) {
+            erase(shard, oldest);
+            ++shard.evicted;
+        }
+        shard.ring[shard.ringHead] = ticket;
+        shard.ringHead = (shard.ringHead + 1) % shard.ring.size();
+    } else if (2 * (shard.count + 1) > shard.slots.size()) {
+        grow(shard);
+    }
+
+    place(shard, ticket, result);
+}
+
+std::optional<TradeResult> TradeStore::find(uint64_t ticket) const {
+    if (ticket == 0) return std::nullopt;
+    const Shard& shard = shardFor(ticket);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    long i = findSlot(shard, ticket);
+    if (i < 0) return std::nullopt;
+    return shard.slots[static_cast<size_t>(i)].result;
+}
+
+size_t TradeStore::size() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.count;
+    }
+    return total;
+}
+
+size_t TradeStore::evicted() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.evicted;
+    }
+    return total;
+}
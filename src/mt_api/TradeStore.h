@@ -0,0 +1,82 @@
+#pragma once
+
+#include "models/TradeResult.h"
+
+#include <array>
+#include <vector>
+#include <mutex>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+/// Executed-trade history keyed by numeric ticket (DealGet lookups).
+///
+/// Tickets are spread over SHARD_COUNT shards by their low bits, each with
+/// its own mutex, so concurrent fills and lookups rarely contend. Inside a
+/// shard, trades sit in a pre-sized open-addressing table (Robin Hood linear
+/// probing, backward-shift deletion, so probe runs stay short and eviction
+/// is O(1)). Tickets are issued sequentially, so the slot
+/// index is simply the remaining ticket bits masked to the table size:
+/// consecutive tickets land in consecutive slots and do not collide.
+///
+/// With a retention limit each shard also keeps a FIFO ring of its tickets
+/// and evicts the oldest trade once full, so memory stays bounded no matter
+/// how many deals go through. Without one the table doubles when it passes
+/// half full.
+class TradeStore {
+public:
+    static constexpr size_t SHARD_BITS  = 4;
+    static constexpr size_t SHARD_COUNT = size_t{1} << SHARD_BITS;
+
+    /// `expectedTrades` pre-sizes the tables; `retention` caps how many
+    /// trades are kept (0 = keep everything), split evenly over the shards
+    /// and so rounded up to a multiple of SHARD_COUNT.
+    explicit TradeStore(size_t expectedTrades = 4096, size_t retention = 0);
+
+    /// Re-size and clear. Not thread-safe: call before trading starts.
+    void reset(size_t expectedTrades, size_t retention);
+
+    /// Store (or replace) the trade for `ticket`. Ticket 0 is reserved.
+    void insert(uint64_t ticket, const TradeResult& result);
+
+    std::optional<TradeResult> find(uint64_t ticket) const;
+
+    size_t size() const;
+    size_t evicted() const;
+    size_t retention() const { return retention_; }
+
+private:
+    struct Slot {
+        uint64_t    ticket = 0;   // 0 = empty
+        TradeResult result;
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex    mutex;
+        std::vector<Slot>     slots;
+        size_t                mask    = 0;
+        size_t                count   = 0;
+        std::vector<uint64_t> ring;        // Retention FIFO (empty = unbounded)
+        size_t                ringHead = 0;
+        size_t                evicted  = 0;
+    };
+
+    static size_t home(const Shard& shard, uint64_t ticket) {
+        return static_cast<size_t>(ticket >> SHARD_BITS) & shard.mask;
+    }
+    /// Probe distance of `ticket` stored at slot `i`.
+    static size_t distance(const Shard& shard, uint64_t ticket, size_t i) {
+        return (i - home(shard, ticket)) & shard.mask;
+    }
+    Shard&       shardFor(uint64_t ticket)       { return shards_[ticket & (SHARD_COUNT - 1)]; }
+    const Shard& shardFor(uint64_t ticket) const { return shards_[ticket & (SHARD_COUNT - 1)]; }
+
+    static long findSlot(const Shard& shard, uint64_t ticket);
+    static void erase(Shard& shard, uint64_t ticket);
+    static void grow(Shard& shard);
+    static void place(Shard& shard, uint64_t ticket, const TradeResult& result);
+
+    std::array<Shard, SHARD_COUNT> shards_;
+    size_t                         retention_ = 0;
+};
@@ -0,0 +1,239 @@
+#include "mt_api/TradingCalendar.h"
+
+#include <algorithm>
+#include <sstream>
+#include <cctype>
+
+static constexpr const char* DAY_NAMES[7] = {"mon", "tue", "wed", "thu", "fri", "sat", "sun"};
+
+static std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t");
+    if (begin == std::string::npos) return "";
+    size_t end = text.find_last_not_of(" \t");
+    return text.substr(begin, end - begin + 1);
+}
+
+static std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::istringstream in(text);
+    for (std::string item; std::getline(in, item, ','); ) {
+        item = trim(item);
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+static int parseDay(const std::string& name) {
+    std::string lower;
+    for (char c : name) lower += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    for (int d = 0; d < 7; ++d) {
+        if (lower == DAY_NAMES[d]) return d;
+    }
+    return -1;
+}
+
+/// "HH:MM" -> minutes (24:00 allowed); -1 if malformed.
+static int parseTime(const std::string& text) {
+    int h, m;
+    char colon;
+    std::istringstream in(text);
+    if (!(in >> h >> colon >> m) || colon != ':' || !in.eof() || h < 0 || m < 0 || m > 59 ||
+        h * 60 + m > TradingCalendar::MINUTES_PER_DAY) {
+        return -1;
+    }
+    return h * 60 + m;
+}
+
+/// Days in month `m` (1-12) of year `y`, Gregorian leap years.
+static unsigned daysInMonth(int64_t y, unsigned m) {
+    static constexpr unsigned DAYS[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+    return m == 2 && leap ? 29 : DAYS[m - 1];
+}
+
+/// Days since 1970-01-01 for a proleptic Gregorian date.
+static int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = static_cast<unsigned>(y - era * 400);
+    unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+using WeeklyBits = std::array<uint64_t, (TradingCalendar::MINUTES_PER_WEEK + 63) / 64>;
+
+static void setOpen(WeeklyBits& bits, int from, int to) {
+    for (int m = from; m < to; ++m) {
+        int minute = m % TradingCalendar::MINUTES_PER_WEEK;
+        bits[minute >> 6] |= uint64_t{1} << (minute & 63);
+    }
+}
+
+/// "mon-fri 00:00-24:00, sun 22:00-24:00" -> weekly bitmap.
+static bool parseWeekly(const std::string& text, WeeklyBits& bits, std::string& error) {
+    bits.fill(0);
+    for (const auto& item : splitList(text)) {
+        std::istringstream in(item);
+        std::string days, hours, extra;
+        in >> days >> hours >> extra;
+        if (!extra.empty()) {
+            error = "unexpected '" + extra + "' in '" + item + "'";
+            return false;
+        }
+
+        size_t dash = days.find('-');
+        int first = parseDay(days.substr(0, dash));
+        int last  = dash == std::string::npos ? first : parseDay(days.substr(dash + 1));
+        if (first < 0 || last < 0) {
+            error = "bad day range '" + days + "' (mon..sun)";
+            return false;
+        }
+
+        int open = 0, close = TradingCalendar::MINUTES_PER_DAY;
+        if (!hours.empty()) {
+            size_t sep = hours.find('-');
+            open  = sep == std::string::npos ? -1 : parseTime(hours.substr(0, sep));
+            close = sep == std::string::npos ? -1 : parseTime(hours.substr(sep + 1));
+            if (open < 0 || close < 0) {
+                error = "bad hours '" + hours + "' (HH:MM-HH:MM)";
+                return false;
+            }
+            if (close <= open) close += TradingCalendar::MINUTES_PER_DAY;   // Runs past midnight
+        }
+
+        for (int d = first; ; d = (d + 1) % 7) {
+            setOpen(bits, d * TradingCalendar::MINUTES_PER_DAY + open, d * TradingCalendar::MINUTES_PER_DAY + close);
+            if (d == last) break;
+        }
+    }
+    return true;
+}
+
+/// "2026-12-25, 2027-01-01" -> day numbers.
+static bool parseHolidays(const std::string& text, std::vector<int64_t>& days, std::string& error) {
+    for (const auto& item : splitList(text)) {
+        int y;
+        unsigned m, d;
+        char dash1, dash2;
+        std::istringstream in(item);
+        if (!(in >> y >> dash1 >> m >> dash2 >> d) || dash1 != '-' || dash2 != '-' || !in.eof() ||
+            m < 1 || m > 12 || d < 1 || d > daysInMonth(y, m)) {
+            error = "bad date '" + item + "' (YYYY-MM-DD)";
+            return false;
+        }
+        days.push_back(daysFromCivil(y, m, d));
+    }
+    return true;
+}
+
+static TradingCalendar::Schedule compile(const WeeklyBits& weekly, std::vector<int64_t> holidays) {
+    TradingCalendar::Schedule schedule;
+    schedule.weekly = weekly;
+    if (!holidays.empty()) {
+        auto [lo, hi] = std::minmax_element(holidays.begin(), holidays.end());
+        schedule.holidayBase = *lo;
+        schedule.holidays.assign(static_cast<size_t>((*hi - *lo) / 64 + 1), 0);
+        for (int64_t day : holidays) {
+            uint64_t bit = static_cast<uint64_t>(day - *lo);
+            schedule.holidays[bit >> 6] |= uint64_t{1} << (bit & 63);
+        }
+    }
+    return schedule;
+}
+
+bool TradingCalendar::load(const ConfigFile& config, std::string& error) {
+    const std::string SESSION = "calendar.session.";
+    const std::string HOLIDAY = "calendar.holiday.";
+
+    WeeklyBits allWeek;
+    allWeek.fill(0);
+    setOpen(allWeek, 0, MINUTES_PER_WEEK);
+
+    WeeklyBits defaultWeekly = allWeek;
+    bool hasDefault = false;
+    if (config.has(SESSION + "default")) {
+        if (!parseWeekly(config.getString(SESSION + "default"), defaultWeekly, error)) {
+            error = SESSION + "default: " + error;
+            return false;
+        }
+        hasDefault = true;
+    }
+
+    std::vector<int64_t> commonHolidays;
+    if (config.has(HOLIDAY + "all")) {
+        if (!parseHolidays(config.getString(HOLIDAY + "all"), commonHolidays, error)) {
+            error = HOLIDAY + "all: " + error;
+            return false;
+        }
+        hasDefault = true;
+    }
+
+    // Symbols named by either kind of entry, in file order
+    std::vector<std::string> symbols;
+    for (const auto& prefix : {SESSION, HOLIDAY}) {
+        for (const auto& key : config.keysWithPrefix(prefix)) {
+            std::string symbol = key.substr(prefix.size());
+            if (symbol == "default" || symbol == "all") continue;
+            if (std::find(symbols.begin(), symbols.end(), symbol) == symbols.end()) symbols.push_back(symbol);
+        }
+    }
+
+    std::vector<Schedule>    schedules;
+    std::vector<std::string> names;
+    for (const auto& symbol : symbols) {
+        WeeklyBits weekly = defaultWeekly;
+        if (config.has(SESSION + symbol) && !parseWeekly(config.getString(SESSION + symbol), weekly, error)) {
+            error = SESSION + symbol + ": " + error;
+            return false;
+        }
+        std::vector<int64_t> holidays = commonHolidays;
+        if (config.has(HOLIDAY + symbol) && !parseHolidays(config.getString(HOLIDAY + symbol), holidays, error)) {
+            error = HOLIDAY + symbol + ": " + error;
+            return false;
+        }
+        schedules.push_back(compile(weekly, std::move(holidays)));
+        names.push_back(symbol);
+    }
+
+    int defaultIndex = -1;
+    if (hasDefault) {
+        defaultIndex = static_cast<int>(schedules.size());
+        schedules.push_back(compile(defaultWeekly, commonHolidays));
+        names.push_back("default");
+    }
+
+    schedules_    = std::move(schedules);
+    names_        = std::move(names);
+    defaultIndex_ = defaultIndex;
+    utcOffsetMinutes_ = config.getInt("calendar.utc_offset_min", 0);
+    instruments_.fill(-1);
+    others_.clear();
+    for (int i = 0; i < static_cast<int>(names_.size()); ++i) {
+        if (i == defaultIndex_) continue;
+        int id = DEFAULT_SYMBOL_TABLE.find(names_[i]);
+        if (id >= 0) {
+            instruments_[id] = i;
+        } else {
+            others_[names_[i]] = i;
+        }
+    }
+    return true;
+}
+
+std::vector<std::string> TradingCalendar::describe() const {
+    std::vector<std::string> lines;
+    for (size_t i = 0; i < schedules_.size(); ++i) {
+        const Schedule& s = schedules_[i];
+        int openMinutes = 0;
+        for (uint64_t word : s.weekly) openMinutes += __builtin_popcountll(word);
+        int holidays = 0;
+        for (uint64_t word : s.holidays) holidays += __builtin_popcountll(word);
+
+        std::ostringstream oss;
+        oss << "Trading calendar " << names_[i] << ": open " << openMinutes / 60 << "h"
+            << openMinutes % 60 << "m per week, " << holidays << " holidays";
+        lines.push_back(oss.str());
+    }
+    return lines;
+}
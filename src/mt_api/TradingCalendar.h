@@ -0,0 +1,104 @@
+#pragma once
+
+#include "config/ConfigFile.h"
+#include "mt_api/SymbolTable.h"
+
+#include <array>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+
+/// Per-symbol trading sessions (MT5 "Sessions" tab): a weekly schedule plus
+/// holidays, compiled to bitmaps so "is the market open at t" is a couple of
+/// shifts and masks.
+///
+///   calendar.utc_offset_min   = 120                           # server time = UTC+2
+///   calendar.session.default  = mon-fri 00:00-24:00           # symbols without their own
+///   calendar.session.XAUUSD   = mon-fri 01:00-23:55
+///   calendar.session.EURUSD   = sun 22:00-24:00, mon-thu 00:00-24:00, fri 00:00-21:55
+///   calendar.holiday.all      = 2026-12-25, 2027-01-01        # every scheduled symbol
+///   calendar.holiday.XAUUSD   = 2026-04-03
+///
+/// Times are server time, minute resolution, end exclusive; a window may
+/// run past midnight (fri 22:00-02:00 closes at 02:00 Saturday). A holiday
+/// closes the whole server-time day. Symbols with no schedule (and no
+/// default) are always open.
+class TradingCalendar {
+public:
+    static constexpr int MINUTES_PER_DAY  = 24 * 60;
+    static constexpr int MINUTES_PER_WEEK = 7 * MINUTES_PER_DAY;
+
+    /// A point in server time, pre-split for lookups; compute once per
+    /// batch with at() and reuse it for every request.
+    struct Moment {
+        int64_t day;            // Days since 1970-01-01 (server time)
+        int32_t minuteOfWeek;   // 0 = Monday 00:00
+    };
+
+    /// One symbol's compiled calendar.
+    struct Schedule {
+        std::array<uint64_t, (MINUTES_PER_WEEK + 63) / 64> weekly{};   // Bit set = open
+        int64_t               holidayBase = 0;   // Day of holidays bit 0
+        std::vector<uint64_t> holidays;          // Bit set = closed all day
+
+        bool isOpen(const Moment& m) const {
+            uint64_t offset = static_cast<uint64_t>(m.day - holidayBase);
+            if (offset < holidays.size() * 64 && ((holidays[offset >> 6] >> (offset & 63)) & 1)) {
+                return false;
+            }
+            uint32_t minute = static_cast<uint32_t>(m.minuteOfWeek);
+            return (weekly[minute >> 6] >> (minute & 63)) & 1;
+        }
+    };
+
+    /// Compile the "calendar.*" entries. On a syntax error returns false with
+    /// `error` naming the entry, and leaves the calendar unchanged.
+    bool load(const ConfigFile& config, std::string& error);
+
+    bool empty() const { return schedules_.empty(); }
+
+    Moment at(std::chrono::system_clock::time_point t) const {
+        int64_t minutes = std::chrono::duration_cast<std::chrono::minutes>(t.time_since_epoch()).count();
+        minutes += utcOffsetMinutes_;
+        int64_t day = minutes >= 0 ? minutes / MINUTES_PER_DAY
+                                   : -((-minutes + MINUTES_PER_DAY - 1) / MINUTES_PER_DAY);
+        int64_t minuteOfDay = minutes - day * MINUTES_PER_DAY;
+        // 1970-01-01 was a Thursday: Monday-based weekday 3
+        int64_t weekday = ((day + 3) % 7 + 7) % 7;
+        return {day, static_cast<int32_t>(weekday * MINUTES_PER_DAY + minuteOfDay)};
+    }
+
+    /// Schedule for `symbol`, or nullptr if it trades around the clock.
+    const Schedule* find(const std::string& symbol) const {
+        int id = DEFAULT_SYMBOL_TABLE.find(symbol);
+        if (id >= 0) return instruments_[id] >= 0 ? &schedules_[instruments_[id]] : defaultSchedule();
+        auto it = others_.find(symbol);
+        return it != others_.end() ? &schedules_[it->second] : defaultSchedule();
+    }
+
+    bool isOpen(const std::string& symbol, const Moment& m) const {
+        const Schedule* schedule = find(symbol);
+        return !schedule || schedule->isOpen(m);
+    }
+
+    bool isOpen(const std::string& symbol, std::chrono::system_clock::time_point t) const {
+        return isOpen(symbol, at(t));
+    }
+
+    /// One line per configured schedule, for the startup log.
+    std::vector<std::string> describe() const;
+
+private:
+    const Schedule* defaultSchedule() const {
+        return defaultIndex_ >= 0 ? &schedules_[defaultIndex_] : nullptr;
+    }
+
+    std::vector<Schedule>                      schedules_;
+    std::vector<std::string>                   names_;          // Parallel to schedules_
+    std::array<int, DEFAULT_INSTRUMENTS.size()> instruments_{};  // Perfect-hash ID -> schedule (-1 = default)
+    std::unordered_map<std::string, int>       others_;
+    int                                        defaultIndex_ = -1;
+    int64_t                                    utcOffsetMinutes_ = 0;
+};
@@ -0,0 +1,194 @@
+#include "perf/PerfCounters.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static constexpr uint64_t EVENT_CONFIG[PerfCounters::EVENT_COUNT] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+static int perfEventOpen(perf_event_attr* attr, int groupFd) {
+    // This thread (pid 0), any CPU
+    return static_cast<int>(::syscall(__NR_perf_event_open, attr, 0, -1, groupFd, PERF_FLAG_FD_CLOEXEC));
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+static inline uint64_t rdpmc(uint32_t counter) {
+    uint32_t lo, hi;
+    asm volatile("rdpmc" : "=a"(lo), "=d"(hi) : "c"(counter));
+    return lo | (static_cast<uint64_t>(hi) << 32);
+}
+
+static inline uint64_t rdtsc() {
+    uint32_t lo, hi;
+    asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return lo | (static_cast<uint64_t>(hi) << 32);
+}
+#endif
+
+/// Layout of a PERF_FORMAT_GROUP | TOTAL_TIME_ENABLED | TOTAL_TIME_RUNNING read.
+struct GroupRead {
+    uint64_t nr;
+    uint64_t enabled;
+    uint64_t running;
+    uint64_t values[PerfCounters::EVENT_COUNT];
+};
+
+static uint64_t steadyNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+const char* PerfCounters::eventName(int event) {
+    switch (event) {
+        case CYCLES:        return "cycles";
+        case INSTRUCTIONS:  return "instructions";
+        case CACHE_MISSES:  return "cache-misses";
+        case BRANCH_MISSES: return "branch-misses";
+        default:            return "?";
+    }
+}
+
+PerfCounters& PerfCounters::thisThread() {
+    static thread_local PerfCounters counters;
+    return counters;
+}
+
+PerfCounters::PerfCounters() {
+    fds_.fill(-1);
+
+    for (int event = 0; event < EVENT_COUNT; ++event) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size           = sizeof(attr);
+        attr.type           = PERF_TYPE_HARDWARE;
+        attr.config         = EVENT_CONFIG[event];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        int fd = perfEventOpen(&attr, event == CYCLES ? -1 : fds_[CYCLES]);
+        if (fd < 0) {
+            error_ = std::string("perf_event_open(") + eventName(event) + "): " + std::strerror(errno);
+            for (int& open : fds_) {
+                if (open >= 0) ::close(open);
+                open = -1;
+            }
+            return;
+        }
+        fds_[event] = fd;
+    }
+
+    // Map each counter's page: rdpmc needs its index and offset
+    rdpmc_ = true;
+    long pageSize = ::sysconf(_SC_PAGESIZE);
+    for (int event = 0; event < EVENT_COUNT; ++event) {
+        void* page = ::mmap(nullptr, static_cast<size_t>(pageSize), PROT_READ, MAP_SHARED, fds_[event], 0);
+        if (page == MAP_FAILED) {
+            rdpmc_ = false;
+            continue;
+        }
+        pages_[event] = static_cast<perf_event_mmap_page*>(page);
+        if (!pages_[event]->cap_user_rdpmc) rdpmc_ = false;
+    }
+#if !defined(__x86_64__) && !defined(__i386__)
+    rdpmc_ = false;
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+    long pageSize = ::sysconf(_SC_PAGESIZE);
+    for (int event = 0; event < EVENT_COUNT; ++event) {
+        if (pages_[event]) ::munmap(pages_[event], static_cast<size_t>(pageSize));
+        if (fds_[event] >= 0) ::close(fds_[event]);
+    }
+}
+
+PerfCounters::Reading PerfCounters::read() const {
+    Reading reading;
+    if (hardware() && !(rdpmc_ && readRdpmc(reading))) readGroup(reading);
+    reading.ns = steadyNs();
+    return reading;
+}
+
+bool PerfCounters::readRdpmc(Reading& reading) const {
+#if defined(__x86_64__) || defined(__i386__)
+    for (int event = 0; event < EVENT_COUNT; ++event) {
+        // Seqlock against the kernel updating the page (e.g. on migration)
+        const volatile perf_event_mmap_page* page = pages_[event];
+        uint32_t seq;
+        uint64_t count, enabled, running;
+        uint32_t index;
+        do {
+            seq = page->lock;
+            std::atomic_signal_fence(std::memory_order_acquire);
+            index   = page->index;
+            count   = static_cast<uint64_t>(page->offset);
+            enabled = page->time_enabled;
+            running = page->time_running;
+            if (index != 0) {
+                unsigned shift = 64 - page->pmc_width;
+                count += static_cast<uint64_t>(static_cast<int64_t>(rdpmc(index - 1) << shift) >> shift);
+                if (page->cap_user_time) {
+                    // Time since the page was last updated (perf_event.h)
+                    uint64_t cycles = rdtsc();
+                    uint16_t tshift = page->time_shift;
+                    uint64_t quot = cycles >> tshift;
+                    uint64_t rem  = cycles & ((uint64_t{1} << tshift) - 1);
+                    uint64_t delta = page->time_offset + quot * page->time_mult +
+                                     ((rem * page->time_mult) >> tshift);
+                    enabled += delta;
+                    running += delta;
+                }
+            }
+            std::atomic_signal_fence(std::memory_order_acquire);
+        } while (page->lock != seq);
+        // Not on the PMU right now: the kernel's group read is current
+        if (index == 0) return false;
+
+        reading.events[event] = count;
+        if (event == CYCLES) {
+            reading.enabled = enabled;
+            reading.running = running;
+        }
+    }
+    reading.counted = reading.running > 0;
+    return true;
+#else
+    (void)reading;
+    return false;
+#endif
+}
+
+bool PerfCounters::readGroup(Reading& reading) const {
+    GroupRead group;
+    if (::read(fds_[CYCLES], &group, sizeof(group)) != static_cast<ssize_t>(sizeof(group)) ||
+        group.nr != EVENT_COUNT) {
+        return false;
+    }
+    for (int event = 0; event < EVENT_COUNT; ++event) reading.events[event] = group.values[event];
+    reading.enabled = group.enabled;
+    reading.running = group.running;
+    reading.counted = group.running > 0;   // Never scheduled: the zeros mean nothing
+    return true;
+}
+
+bool PerfCounters::scaledDelta(const Reading& start, const Reading& end, std::array<uint64_t, EVENT_COUNT>& delta) {
+    if (!start.counted || !end.counted || end.running <= start.running) return false;
+    double enabled = static_cast<double>(end.enabled - start.enabled);
+    double running = static_cast<double>(end.running - start.running);
+    double scale   = enabled > running ? enabled / running : 1.0;
+    for (int event = 0; event < EVENT_COUNT; ++event) {
+        delta[event] = static_cast<uint64_t>(static_cast<double>(end.events[event] - start.events[event]) * scale);
+    }
+    return true;
+}
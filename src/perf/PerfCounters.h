@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+struct perf_event_mmap_page;
+
+/// Hardware performance counters of the calling thread (Linux perf_event).
+///
+/// Cycles, instructions, cache misses and branch misses are opened as one
+/// group (scheduled onto the PMU together), user space only, so they work
+/// with the default perf_event_paranoid of 2. Each counter's page is
+/// mapped; where the kernel allows user-space rdpmc (x86, cap_user_rdpmc)
+/// a read is a few instructions and no syscall, otherwise it is one read()
+/// of the whole group (PERF_FORMAT_GROUP). Without a PMU (many VMs) or
+/// permission, hardware() is false, error() says why and readings carry
+/// the clock only.
+///
+/// With more groups than the PMU has counters the kernel multiplexes them:
+/// a reading then also carries how long the group was enabled and how long
+/// it actually ran, and differences are scaled by enabled / running. A
+/// group that has not run at all yields a reading with counted = false,
+/// never a count of zero.
+///
+/// One instance per thread (thisThread()); not shareable across threads,
+/// since the counters count the thread that opened them.
+class PerfCounters {
+public:
+    enum Event { CYCLES, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, EVENT_COUNT };
+
+    static const char* eventName(int event);
+
+    struct Reading {
+        std::array<uint64_t, EVENT_COUNT> events{};   // Raw counts (valid if counted)
+        uint64_t enabled = 0;                         // ns the group was enabled ...
+        uint64_t running = 0;                         // ... and on the PMU
+        bool     counted = false;                     // Read, and the group has run
+        uint64_t ns = 0;                              // steady_clock
+    };
+
+    /// Counts of `event` between two counted readings, scaled up for the
+    /// time the group was multiplexed out. False if either reading is not
+    /// counted or the group did not run in between.
+    static bool scaledDelta(const Reading& start, const Reading& end, std::array<uint64_t, EVENT_COUNT>& delta);
+
+    /// The calling thread's counters, opened on its first call.
+    static PerfCounters& thisThread();
+
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool               hardware() const { return fds_[CYCLES] >= 0; }
+    bool               usingRdpmc() const { return rdpmc_; }
+    const std::string& error() const { return error_; }
+
+    /// "rdpmc", "read()" or "unavailable".
+    const char* method() const { return !hardware() ? "unavailable" : rdpmc_ ? "rdpmc" : "read()"; }
+
+    Reading read() const;
+
+private:
+    PerfCounters();
+
+    /// rdpmc all counters; false if one is not on the PMU right now.
+    bool readRdpmc(Reading& reading) const;
+    /// One read() of the group.
+    bool readGroup(Reading& reading) const;
+
+    std::array<int, EVENT_COUNT>                   fds_;
+    std::array<perf_event_mmap_page*, EVENT_COUNT> pages_{};
+    bool                                           rdpmc_ = false;
+    std::string                                    error_;
+};
@@ -0,0 +1,350 @@
+#include "perf/SamplingProfiler.h"
+#include "perf/StageCounters.h"
+#include "config/ConfigFile.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <filesystem>
+#include <fstream>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+/// How often the exporter drains the ring (well before it can fill).
+static constexpr auto DRAIN_INTERVAL = std::chrono::milliseconds(100);
+
+/// Signals sent to the starting thread to time delivery + sigreturn.
+static constexpr int CALIBRATION_SIGNALS = 2000;
+
+std::atomic<SamplingProfiler*> SamplingProfiler::active_{nullptr};
+
+/// The registered thread's stack, [low, high): frame pointers outside it
+/// end the walk. Zero (not registered) records the interrupted PC only.
+struct StackBounds {
+    uintptr_t low  = 0;
+    uintptr_t high = 0;
+};
+static thread_local StackBounds stackBounds;
+
+/// Set while start() times signal delivery: the handler returns at once.
+static thread_local volatile sig_atomic_t calibrating = 0;
+
+/// Where the signal interrupted the thread and its frame pointer (zeros if
+/// unknown on this architecture).
+static void interruptedFrame(void* context, uintptr_t& pc, uintptr_t& fp) {
+    auto* uc = static_cast<ucontext_t*>(context);
+#if defined(__x86_64__)
+    pc = static_cast<uintptr_t>(uc->uc_mcontext.gregs[REG_RIP]);
+    fp = static_cast<uintptr_t>(uc->uc_mcontext.gregs[REG_RBP]);
+#elif defined(__aarch64__)
+    pc = static_cast<uintptr_t>(uc->uc_mcontext.pc);
+    fp = static_cast<uintptr_t>(uc->uc_mcontext.regs[29]);
+#else
+    (void)uc;
+    pc = 0;
+    fp = 0;
+#endif
+}
+
+/// Walk the frame-pointer chain from `fp`: each frame holds the caller's
+/// frame pointer, then the return address. Stops at MAX_DEPTH frames, at a
+/// pointer outside the stack or misaligned, or one that does not move
+/// toward the stack base (a corrupt or foreign chain). Returns the depth.
+static int walkFrames(uintptr_t pc, uintptr_t fp, void** frames, int maxDepth) {
+    if (pc == 0) return 0;
+    frames[0] = reinterpret_cast<void*>(pc);
+    int depth = 1;
+    const StackBounds& bounds = stackBounds;
+    while (depth < maxDepth && fp >= bounds.low && fp % alignof(uintptr_t) == 0 &&
+           fp + 2 * sizeof(uintptr_t) <= bounds.high) {
+        const auto* frame = reinterpret_cast<const uintptr_t*>(fp);
+        uintptr_t next    = frame[0];
+        uintptr_t ret     = frame[1];
+        if (ret == 0) break;
+        frames[depth++] = reinterpret_cast<void*>(ret);
+        if (next <= fp) break;
+        fp = next;
+    }
+    return depth;
+}
+
+static uint64_t clockNs(clockid_t clock) {
+    timespec ts;
+    ::clock_gettime(clock, &ts);   // Async-signal-safe
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+SamplingProfiler::Options SamplingProfiler::optionsFrom(const ConfigFile& config) {
+    Options options;
+    options.hz       = static_cast<int>(std::clamp(config.getInt("profiler.hz", 0), 0LL, 10000LL));
+    options.output   = config.getString("profiler.output", "profile.folded");
+    options.exportMs = static_cast<int>(std::max(config.getInt("profiler.export_ms", 5000), 100LL));
+    return options;
+}
+
+SamplingProfiler::SamplingProfiler(Options options)
+    : options_(std::move(options))
+    , slots_(new Slot[RING_SLOTS])
+{
+    for (size_t i = 0; i < RING_SLOTS; ++i) slots_[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+SamplingProfiler::~SamplingProfiler() {
+    stop();
+}
+
+bool SamplingProfiler::start(std::string& error) {
+    if (started_) return true;
+    stopping_ = false;
+    if (options_.hz <= 0) {
+        error = "profiler.hz is 0";
+        return false;
+    }
+    SamplingProfiler* expected = nullptr;
+    if (!active_.compare_exchange_strong(expected, this)) {
+        error = "another profiler is running";
+        return false;
+    }
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_sigaction = &SamplingProfiler::onSignal;
+    action.sa_flags     = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (::sigaction(SIGPROF, &action, nullptr) != 0) {
+        error = std::string("sigaction(SIGPROF): ") + std::strerror(errno);
+        active_.store(nullptr);
+        return false;
+    }
+
+    signalNs_ = calibrateSignalNs();
+    started_ = true;
+    thread_ = std::thread(&SamplingProfiler::run, this);
+    return true;
+}
+
+uint64_t SamplingProfiler::calibrateSignalNs() {
+    // tgkill to ourselves is delivered on the way out of the syscall; take
+    // away the cost of a plain syscall to keep delivery + sigreturn
+    pid_t pid = ::getpid();
+    pid_t tid = static_cast<pid_t>(::syscall(SYS_gettid));
+    calibrating = 1;
+    uint64_t start = clockNs(CLOCK_THREAD_CPUTIME_ID);
+    for (int i = 0; i < CALIBRATION_SIGNALS; ++i) ::syscall(SYS_tgkill, pid, tid, SIGPROF);
+    uint64_t signalled = clockNs(CLOCK_THREAD_CPUTIME_ID) - start;
+    calibrating = 0;
+
+    start = clockNs(CLOCK_THREAD_CPUTIME_ID);
+    for (int i = 0; i < CALIBRATION_SIGNALS; ++i) ::syscall(SYS_gettid);
+    uint64_t plain = clockNs(CLOCK_THREAD_CPUTIME_ID) - start;
+    return signalled > plain ? (signalled - plain) / CALIBRATION_SIGNALS : 0;
+}
+
+void SamplingProfiler::stop() {
+    if (!started_) return;
+    active_.store(nullptr);   // The handler ignores any late signal from here on
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+    started_ = false;
+}
+
+SamplingProfiler::Stats SamplingProfiler::stats() const {
+    Stats stats;
+    stats.samples = samples_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    uint64_t cpuNs = cpuNs_.load(std::memory_order_relaxed);
+    uint64_t handlerNs = handlerNs_.load(std::memory_order_relaxed);
+    uint64_t handled = stats.samples + stats.dropped;
+    stats.cpuMs     = cpuNs / 1e6;
+    stats.signalUs  = signalNs_ / 1e3;
+    stats.handlerUs = handled ? handlerNs / 1e3 / handled : 0.0;
+    if (cpuNs > 0) {
+        stats.achievedHz      = handled * 1e9 / cpuNs;
+        stats.overheadPercent = 100.0 * (handlerNs + handled * signalNs_) / cpuNs;
+    }
+    stats.requestedOverheadPercent = (stats.signalUs + stats.handlerUs) * options_.hz / 1e4;
+    return stats;
+}
+
+SamplingProfiler::ThreadRegistration::ThreadRegistration() {
+    SamplingProfiler* profiler = active_.load();
+    if (!profiler) return;
+
+    // SIGPROF to this thread, every 1/hz of this thread's CPU time
+    sigevent event;
+    std::memset(&event, 0, sizeof(event));
+    event.sigev_notify          = SIGEV_THREAD_ID;
+    event.sigev_signo           = SIGPROF;
+    event._sigev_un._tid        = static_cast<pid_t>(::syscall(SYS_gettid));
+    timer_t timer;
+    if (::timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &timer) != 0) return;
+
+    long periodNs = 1000000000L / profiler->options_.hz;
+    itimerspec spec;
+    spec.it_interval.tv_sec  = periodNs / 1000000000L;
+    spec.it_interval.tv_nsec = periodNs % 1000000000L;
+    spec.it_value            = spec.it_interval;
+
+    // Stack bounds for the handler's frame walk, before the first signal
+    pthread_attr_t attr;
+    if (::pthread_getattr_np(::pthread_self(), &attr) == 0) {
+        void*  stack = nullptr;
+        size_t size  = 0;
+        if (::pthread_attr_getstack(&attr, &stack, &size) == 0) {
+            stackBounds.low  = reinterpret_cast<uintptr_t>(stack);
+            stackBounds.high = stackBounds.low + size;
+        }
+        ::pthread_attr_destroy(&attr);
+    }
+
+    profiler_   = profiler;
+    timer_      = timer;
+    cpuStartNs_ = clockNs(CLOCK_THREAD_CPUTIME_ID);
+    if (::timer_settime(timer, 0, &spec, nullptr) != 0) {
+        ::timer_delete(timer);
+        profiler_ = nullptr;
+        timer_    = nullptr;
+        stackBounds = {};
+    }
+}
+
+SamplingProfiler::ThreadRegistration::~ThreadRegistration() {
+    if (!profiler_) return;
+    ::timer_delete(static_cast<timer_t>(timer_));
+    stackBounds = {};
+    profiler_->cpuNs_.fetch_add(clockNs(CLOCK_THREAD_CPUTIME_ID) - cpuStartNs_, std::memory_order_relaxed);
+}
+
+void SamplingProfiler::onSignal(int, siginfo_t*, void* context) {
+    if (calibrating) return;
+    int savedErrno = errno;
+    if (SamplingProfiler* profiler = active_.load(std::memory_order_acquire)) {
+        profiler->record(context);
+    }
+    errno = savedErrno;
+}
+
+void SamplingProfiler::record(void* context) {
+    uint64_t started = clockNs(CLOCK_MONOTONIC);
+
+    // Claim a free slot (bounded MPMC ring, producers never wait)
+    uint64_t position = head_.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+        slot = &slots_[position % RING_SLOTS];
+        uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        if (sequence == position) {
+            if (head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+        } else if (sequence < position) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);   // Full: exporter behind
+            handlerNs_.fetch_add(clockNs(CLOCK_MONOTONIC) - started, std::memory_order_relaxed);
+            return;
+        } else {
+            position = head_.load(std::memory_order_relaxed);
+        }
+    }
+
+    uintptr_t pc, fp;
+    interruptedFrame(context, pc, fp);
+    slot->stage = StageCounters::currentStage();
+    slot->depth = walkFrames(pc, fp, slot->frames, MAX_DEPTH);
+    slot->sequence.store(position + 1, std::memory_order_release);
+
+    samples_.fetch_add(1, std::memory_order_relaxed);
+    uint64_t elapsed = clockNs(CLOCK_MONOTONIC) - started;
+    handlerNs_.fetch_add(elapsed, std::memory_order_relaxed);
+    handlerLatency_.record(std::chrono::nanoseconds(elapsed));
+}
+
+void SamplingProfiler::run() {
+    auto nextExport = std::chrono::steady_clock::now() + std::chrono::milliseconds(options_.exportMs);
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        cv_.wait_for(lock, DRAIN_INTERVAL, [this] { return stopping_; });
+        lock.unlock();
+        drain();
+        if (std::chrono::steady_clock::now() >= nextExport) {
+            exportFolded();
+            nextExport = std::chrono::steady_clock::now() + std::chrono::milliseconds(options_.exportMs);
+        }
+        lock.lock();
+    }
+    lock.unlock();
+    drain();
+    exportFolded();
+}
+
+void SamplingProfiler::drain() {
+    std::string stack;
+    while (true) {
+        Slot& slot = slots_[tail_ % RING_SLOTS];
+        if (slot.sequence.load(std::memory_order_acquire) != tail_ + 1) break;   // Not written yet
+
+        int stage = slot.stage;
+        stack = stage >= 0 ? StageCounters::stageName(static_cast<PipelineStage>(stage)) : "other";
+        // Root first: the walk is innermost first. Above the interrupted PC
+        // the frames are return addresses; look up the call instruction instead
+        for (int i = slot.depth - 1; i >= 0; --i) {
+            stack += ';';
+            stack += frameName(static_cast<char*>(slot.frames[i]) - (i > 0 ? 1 : 0));
+        }
+        ++stacks_[stack];
+
+        slot.sequence.store(tail_ + RING_SLOTS, std::memory_order_release);
+        ++tail_;
+    }
+}
+
+std::string SamplingProfiler::frameName(void* address) {
+    auto cached = symbols_.find(address);
+    if (cached != symbols_.end()) return cached->second;
+
+    std::string name;
+    Dl_info info{};
+    if (::dladdr(address, &info) == 0) {
+        name = "??";   // In no loaded module
+    } else if (info.dli_sname) {
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        name = status == 0 && demangled ? demangled : info.dli_sname;
+        std::free(demangled);
+    } else if (info.dli_fname) {
+        char offset[32];
+        std::snprintf(offset, sizeof(offset), "+0x%zx",
+                      static_cast<size_t>(static_cast<char*>(address) - static_cast<char*>(info.dli_fbase)));
+        name = fs::path(info.dli_fname).filename().string() + offset;
+    } else {
+        name = "??";
+    }
+    // ';' separates frames in the folded format
+    std::replace(name.begin(), name.end(), ';', ':');
+    symbols_.emplace(address, name);
+    return name;
+}
+
+void SamplingProfiler::exportFolded() {
+    // Write aside and rename, so readers never see a half-written profile
+    std::string temp = options_.output + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::trunc);
+        if (!out) return;
+        for (const auto& [stack, count] : stacks_) out << stack << ' ' << count << '\n';
+        if (!out) return;
+    }
+    std::error_code ec;
+    fs::rename(temp, options_.output, ec);
+}
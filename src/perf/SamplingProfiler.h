@@ -0,0 +1,150 @@
+#pragma once
+
+#include "processor/LatencyHistogram.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+class ConfigFile;
+
+/// Built-in CPU sampling profiler for the processor's threads (Linux).
+///
+/// Threads opt in with a ThreadRegistration (workers and reactor loops do).
+/// Each registered thread gets a timer on its own CPU clock that sends it
+/// SIGPROF every 1/hz of CPU time, so an idle thread is not sampled. The
+/// handler stores the thread's pipeline stage (StageCounters::currentStage)
+/// and the interrupted stack into a fixed lock-free ring. The stack is a
+/// bounded walk of the frame-pointer chain from the interrupted registers
+/// (the build keeps frame pointers), each frame checked against the
+/// thread's stack bounds taken at registration. The handler does not
+/// allocate and takes no lock, which backtrace() could not promise (the
+/// unwinder locks the loader's module list). A full ring drops the sample
+/// and counts it. Frames of code built without frame pointers (parts of
+/// libc) may be skipped or end the walk early.
+///
+/// A background thread drains the ring, symbolizes the stacks (dladdr +
+/// demangling, cached per address) and rewrites `output` every exportMs in
+/// folded-stack format, one "stage;outer;...;inner count" line per stack,
+/// ready for flamegraph.pl or speedscope. Function names need the symbols
+/// exported (-rdynamic); otherwise frames show as "module+0xoffset".
+///
+/// stats() reports the profiler's overhead on the workers as a share of
+/// their CPU time while registered. A sample costs the signal delivery and
+/// sigreturn (measured once at start(), by signalling the starting thread)
+/// plus the handler (timed per sample). The overhead is given both at the
+/// rate achieved and at the requested `hz`: CPU-clock timers expire on the
+/// kernel tick, so the real rate is at most CONFIG_HZ per thread whatever
+/// `hz` asks for.
+class SamplingProfiler {
+public:
+    struct Options {
+        int         hz       = 0;                  // profiler.hz: samples per CPU second per thread (0 = off)
+        std::string output   = "profile.folded";   // profiler.output
+        int         exportMs = 5000;               // profiler.export_ms
+    };
+
+    /// profiler.hz, profiler.output, profiler.export_ms.
+    static Options optionsFrom(const ConfigFile& config);
+
+    struct Stats {
+        uint64_t samples   = 0;
+        uint64_t dropped   = 0;       // Ring full
+        double   cpuMs     = 0.0;     // CPU time of registered threads (finished ones)
+        double   achievedHz = 0.0;    // Samples per CPU second
+        double   signalUs  = 0.0;     // Delivery + sigreturn per sample (calibrated)
+        double   handlerUs = 0.0;     // Handler per sample (mean)
+        double   overheadPercent = 0.0;            // Cost of the samples taken / cpuMs
+        double   requestedOverheadPercent = 0.0;   // Per-sample cost x hz
+    };
+
+    explicit SamplingProfiler(Options options);
+    ~SamplingProfiler();
+
+    SamplingProfiler(const SamplingProfiler&) = delete;
+    SamplingProfiler& operator=(const SamplingProfiler&) = delete;
+
+    /// Install the SIGPROF handler and start exporting. Threads registered
+    /// from now on are sampled. One profiler may run at a time.
+    bool start(std::string& error);
+
+    /// Stop sampling, export a last time and join the exporter. The handler
+    /// stays installed and ignores signals from timers still running, but
+    /// registered threads should have finished before the profiler is
+    /// destroyed.
+    void stop();
+
+    Stats stats() const;
+    const Options& options() const { return options_; }
+
+    /// Time spent in the signal handler, per sample.
+    const LatencyHistogram& handlerLatency() const { return handlerLatency_; }
+
+    /// Samples the calling thread from construction to destruction, if a
+    /// profiler is running; otherwise does nothing.
+    class ThreadRegistration {
+    public:
+        ThreadRegistration();
+        ~ThreadRegistration();
+
+        ThreadRegistration(const ThreadRegistration&) = delete;
+        ThreadRegistration& operator=(const ThreadRegistration&) = delete;
+
+    private:
+        SamplingProfiler* profiler_ = nullptr;
+        void*             timer_    = nullptr;   // timer_t
+        uint64_t          cpuStartNs_ = 0;
+    };
+
+private:
+    static constexpr int    MAX_DEPTH  = 32;
+    static constexpr size_t RING_SLOTS = 4096;
+
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};   // Vyukov ring: free when == position
+        int                   stage = -1;
+        int                   depth = 0;
+        void*                 frames[MAX_DEPTH];   // Interrupted PC, then return addresses
+    };
+
+    static void onSignal(int signal, siginfo_t* info, void* context);
+    void        record(void* context);
+
+    /// Cost of delivering SIGPROF to this thread and returning from it,
+    /// without the handler's work.
+    static uint64_t calibrateSignalNs();
+
+    void        run();
+    void        drain();
+    void        exportFolded();
+    std::string frameName(void* address);
+
+    Options options_;
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<uint64_t>   head_{0};      // Next position to write (handlers)
+    uint64_t                tail_ = 0;     // Next position to read (exporter)
+
+    std::atomic<uint64_t> samples_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> handlerNs_{0};
+    std::atomic<uint64_t> cpuNs_{0};
+    uint64_t              signalNs_ = 0;   // calibrateSignalNs() at start()
+    LatencyHistogram      handlerLatency_;
+
+    std::unordered_map<std::string, uint64_t> stacks_;   // Folded stack -> samples
+    std::unordered_map<void*, std::string>    symbols_;  // Frame address -> name
+
+    bool                    started_  = false;
+    std::mutex              mutex_;
+    std::condition_variable cv_;
+    bool                    stopping_ = false;
+    std::thread             thread_;
+
+    static std::atomic<SamplingProfiler*> active_;
+};
@@ -0,0 +1,99 @@
+#include "perf/StageCounters.h"
+
+#include <iomanip>
+
+thread_local volatile sig_atomic_t StageCounters::current_ = -1;
+
+const char* StageCounters::stageName(PipelineStage stage) {
+    switch (stage) {
+        case PipelineStage::VALIDATE: return "validate";
+        case PipelineStage::EXECUTE:  return "execute";
+        case PipelineStage::FLUSH:    return "flush";
+    }
+    return "?";
+}
+
+void StageCounters::add(PipelineStage stage, const PerfCounters::Reading& start, const PerfCounters::Reading& end,
+                        uint64_t items) {
+    Totals& totals = stages_[static_cast<int>(stage)];
+    totals.items.fetch_add(items, std::memory_order_relaxed);
+    totals.ns.fetch_add(end.ns - start.ns, std::memory_order_relaxed);
+    const PerfCounters& counters = PerfCounters::thisThread();
+    if (!counters.hardware()) return;
+
+    std::array<uint64_t, PerfCounters::EVENT_COUNT> delta;
+    if (!PerfCounters::scaledDelta(start, end, delta)) {
+        // The group never got on the PMU during the stage: no counts at all
+        uncounted_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (end.enabled - start.enabled > end.running - start.running) {
+        multiplexed_.store(true, std::memory_order_relaxed);
+    }
+    totals.countedItems.fetch_add(items, std::memory_order_relaxed);
+    for (int event = 0; event < PerfCounters::EVENT_COUNT; ++event) {
+        totals.events[event].fetch_add(delta[event], std::memory_order_relaxed);
+    }
+    if (!hardware_.load(std::memory_order_relaxed)) {
+        rdpmc_.store(counters.usingRdpmc(), std::memory_order_relaxed);
+        hardware_.store(true, std::memory_order_relaxed);
+    }
+}
+
+std::string StageCounters::source() const {
+    if (hardware_.load(std::memory_order_relaxed)) {
+        std::string source = rdpmc_.load(std::memory_order_relaxed) ? "hardware counters via rdpmc"
+                                                                    : "hardware counters via read()";
+        if (multiplexed_.load(std::memory_order_relaxed)) source += ", multiplexed (scaled)";
+        if (uint64_t uncounted = uncounted_.load(std::memory_order_relaxed)) {
+            source += ", " + std::to_string(uncounted) + " stages never scheduled (not counted)";
+        }
+        return source;
+    }
+    if (uint64_t uncounted = uncounted_.load(std::memory_order_relaxed)) {
+        return "hardware counters never scheduled (" + std::to_string(uncounted) + " stages), time only";
+    }
+    // Nothing counted: ask this thread why (the workers see the same PMU)
+    const PerfCounters& counters = PerfCounters::thisThread();
+    if (counters.hardware()) return "hardware counters (no stage recorded yet)";
+    return "hardware counters unavailable (" + counters.error() + "), time only";
+}
+
+void StageCounters::print(std::ostream& out) const {
+    const bool hardware = hardware_.load(std::memory_order_relaxed);
+
+    out << "\n  Pipeline Stages (per request, " << source() << "):\n"
+        << "  " << std::left << std::setw(10) << "Stage" << std::right
+        << std::setw(10) << "Requests" << std::setw(10) << "ns";
+    if (hardware) {
+        out << std::setw(10) << "Cycles" << std::setw(10) << "Instr" << std::setw(7) << "IPC"
+            << std::setw(10) << "CacheMiss" << std::setw(10) << "BrMiss";
+    }
+    out << "\n  " << std::string(hardware ? 77 : 30, '-') << "\n";
+
+    for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+        const Totals& totals = stages_[stage];
+        uint64_t items = totals.items.load(std::memory_order_relaxed);
+        if (items == 0) continue;
+
+        auto perItem = [items](const std::atomic<uint64_t>& total) {
+            return static_cast<double>(total.load(std::memory_order_relaxed)) / items;
+        };
+        // Events are averaged over the requests of stages that were counted
+        uint64_t counted = totals.countedItems.load(std::memory_order_relaxed);
+        auto perCounted = [counted](const std::atomic<uint64_t>& total) {
+            return counted ? static_cast<double>(total.load(std::memory_order_relaxed)) / counted : 0.0;
+        };
+        out << "  " << std::left << std::setw(10) << stageName(static_cast<PipelineStage>(stage)) << std::right
+            << std::setw(10) << items << std::fixed << std::setprecision(0) << std::setw(10) << perItem(totals.ns);
+        if (hardware) {
+            double cycles       = perCounted(totals.events[PerfCounters::CYCLES]);
+            double instructions = perCounted(totals.events[PerfCounters::INSTRUCTIONS]);
+            out << std::setw(10) << cycles << std::setw(10) << instructions
+                << std::setprecision(2) << std::setw(7) << (cycles > 0 ? instructions / cycles : 0.0)
+                << std::setw(10) << perCounted(totals.events[PerfCounters::CACHE_MISSES])
+                << std::setw(10) << perCounted(totals.events[PerfCounters::BRANCH_MISSES]);
+        }
+        out << "\n";
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "perf/PerfCounters.h"
+
+#include <array>
+#include <atomic>
+#include <csignal>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/// Stages of the processor's request pipeline, as instrumented.
+enum class PipelineStage {
+    VALIDATE,    // Built-in checks, rules, calendar, duplicate set
+    EXECUTE,     // Broker call(s), retries and outcome logging
+    FLUSH        // Tracker record + result callbacks / hand-off
+};
+
+/// Per-stage totals of the hardware counters (see PerfCounters), summed
+/// over all worker threads.
+///
+/// Opt-in (processor.perf_counters): disabled, a Scope only tags the
+/// thread with its stage (for SamplingProfiler) and costs one branch.
+/// Enabled, a Scope reads the thread's counters on entry and exit and adds
+/// the difference - a handful of rdpmc instructions per stage, or one
+/// group read() where rdpmc is not allowed. Differences are scaled for
+/// multiplexing; a stage during which the counter group never ran is left
+/// out of the event averages and counted apart. Without hardware counters
+/// only the time per stage is kept.
+class StageCounters {
+public:
+    static constexpr int STAGE_COUNT = 3;
+
+    static const char* stageName(PipelineStage stage);
+
+    /// The calling thread's innermost stage, or -1 outside any Scope. Safe to
+    /// read from a signal handler on that thread.
+    static int currentStage() { return current_; }
+
+    explicit StageCounters(bool enabled = false) : enabled_(enabled) {}
+
+    bool enabled() const { return enabled_; }
+
+    /// Counts one stage of `items` requests (a validation batch, a flushed
+    /// result batch) from construction to destruction.
+    class Scope {
+    public:
+        Scope(StageCounters& counters, PipelineStage stage, uint64_t items = 1)
+            : counters_(counters.enabled_ ? &counters : nullptr)
+            , stage_(stage)
+            , items_(items)
+            , previous_(current_)
+        {
+            current_ = static_cast<int>(stage);
+            if (counters_) start_ = PerfCounters::thisThread().read();
+        }
+
+        ~Scope() {
+            if (counters_) counters_->add(stage_, start_, PerfCounters::thisThread().read(), items_);
+            current_ = previous_;
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        /// Requests the stage turned out to cover (e.g. 0 for a reactor
+        /// event that did not finish its request).
+        void setItems(uint64_t items) { items_ = items; }
+
+    private:
+        StageCounters*        counters_;   // nullptr when disabled
+        PipelineStage         stage_;
+        uint64_t              items_;
+        int                   previous_;   // Enclosing stage (scopes nest, e.g. a flush inside execute)
+        PerfCounters::Reading start_;
+    };
+
+    void add(PipelineStage stage, const PerfCounters::Reading& start, const PerfCounters::Reading& end,
+             uint64_t items);
+
+    /// Where the numbers come from, e.g. "hardware counters via rdpmc" or
+    /// "hardware counters unavailable (perf_event_open(cycles): ...), time only".
+    std::string source() const;
+
+    /// Per-request averages for each stage (cycles, instructions, IPC,
+    /// cache and branch misses, ns).
+    void print(std::ostream& out) const;
+
+private:
+    static thread_local volatile sig_atomic_t current_;
+
+    struct Totals {
+        std::atomic<uint64_t> items{0};
+        std::atomic<uint64_t> countedItems{0};   // Items of stages with event counts
+        std::atomic<uint64_t> ns{0};
+        std::array<std::atomic<uint64_t>, PerfCounters::EVENT_COUNT> events{};
+    };
+
+    bool                              enabled_;
+    std::array<Totals, STAGE_COUNT>   stages_;
+    std::atomic<bool>                 hardware_{false};   // Some thread had counters
+    std::atomic<bool>                 rdpmc_{false};      // ... read with rdpmc
+    std::atomic<bool>                 multiplexed_{false};   // Some stage was scaled up
+    std::atomic<uint64_t>             uncounted_{0};      // Stages the group never ran in
+};
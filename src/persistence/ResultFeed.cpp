@@ -0,0 +1,538 @@
+#include "persistence/ResultFeed.h"
+#include "persistence/StateFormat.h"
+
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <chrono>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+static constexpr char     FEED_MAGIC[8] = {'M', 'T', '5', 'F', 'E', 'E', 'D', '1'};
+static constexpr uint32_t FEED_VERSION  = 1;
+static constexpr const char* SEGMENT_PREFIX = "feed.";
+static constexpr const char* SEGMENT_SUFFIX = ".seg";
+static constexpr const char* SPARE_NAME     = "feed.spare";
+
+/// How soon a spare that could not be created is retried.
+static constexpr auto SPARE_RETRY = std::chrono::seconds(1);
+
+static uint64_t recordStride(uint32_t length) {
+    return (sizeof(FeedRecordHeader) + length + 7) & ~uint64_t{7};
+}
+
+static uint32_t recordChecksum(uint64_t sequence, const char* payload, uint32_t length) {
+    return static_cast<uint32_t>(stateChecksum(payload, length, stateChecksum(&sequence, sizeof(sequence))));
+}
+
+/// Set the sealed flag of the segment file at `path`.
+static void sealSegment(const std::string& path) {
+    int fd = ::open(path.c_str(), O_WRONLY);
+    if (fd < 0) return;
+    uint32_t sealed = 1;
+    ::pwrite(fd, &sealed, sizeof(sealed), offsetof(FeedSegmentHeader, sealed));
+    ::close(fd);
+}
+
+/// Header checks shared by producer and consumers.
+static bool validSegment(const FeedSegmentHeader& h, size_t fileBytes) {
+    return std::memcmp(h.magic, FEED_MAGIC, sizeof(FEED_MAGIC)) == 0 && h.version == FEED_VERSION &&
+           h.headerSize == sizeof(FeedSegmentHeader) && FEED_DATA_OFFSET + h.capacity <= fileBytes &&
+           h.committed <= h.capacity;
+}
+
+// ---------------------------------------------------------------------------
+// ResultFeed (producer)
+// ---------------------------------------------------------------------------
+
+ResultFeed::Options ResultFeed::optionsFrom(const ConfigFile& config) {
+    Options options;
+    options.segmentBytes   = static_cast<uint64_t>(std::max(64LL, config.getInt("feed.segment_kb", 4096))) * 1024;
+    options.retainSegments = static_cast<size_t>(std::max(0LL, config.getInt("feed.retain_segments", 16)));
+    return options;
+}
+
+ResultFeed::ResultFeed(std::string directory, Options options)
+    : directory_(std::move(directory))
+    , options_(options)
+{
+}
+
+ResultFeed::~ResultFeed() {
+    stopRotation();
+    unmap();
+}
+
+void ResultFeed::unmap() {
+    if (mapping_) ::munmap(mapping_, mappedBytes_);
+    mapping_ = nullptr;
+    header_  = nullptr;
+}
+
+std::string ResultFeed::segmentPath(const std::string& directory, uint64_t firstSequence) {
+    char name[48];
+    std::snprintf(name, sizeof(name), "%s%020llu%s", SEGMENT_PREFIX,
+                  static_cast<unsigned long long>(firstSequence), SEGMENT_SUFFIX);
+    return (fs::path(directory) / name).string();
+}
+
+std::string ResultFeed::sparePath() const {
+    return (fs::path(directory_) / SPARE_NAME).string();
+}
+
+std::vector<uint64_t> ResultFeed::listSegments(const std::string& directory) {
+    std::vector<uint64_t> segments;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        std::string name = entry.path().filename().string();
+        size_t prefix = std::char_traits<char>::length(SEGMENT_PREFIX);
+        size_t suffix = std::char_traits<char>::length(SEGMENT_SUFFIX);
+        if (name.size() <= prefix + suffix || name.compare(0, prefix, SEGMENT_PREFIX) != 0 ||
+            name.compare(name.size() - suffix, suffix, SEGMENT_SUFFIX) != 0) {
+            continue;
+        }
+        std::string digits = name.substr(prefix, name.size() - prefix - suffix);
+        if (std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            segments.push_back(std::stoull(digits));
+        }
+    }
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+void ResultFeed::recoverSpare() {
+    // A spare the producer had switched to (first sequence set) holds
+    // committed records that never got their name: publish it and seal its
+    // predecessor. An unused spare is just removed.
+    std::string spare = sparePath();
+    int fd = ::open(spare.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    FeedSegmentHeader header;
+    struct stat st;
+    bool used = ::pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                ::fstat(fd, &st) == 0 && validSegment(header, static_cast<size_t>(st.st_size)) &&
+                header.firstSequence != 0;
+    ::close(fd);
+    if (!used) {
+        std::remove(spare.c_str());
+        return;
+    }
+
+    auto segments = listSegments(directory_);
+    auto previous = std::lower_bound(segments.begin(), segments.end(), header.firstSequence);
+    if (previous != segments.begin()) sealSegment(segmentPath(directory_, *std::prev(previous)));
+    std::rename(spare.c_str(), segmentPath(directory_, header.firstSequence).c_str());
+}
+
+bool ResultFeed::open(std::string& error) {
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+    recoverSpare();
+
+    // A successor is named before its predecessor is sealed; a crash in
+    // between leaves an unsealed segment that is not the newest, and
+    // consumers would wait on it forever
+    auto segments = listSegments(directory_);
+    for (size_t i = 0; i + 1 < segments.size(); ++i) {
+        FeedSegmentHeader header;
+        std::string path = segmentPath(directory_, segments[i]);
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) continue;
+        bool unsealed = ::pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                        header.sealed == 0;
+        ::close(fd);
+        if (unsealed) sealSegment(path);
+    }
+
+    bool opened = false;
+    if (segments.empty()) {
+        opened = createSegment(1, error);
+    } else {
+        // Continue the newest segment after its last committed record
+        uint64_t first = segments.back();
+        std::string path = segmentPath(directory_, first);
+        int fd = ::open(path.c_str(), O_RDWR);
+        struct stat st;
+        if (fd < 0 || ::fstat(fd, &st) != 0) {
+            if (fd >= 0) ::close(fd);
+            error = "cannot open " + path;
+            return false;
+        }
+        void* mapping = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            error = "cannot map " + path;
+            return false;
+        }
+        mapping_     = static_cast<char*>(mapping);
+        mappedBytes_ = static_cast<size_t>(st.st_size);
+        header_      = reinterpret_cast<FeedSegmentHeader*>(mapping_);
+
+        if (mappedBytes_ < FEED_DATA_OFFSET || !validSegment(*header_, mappedBytes_)) {
+            // Unreadable: set it aside and start a fresh segment at its position
+            unmap();
+            std::rename(path.c_str(), (path + ".corrupt").c_str());
+            opened = createSegment(first, error);
+        } else {
+            nextSequence_ = header_->firstSequence;
+            uint64_t committed = __atomic_load_n(&header_->committed, __ATOMIC_ACQUIRE);
+            for (uint64_t offset = 0; offset + sizeof(FeedRecordHeader) <= committed; ) {
+                FeedRecordHeader record;
+                std::memcpy(&record, mapping_ + FEED_DATA_OFFSET + offset, sizeof(record));
+                nextSequence_ = record.sequence + 1;
+                offset += recordStride(record.length);
+            }
+            opened = header_->sealed ? createSegment(nextSequence_, error) : true;
+        }
+    }
+
+    if (opened && !rotator_.joinable()) {
+        stopping_ = false;
+        rotator_ = std::thread(&ResultFeed::rotationLoop, this);
+    }
+    return opened;
+}
+
+bool ResultFeed::mapNewFile(const std::string& path, uint64_t firstSequence, Mapping& mapping, std::string& error) {
+    size_t bytes = static_cast<size_t>(FEED_DATA_OFFSET + options_.segmentBytes);
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0 || ::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        if (fd >= 0) ::close(fd);
+        std::remove(path.c_str());
+        error = "cannot create " + path;
+        return false;
+    }
+    void* data = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        std::remove(path.c_str());
+        error = "cannot map " + path;
+        return false;
+    }
+
+    auto* header = static_cast<FeedSegmentHeader*>(data);
+    std::memcpy(header->magic, FEED_MAGIC, sizeof(FEED_MAGIC));
+    header->version       = FEED_VERSION;
+    header->headerSize    = sizeof(FeedSegmentHeader);
+    header->firstSequence = firstSequence;
+    header->capacity      = options_.segmentBytes;
+    header->committed     = 0;
+    header->sealed        = 0;
+    mapping = {static_cast<char*>(data), bytes};
+    return true;
+}
+
+bool ResultFeed::createSegment(uint64_t firstSequence, std::string& error) {
+    std::string path = segmentPath(directory_, firstSequence);
+    std::string temp = path + ".tmp";
+    Mapping mapping;
+    if (!mapNewFile(temp, firstSequence, mapping, error)) return false;
+
+    // Consumers only ever see fully initialized segments
+    if (std::rename(temp.c_str(), path.c_str()) != 0) {
+        ::munmap(mapping.data, mapping.bytes);
+        std::remove(temp.c_str());
+        error = "cannot create " + path;
+        return false;
+    }
+
+    // Seal the previous segment once its successor exists
+    if (header_) __atomic_store_n(&header_->sealed, 1u, __ATOMIC_RELEASE);
+    unmap();
+    mapping_     = mapping.data;
+    mappedBytes_ = mapping.bytes;
+    header_      = reinterpret_cast<FeedSegmentHeader*>(mapping.data);
+    pruneSegments();
+    return true;
+}
+
+void ResultFeed::pruneSegments() {
+    if (options_.retainSegments == 0) return;
+    auto segments = listSegments(directory_);
+    for (size_t i = 0; i + options_.retainSegments < segments.size(); ++i) {
+        std::remove(segmentPath(directory_, segments[i]).c_str());
+    }
+}
+
+bool ResultFeed::rollOver() {
+    Mapping spare;
+    {
+        // Held only for queue operations: the thread does its file work unlocked
+        std::lock_guard<std::mutex> lock(rotateMutex_);
+        spare = spare_;
+        spare_ = {};
+        if (spare.data) {
+            // Numbered before the thread can publish it under its final name
+            reinterpret_cast<FeedSegmentHeader*>(spare.data)->firstSequence = nextSequence_;
+            handoffs_.push_back({{mapping_, mappedBytes_}, nextSequence_});
+        }
+    }
+    rotateCv_.notify_one();
+    if (!spare.data) {
+        // Filled faster than the spare could be made (or it cannot be):
+        // never wait or do file I/O on the caller's path; append() drops
+        // and counts the record
+        return false;
+    }
+
+    mapping_     = spare.data;
+    mappedBytes_ = spare.bytes;
+    header_      = reinterpret_cast<FeedSegmentHeader*>(spare.data);
+    return true;
+}
+
+void ResultFeed::rotationLoop() {
+    std::unique_lock<std::mutex> lock(rotateMutex_);
+    while (true) {
+        if (!handoffs_.empty()) {
+            Handoff handoff = handoffs_.front();
+            lock.unlock();
+            finishHandoff(handoff);
+            lock.lock();
+            handoffs_.pop_front();
+            continue;
+        }
+        if (stopping_) break;
+        if (!spare_.data) {
+            lock.unlock();
+            Mapping spare;
+            std::string error;
+            bool made = mapNewFile(sparePath(), 0, spare, error);
+            lock.lock();
+            if (made) {
+                spare_ = spare;
+                continue;
+            }
+            // Out of space or similar: append() drops records until a spare
+            // exists; try again later
+            rotateCv_.wait_for(lock, SPARE_RETRY);
+            continue;
+        }
+        rotateCv_.wait(lock);
+    }
+}
+
+void ResultFeed::finishHandoff(const Handoff& handoff) {
+    // Name the spare the producer switched to, then let consumers move on
+    std::rename(sparePath().c_str(), segmentPath(directory_, handoff.nextFirst).c_str());
+    auto* full = reinterpret_cast<FeedSegmentHeader*>(handoff.full.data);
+    __atomic_store_n(&full->sealed, 1u, __ATOMIC_RELEASE);
+    ::munmap(handoff.full.data, handoff.full.bytes);
+    pruneSegments();
+}
+
+void ResultFeed::stopRotation() {
+    if (!rotator_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(rotateMutex_);
+        stopping_ = true;
+    }
+    rotateCv_.notify_one();
+    rotator_.join();   // Finishes pending handoffs first
+
+    if (spare_.data) {
+        ::munmap(spare_.data, spare_.bytes);
+        spare_ = {};
+        std::remove(sparePath().c_str());
+    }
+}
+
+uint64_t ResultFeed::append(const TradeResult& result) {
+    thread_local StateArena arena;
+    arena.clear();
+    ResultRecord record = encodeResult(result, arena);
+    uint32_t length = static_cast<uint32_t>(sizeof(record) + arena.bytes().size());
+    uint64_t stride = recordStride(length);
+
+    if (!header_ || stride > options_.segmentBytes) {
+        ++dropped_;
+        return 0;
+    }
+    uint64_t committed = header_->committed;
+    if (committed + stride > header_->capacity) {
+        if (!rollOver()) {
+            ++dropped_;
+            return 0;
+        }
+        committed = 0;
+    }
+
+    uint64_t sequence = nextSequence_++;
+    char* out = mapping_ + FEED_DATA_OFFSET + committed;
+    char* payload = out + sizeof(FeedRecordHeader);
+    std::memcpy(payload, &record, sizeof(record));
+    std::memcpy(payload + sizeof(record), arena.bytes().data(), arena.bytes().size());
+    FeedRecordHeader head{length, recordChecksum(sequence, payload, length), sequence};
+    std::memcpy(out, &head, sizeof(head));
+
+    __atomic_store_n(&header_->committed, committed + stride, __ATOMIC_RELEASE);
+    return sequence;
+}
+
+// ---------------------------------------------------------------------------
+// FeedReader (consumer)
+// ---------------------------------------------------------------------------
+
+FeedReader::FeedReader(std::string directory)
+    : directory_(std::move(directory))
+{
+}
+
+FeedReader::~FeedReader() {
+    unmap();
+}
+
+void FeedReader::unmap() {
+    if (mapping_) ::munmap(const_cast<char*>(mapping_), mappedBytes_);
+    mapping_ = nullptr;
+    header_  = nullptr;
+}
+
+bool FeedReader::mapSegment(uint64_t firstSequence, std::string& error) {
+    std::string path = ResultFeed::segmentPath(directory_, firstSequence);
+    int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || ::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < FEED_DATA_OFFSET) {
+        if (fd >= 0) ::close(fd);
+        error = "cannot open " + path;
+        return false;
+    }
+    void* mapping = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        error = "cannot map " + path;
+        return false;
+    }
+    auto* header = static_cast<const FeedSegmentHeader*>(mapping);
+    if (!validSegment(*header, static_cast<size_t>(st.st_size))) {
+        ::munmap(mapping, static_cast<size_t>(st.st_size));
+        error = path + " is not a feed segment";
+        return false;
+    }
+
+    unmap();
+    mapping_     = static_cast<const char*>(mapping);
+    mappedBytes_ = static_cast<size_t>(st.st_size);
+    header_      = header;
+    offset_      = 0;
+    return true;
+}
+
+bool FeedReader::seek(uint64_t sequence, std::string& error) {
+    auto segments = ResultFeed::listSegments(directory_);
+    if (segments.empty()) {
+        error = "no feed segments in " + directory_;
+        return false;
+    }
+    sequence = std::max<uint64_t>(sequence, 1);
+    auto it = std::upper_bound(segments.begin(), segments.end(), sequence);
+    uint64_t first = it == segments.begin() ? segments.front() : *std::prev(it);
+    if (sequence < first) {
+        skipped_ += first - sequence;   // Deleted by retention
+        sequence = first;
+    }
+    if (!mapSegment(first, error)) return false;
+    cursor_ = sequence;   // poll() skips the segment's earlier records
+    return true;
+}
+
+size_t FeedReader::poll(const std::function<void(uint64_t, TradeResult&&)>& fn, size_t maxRecords) {
+    if (!header_) {
+        std::string error;
+        if (!seek(cursor_, error)) return 0;
+    }
+
+    size_t delivered = 0;
+    while (delivered < maxRecords) {
+        uint64_t committed = __atomic_load_n(&header_->committed, __ATOMIC_ACQUIRE);
+        if (offset_ >= committed) {
+            // Caught up; move on only once the producer sealed this segment
+            if (!__atomic_load_n(&header_->sealed, __ATOMIC_ACQUIRE)) break;
+            if (offset_ < __atomic_load_n(&header_->committed, __ATOMIC_ACQUIRE)) continue;
+
+            auto segments = ResultFeed::listSegments(directory_);
+            auto next = std::upper_bound(segments.begin(), segments.end(), header_->firstSequence);
+            std::string error;
+            if (next == segments.end() || !mapSegment(*next, error)) break;
+            if (header_->firstSequence > cursor_) {
+                skipped_ += header_->firstSequence - cursor_;
+                cursor_ = header_->firstSequence;
+            }
+            continue;
+        }
+
+        if (committed - offset_ < sizeof(FeedRecordHeader)) break;
+        FeedRecordHeader head;
+        const char* in = mapping_ + FEED_DATA_OFFSET + offset_;
+        std::memcpy(&head, in, sizeof(head));
+        uint64_t stride = recordStride(head.length);
+        const char* payload = in + sizeof(FeedRecordHeader);
+        if (head.length < sizeof(ResultRecord) || offset_ + stride > committed ||
+            recordChecksum(head.sequence, payload, head.length) != head.checksum) {
+            // Corrupt: resume at the next intact record (its sequence jump
+            // counts the loss in skipped_)
+            ++corrupt_;
+            offset_ = resync(offset_ + 8, committed);
+            continue;
+        }
+        offset_ += stride;
+        if (head.sequence < cursor_) continue;
+
+        ResultRecord record;
+        std::memcpy(&record, payload, sizeof(record));
+        if (!resultFits(record, head.length - sizeof(record))) continue;
+
+        skipped_ += head.sequence - cursor_;
+        cursor_ = head.sequence + 1;
+        fn(head.sequence, decodeResult(record, payload + sizeof(record)));
+        ++delivered;
+    }
+    return delivered;
+}
+
+uint64_t FeedReader::resync(uint64_t from, uint64_t committed) const {
+    // Records start on 8-byte boundaries; accept the first whose header and
+    // checksum hold up. Nothing found: skip what is committed so far (the
+    // producer appends after it).
+    for (uint64_t offset = from; offset + sizeof(FeedRecordHeader) <= committed; offset += 8) {
+        FeedRecordHeader head;
+        const char* in = mapping_ + FEED_DATA_OFFSET + offset;
+        std::memcpy(&head, in, sizeof(head));
+        if (head.length < sizeof(ResultRecord) || offset + recordStride(head.length) > committed ||
+            head.sequence < cursor_) {
+            continue;
+        }
+        if (recordChecksum(head.sequence, in + sizeof(FeedRecordHeader), head.length) == head.checksum) {
+            return offset;
+        }
+    }
+    return committed;
+}
+
+static std::string cursorPath(const std::string& directory, const std::string& name) {
+    return (fs::path(directory) / (name + ".cursor")).string();
+}
+
+std::optional<uint64_t> FeedReader::loadCursor(const std::string& directory, const std::string& name) {
+    std::ifstream in(cursorPath(directory, name));
+    uint64_t sequence;
+    if (!(in >> sequence)) return std::nullopt;
+    return sequence;
+}
+
+bool FeedReader::saveCursor(const std::string& directory, const std::string& name, uint64_t sequence) {
+    std::string path = cursorPath(directory, name);
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::trunc);
+        if (!(out << sequence << "\n")) return false;
+    }
+    return std::rename(temp.c_str(), path.c_str()) == 0;
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "models/TradeResult.h"
+#include "config/ConfigFile.h"
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <functional>
+#include <cstdint>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/// Header at the start of every feed segment; records start at
+/// FEED_DATA_OFFSET. `committed` and `sealed` are written by the producer
+/// with release stores and read by consumers with acquire loads, straight
+/// from the shared mapping.
+struct FeedSegmentHeader {
+    char     magic[8];            // "MT5FEED1"
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t firstSequence;       // Sequence of the segment's first record
+    uint64_t capacity;            // Record bytes the segment can hold
+    uint64_t committed;           // Record bytes published so far
+    uint32_t sealed;              // 1 = producer moved on to the next segment
+    uint32_t reserved;
+};
+
+/// Each record: [FeedRecordHeader][ResultRecord][strings], padded to 8 bytes.
+struct FeedRecordHeader {
+    uint32_t length;              // ResultRecord + strings
+    uint32_t checksum;            // Over sequence + payload
+    uint64_t sequence;
+};
+
+static constexpr uint64_t FEED_DATA_OFFSET = 64;
+static_assert(sizeof(FeedSegmentHeader) <= FEED_DATA_OFFSET, "feed header overlaps records");
+
+/// Change-data-capture feed of tracked results for same-host consumers
+/// (risk, back office), in the style of a local Kafka log.
+///
+/// Every result ResultTracker records is appended with the next sequence
+/// number (1, 2, ...) to a memory-mapped segment file
+/// <dir>/feed.<first sequence>.seg. Appending is a memcpy into the mapping
+/// plus a release store of the segment's committed length: no locks, no
+/// syscalls and nothing a consumer can block.
+///
+/// Rollover stays off the caller's path too: a background thread keeps the
+/// next segment created and mapped ahead of time (<dir>/feed.spare). When a
+/// segment fills, append() switches to the spare with a pointer swap; the
+/// thread then names it, seals the full segment (consumers move on only
+/// after that), unmaps it, applies retention and prepares the next spare.
+/// append() never waits for the thread: if no spare is ready (a segment
+/// filled faster than the next could be made, or the disk is full) the
+/// record is dropped and counted in dropped(), and appends resume once
+/// the spare exists. Sequence numbers stay gapless; only results are lost.
+///
+///   feed.dir             = feed    # segment directory (unset = no feed)
+///   feed.segment_kb      = 4096    # size of each segment file
+///   feed.retain_segments = 16      # oldest deleted beyond this (0 = keep all)
+///
+/// Data is in the page cache as soon as it is committed, so it survives a
+/// process crash (not a power loss); a restarted producer continues after
+/// the last committed record.
+///
+/// Not thread-safe: ResultTracker appends under its own mutex, so feed
+/// order is record order.
+class ResultFeed {
+public:
+    struct Options {
+        uint64_t segmentBytes   = 4ull << 20;
+        size_t   retainSegments = 16;
+    };
+
+    static Options optionsFrom(const ConfigFile& config);
+
+    ResultFeed(std::string directory, Options options);
+    ~ResultFeed();
+
+    ResultFeed(const ResultFeed&) = delete;
+    ResultFeed& operator=(const ResultFeed&) = delete;
+
+    /// Map the newest segment (or create the first), sealing any older
+    /// segment a crash left unsealed. Returns false and sets `error` on I/O
+    /// failure.
+    bool open(std::string& error);
+
+    /// Publish `result`; returns its sequence number (0 if it was dropped
+    /// because the segment is full and no spare is ready yet).
+    uint64_t append(const TradeResult& result);
+
+    /// Sequence the next append will get.
+    uint64_t nextSequence() const { return nextSequence_; }
+    uint64_t dropped() const { return dropped_; }
+
+    const std::string& directory() const { return directory_; }
+
+    /// First sequences of the segments in `directory`, ascending.
+    static std::vector<uint64_t> listSegments(const std::string& directory);
+    static std::string segmentPath(const std::string& directory, uint64_t firstSequence);
+
+private:
+    /// A mapped segment file.
+    struct Mapping {
+        char*  data  = nullptr;
+        size_t bytes = 0;
+    };
+
+    /// A full segment, replaced by the spare at `nextFirst`, for the rotation
+    /// thread to finish off.
+    struct Handoff {
+        Mapping  full;
+        uint64_t nextFirst;
+    };
+
+    bool createSegment(uint64_t firstSequence, std::string& error);
+    bool mapNewFile(const std::string& path, uint64_t firstSequence, Mapping& mapping, std::string& error);
+    bool rollOver();
+    void rotationLoop();
+    void finishHandoff(const Handoff& handoff);
+    void pruneSegments();
+    void recoverSpare();
+    void stopRotation();
+    std::string sparePath() const;
+    void unmap();
+
+    std::string        directory_;
+    Options            options_;
+    char*              mapping_ = nullptr;
+    size_t             mappedBytes_ = 0;
+    FeedSegmentHeader* header_ = nullptr;
+    uint64_t           nextSequence_ = 1;
+    uint64_t           dropped_ = 0;
+
+    // Rotation thread; spare_ and handoffs_ are guarded by rotateMutex_
+    std::thread             rotator_;
+    std::mutex              rotateMutex_;
+    std::condition_variable rotateCv_;     // Wakes the rotation thread
+    Mapping                 spare_;
+    std::deque<Handoff>     handoffs_;
+    bool                    stopping_ = false;
+};
+
+/// Consumer side of ResultFeed: tails the segments through read-only
+/// shared mappings, lock-free, from any sequence still retained.
+///
+/// Each consumer keeps its own cursor (the next sequence to read); named
+/// cursors can be stored in the feed directory (<name>.cursor) so a
+/// consumer resumes where it stopped.
+class FeedReader {
+public:
+    explicit FeedReader(std::string directory);
+    ~FeedReader();
+
+    FeedReader(const FeedReader&) = delete;
+    FeedReader& operator=(const FeedReader&) = delete;
+
+    /// Position at `sequence`. If it has been deleted by retention, starts
+    /// at the oldest retained record and counts the gap in skipped().
+    /// Returns false (with `error`) if the feed has no segments yet.
+    bool seek(uint64_t sequence, std::string& error);
+
+    /// Deliver up to `maxRecords` committed records to fn(sequence, result),
+    /// following into newer segments. Returns the number delivered; 0 means
+    /// the consumer has caught up. A record that fails its checksum is
+    /// counted in corrupt() and skipped: reading resumes at the next intact
+    /// record, and the sequences lost with it count in skipped().
+    size_t poll(const std::function<void(uint64_t, TradeResult&&)>& fn, size_t maxRecords = 1024);
+
+    /// Next sequence poll() will deliver.
+    uint64_t cursor() const { return cursor_; }
+    uint64_t skipped() const { return skipped_; }
+    uint64_t corrupt() const { return corrupt_; }
+
+    /// Saved cursor of consumer `name`, if any.
+    static std::optional<uint64_t> loadCursor(const std::string& directory, const std::string& name);
+    /// Store the cursor of consumer `name` (atomic replace).
+    static bool saveCursor(const std::string& directory, const std::string& name, uint64_t sequence);
+
+private:
+    bool mapSegment(uint64_t firstSequence, std::string& error);
+    uint64_t resync(uint64_t from, uint64_t committed) const;
+    void unmap();
+
+    std::string              directory_;
+    const char*              mapping_ = nullptr;
+    size_t                   mappedBytes_ = 0;
+    const FeedSegmentHeader* header_ = nullptr;
+    uint64_t                 offset_ = 0;      // Read position within the segment's records
+    uint64_t                 cursor_ = 1;
+    uint64_t                 skipped_ = 0;
+    uint64_t                 corrupt_ = 0;
+};
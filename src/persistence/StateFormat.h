@@ -0,0 +1,152 @@
+#pragma once
+
+#include "models/TradeResult.h"
+#include "mt_api/IMTBrokerAPI.h"
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+
+/// On-disk layout shared by the snapshot and journal files.
+///
+/// Everything is fixed-size little-endian records plus a string arena, so a
+/// snapshot can be memory-mapped and read in place: a record's strings are
+/// (offset, length) pairs into the arena, not copies.
+
+/// FNV-1a over a byte range (integrity check for snapshot bodies and
+/// journal records; chains via `hash`).
+inline uint64_t stateChecksum(const void* data, size_t size, uint64_t hash = 1469598103934665603ull) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/// A string stored in an arena.
+struct StateString {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+};
+
+/// Layout of ResultRecord; 1 (56 bytes, no symbol) is no longer readable.
+static constexpr uint8_t RESULT_LAYOUT = 2;
+
+/// One TradeResult (64 bytes + its strings).
+struct ResultRecord {
+    StateString requestId;
+    StateString clientId;
+    StateString symbol;
+    StateString mtTicketId;
+    StateString errorMessage;
+    uint8_t     status = 0;
+    uint8_t     layout = RESULT_LAYOUT;
+    uint8_t     reserved[2] = {};
+    int32_t     retryCount = 0;
+    double      executionPrice = 0.0;
+    int64_t     timestampNs = 0;     // system_clock, since epoch
+};
+static_assert(sizeof(ResultRecord) == 64, "ResultRecord layout is part of the file format");
+
+/// Account state of one broker connection. A restart matches it back to
+/// its broker by (server, login): every backend may serve the same login.
+struct AccountState {
+    std::string server;    // "primary" or the router backend's name
+    AccountInfo account;
+};
+
+/// One AccountState (56 bytes + server name + currency).
+struct AccountRecord {
+    int32_t     login = 0;
+    uint32_t    reserved = 0;
+    StateString server;
+    StateString currency;
+    double      balance = 0.0;
+    double      equity = 0.0;
+    double      freeMargin = 0.0;
+    double      marginLevel = 0.0;
+};
+static_assert(sizeof(AccountRecord) == 56, "AccountRecord layout is part of the file format");
+
+/// Appends strings to an arena, returning their StateString handles.
+class StateArena {
+public:
+    StateString add(std::string_view text) {
+        StateString s{static_cast<uint32_t>(bytes_.size()), static_cast<uint32_t>(text.size())};
+        bytes_.append(text.data(), text.size());
+        return s;
+    }
+    const std::string& bytes() const { return bytes_; }
+    void clear() { bytes_.clear(); }
+
+private:
+    std::string bytes_;
+};
+
+inline ResultRecord encodeResult(const TradeResult& result, StateArena& arena) {
+    ResultRecord record;
+    record.requestId      = arena.add(result.requestId);
+    record.clientId       = arena.add(result.clientId);
+    record.symbol         = arena.add(result.symbol);
+    record.mtTicketId     = arena.add(result.mtTicketId);
+    record.errorMessage   = arena.add(result.errorMessage);
+    record.status         = static_cast<uint8_t>(result.status);
+    record.retryCount     = result.retryCount;
+    record.executionPrice = result.executionPrice;
+    record.timestampNs    = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                result.timestamp.time_since_epoch()).count();
+    return record;
+}
+
+/// Arena-relative view of a string; the caller has bounds-checked the record.
+inline std::string_view stateView(const char* arena, StateString s) {
+    return std::string_view(arena + s.offset, s.length);
+}
+
+/// True if all of the record's strings lie inside an arena of `size` bytes.
+inline bool resultFits(const ResultRecord& record, uint64_t size) {
+    if (record.layout != RESULT_LAYOUT) return false;
+    for (const StateString* s : {&record.requestId, &record.clientId, &record.symbol,
+                                 &record.mtTicketId, &record.errorMessage}) {
+        if (uint64_t{s->offset} + s->length > size) return false;
+    }
+    return record.status <= static_cast<uint8_t>(TradeStatus::RETRY_EXHAUSTED);
+}
+
+inline TradeResult decodeResult(const ResultRecord& record, const char* arena) {
+    TradeResult result;
+    result.requestId      = std::string(stateView(arena, record.requestId));
+    result.clientId       = std::string(stateView(arena, record.clientId));
+    result.symbol         = std::string(stateView(arena, record.symbol));
+    result.mtTicketId     = std::string(stateView(arena, record.mtTicketId));
+    result.errorMessage   = std::string(stateView(arena, record.errorMessage));
+    result.status         = static_cast<TradeStatus>(record.status);
+    result.retryCount     = record.retryCount;
+    result.executionPrice = record.executionPrice;
+    result.timestamp      = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(record.timestampNs)));
+    return result;
+}
+
+inline AccountRecord encodeAccount(const AccountState& state, StateArena& arena) {
+    const AccountInfo& account = state.account;
+    AccountRecord record;
+    record.login       = account.login;
+    record.server      = arena.add(state.server);
+    record.currency    = arena.add(account.currency);
+    record.balance     = account.balance;
+    record.equity      = account.equity;
+    record.freeMargin  = account.freeMargin;
+    record.marginLevel = account.marginLevel;
+    return record;
+}
+
+inline AccountState decodeAccount(const AccountRecord& record, const char* arena) {
+    return {std::string(stateView(arena, record.server)),
+            {record.login, record.balance, record.equity, record.freeMargin, record.marginLevel,
+             std::string(stateView(arena, record.currency))}};
+}
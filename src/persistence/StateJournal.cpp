@@ -0,0 +1,255 @@
+#include "persistence/StateJournal.h"
+#include "persistence/StateFormat.h"
+#include "config/ConfigFile.h"
+
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+static constexpr const char* SEGMENT_PREFIX = "journal.";
+static constexpr const char* SEGMENT_SUFFIX = ".bin";
+
+/// Largest record replay will accept (guards against reading garbage lengths).
+static constexpr uint32_t MAX_RECORD_BYTES = 1u << 20;
+
+/// Records buffered between commits; a fuller buffer is committed early.
+static constexpr size_t COMMIT_BUFFER_BYTES = 64 * 1024;
+
+StateJournal::Options StateJournal::optionsFrom(const ConfigFile& config) {
+    Options options;
+    options.io    = IoRing::optionsFrom(config);
+    options.fsync = config.getBool("state.fsync", false);
+    return options;
+}
+
+StateJournal::StateJournal(std::string directory, Options options)
+    : directory_(std::move(directory))
+    , options_(options)
+    , io_(options.io)
+    , pending_(COMMIT_BUFFER_BYTES)
+{
+    pendingIndex_ = io_.registerBuffer(pending_.data(), pending_.size());
+    if (options_.fsync) syncer_ = std::thread(&StateJournal::syncLoop, this);
+}
+
+StateJournal::~StateJournal() {
+    closeSegment();
+    stopSync();
+}
+
+void StateJournal::closeSegment() {
+    if (fd_ < 0) return;
+    sync();
+    std::lock_guard<std::mutex> lock(syncMutex_);
+    io_.releaseFile(ioFile_);
+    ::close(fd_);
+    fd_     = -1;
+    ioFile_ = -1;
+}
+
+std::string StateJournal::segmentPath(uint64_t segment) const {
+    char name[48];
+    std::snprintf(name, sizeof(name), "%s%08llu%s", SEGMENT_PREFIX,
+                  static_cast<unsigned long long>(segment), SEGMENT_SUFFIX);
+    return (fs::path(directory_) / name).string();
+}
+
+std::vector<uint64_t> StateJournal::listSegments(const std::string& directory) {
+    std::vector<uint64_t> segments;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        std::string name = entry.path().filename().string();
+        size_t prefix = std::char_traits<char>::length(SEGMENT_PREFIX);
+        size_t suffix = std::char_traits<char>::length(SEGMENT_SUFFIX);
+        if (name.size() <= prefix + suffix || name.compare(0, prefix, SEGMENT_PREFIX) != 0 ||
+            name.compare(name.size() - suffix, suffix, SEGMENT_SUFFIX) != 0) {
+            continue;
+        }
+        std::string digits = name.substr(prefix, name.size() - prefix - suffix);
+        if (std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            segments.push_back(std::stoull(digits));
+        }
+    }
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+uint64_t StateJournal::replay(const std::string& path, const std::function<void(TradeResult&&)>& fn) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return 0;
+
+    uint64_t intact = 0;
+    std::string payload;
+    for (;;) {
+        uint32_t header[2];
+        if (!in.read(reinterpret_cast<char*>(header), sizeof(header))) break;
+        uint32_t length = header[0];
+        if (length < sizeof(ResultRecord) || length > MAX_RECORD_BYTES) break;
+
+        payload.resize(length);
+        if (!in.read(&payload[0], length)) break;
+        if (static_cast<uint32_t>(stateChecksum(payload.data(), length)) != header[1]) break;
+
+        ResultRecord record;
+        std::memcpy(&record, payload.data(), sizeof(record));
+        const char* strings = payload.data() + sizeof(record);
+        if (!resultFits(record, length - sizeof(record))) break;
+
+        fn(decodeResult(record, strings));
+        intact += sizeof(header) + length;
+    }
+    return intact;
+}
+
+bool StateJournal::open(uint64_t segment, std::string& error) {
+    sync();   // Replay below must see everything appended so far
+
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+
+    // Drop a torn tail so new records follow the last intact one.
+    std::string path = segmentPath(segment);
+    uint64_t records = 0;
+    uint64_t intact  = 0;
+    if (fs::exists(path, ec)) {
+        intact = replay(path, [&records](TradeResult&&) { ++records; });
+        if (fs::file_size(path, ec) != intact) fs::resize_file(path, intact, ec);
+        if (ec) {
+            error = "cannot truncate " + path + ": " + ec.message();
+            return false;
+        }
+    }
+
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        error = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    // Only now let go of the previous segment
+    closeSegment();
+    std::lock_guard<std::mutex> lock(syncMutex_);
+    fd_      = fd;
+    ioFile_  = io_.attachFile(fd_);
+    offset_  = intact;
+    segment_ = segment;
+    records_ = records;
+    return true;
+}
+
+void StateJournal::append(const TradeResult& result) {
+    if (fd_ < 0) return;
+
+    // Strings follow the fixed record; arena offsets are relative to them.
+    thread_local StateArena arena;
+    arena.clear();
+    ResultRecord record = encodeResult(result, arena);
+
+    uint32_t length = static_cast<uint32_t>(sizeof(record) + arena.bytes().size());
+    buffer_.resize(2 * sizeof(uint32_t) + length);
+    char* payload = &buffer_[2 * sizeof(uint32_t)];
+    std::memcpy(payload, &record, sizeof(record));
+    std::memcpy(payload + sizeof(record), arena.bytes().data(), arena.bytes().size());
+
+    uint32_t header[2] = {length, static_cast<uint32_t>(stateChecksum(payload, length))};
+    std::memcpy(&buffer_[0], header, sizeof(header));
+
+    if (pendingBytes_ + buffer_.size() > pending_.size()) commit();
+    if (buffer_.size() > pending_.size()) {
+        // Larger than the whole commit buffer: written from the encode buffer
+        if (options_.fsync) {
+            queueSync(buffer_.data(), buffer_.size());
+            ++records_;
+            return;
+        }
+        io_.write(ioFile_, buffer_.data(), buffer_.size(), offset_);
+        offset_ += buffer_.size();
+        commit();
+    } else {
+        std::memcpy(pending_.data() + pendingBytes_, buffer_.data(), buffer_.size());
+        pendingBytes_ += buffer_.size();
+    }
+    ++records_;
+}
+
+bool StateJournal::commit() {
+    if (fd_ < 0) return false;
+    if (options_.fsync) {
+        if (pendingBytes_ > 0) queueSync(pending_.data(), pendingBytes_);
+        pendingBytes_ = 0;
+        std::lock_guard<std::mutex> lock(syncMutex_);
+        return !syncFailed_;
+    }
+    if (pendingBytes_ > 0) {
+        io_.write(ioFile_, pending_.data(), pendingBytes_, offset_, pendingIndex_);
+        offset_ += pendingBytes_;
+        pendingBytes_ = 0;
+    }
+    if (io_.queued() == 0) return true;
+    return io_.submit();
+}
+
+bool StateJournal::sync() {
+    if (!commit()) return false;
+    if (!options_.fsync) return true;
+    std::unique_lock<std::mutex> lock(syncMutex_);
+    syncedCv_.wait(lock, [this] { return queued_.empty() && !syncing_; });
+    return !syncFailed_;
+}
+
+void StateJournal::queueSync(const char* data, size_t size) {
+    {
+        std::lock_guard<std::mutex> lock(syncMutex_);
+        if (queued_.empty()) queuedOffset_ = offset_;
+        queued_.insert(queued_.end(), data, data + size);
+    }
+    offset_ += size;
+    syncCv_.notify_one();
+}
+
+void StateJournal::syncLoop() {
+    std::unique_lock<std::mutex> lock(syncMutex_);
+    while (true) {
+        syncCv_.wait(lock, [this] { return !queued_.empty() || stopping_; });
+        if (queued_.empty()) break;   // Stopping with nothing left
+
+        // Everything committed since the last round: one write, one fdatasync
+        writing_.swap(queued_);
+        uint64_t offset = queuedOffset_;
+        int      file   = ioFile_;
+        syncing_ = true;
+        lock.unlock();
+
+        io_.write(file, writing_.data(), writing_.size(), offset);
+        io_.fsync(file);
+        bool ok = io_.submit();
+        writing_.clear();
+
+        lock.lock();
+        syncing_ = false;
+        syncFailed_ = syncFailed_ || !ok;
+        syncedCv_.notify_all();
+    }
+}
+
+void StateJournal::stopSync() {
+    if (!syncer_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(syncMutex_);
+        stopping_ = true;
+    }
+    syncCv_.notify_one();
+    syncer_.join();
+}
+
+bool StateJournal::rotate(uint64_t& closed, std::string& error) {
+    closed = segment_;
+    return open(segment_ + 1, error);
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "models/TradeResult.h"
+#include "io/IoRing.h"
+
+#include <string>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/// Append-only journal of tracked results, split into numbered segments
+/// (<dir>/journal.<segment>.bin).
+///
+/// Each record is [u32 length][u32 checksum][ResultRecord][strings]. A crash
+/// mid-write leaves at most one torn record at the end of the last segment;
+/// replay stops there and open() truncates it away.
+///
+/// Appended records collect in a registered buffer; commit() writes them
+/// with one IoRing submission and waits for it (a page-cache write).
+///
+/// With state.fsync an fdatasync takes milliseconds, too long to wait for
+/// under the tracker lock. commit() then only copies the batch to a sync
+/// thread, which writes and fdatasyncs whatever has queued up since its last
+/// round in one submission (group commit). A result is thus acknowledged
+/// before it is on disk: a power loss can lose the batches of the sync in
+/// progress, a process crash the ones not yet written. sync() waits for
+/// everything committed so far; open(), rotate() and the destructor do.
+///
+/// Not thread-safe: ResultTracker appends, commits and rotates under its own
+/// mutex, which is what makes a rotation a consistent cut between snapshot
+/// and tail.
+class StateJournal {
+public:
+    struct Options {
+        IoRing::Options io;              // io.backend, io.ring_entries
+        bool            fsync = false;   // state.fsync: fdatasync commits on a sync thread
+    };
+
+    static Options optionsFrom(const ConfigFile& config);
+
+    StateJournal(std::string directory, Options options);
+    ~StateJournal();
+
+    StateJournal(const StateJournal&) = delete;
+    StateJournal& operator=(const StateJournal&) = delete;
+
+    /// Open (creating if needed) `segment` for appending, dropping any torn
+    /// tail. Returns false and sets `error` on I/O failure; the segment open
+    /// before (if any) then stays open.
+    bool open(uint64_t segment, std::string& error);
+
+    /// Buffer one result for the next commit().
+    void append(const TradeResult& result);
+
+    /// Write the results appended since the last commit and wait for the
+    /// kernel to take them: they then survive a process crash. With fsync,
+    /// hand them to the sync thread instead. False on an I/O error (with
+    /// fsync: if any sync has failed so far).
+    bool commit();
+
+    /// Commit, then wait until the sync thread has written and synced
+    /// everything (a plain commit() without fsync). False on an I/O error.
+    bool sync();
+
+    /// Commit, close the current segment and start the next; `closed` is
+    /// the segment just closed. If the next segment cannot be opened, returns
+    /// false with `error` set and keeps appending to the current one.
+    bool rotate(uint64_t& closed, std::string& error);
+
+    /// Ring statistics; with fsync, read them after sync().
+    const IoRing& io() const { return io_; }
+
+    uint64_t segment() const { return segment_; }
+    uint64_t recordsInSegment() const { return records_; }
+
+    std::string segmentPath(uint64_t segment) const;
+
+    /// Existing segment numbers in `directory`, ascending.
+    static std::vector<uint64_t> listSegments(const std::string& directory);
+
+    /// Feed every intact record of a segment file to `fn`. Returns the byte
+    /// length of the intact prefix (0 if the file is missing).
+    static uint64_t replay(const std::string& path, const std::function<void(TradeResult&&)>& fn);
+
+private:
+    void closeSegment();
+
+    /// With fsync: queue `size` bytes at the current end for the sync thread.
+    void queueSync(const char* data, size_t size);
+    void syncLoop();
+    void stopSync();
+
+    std::string       directory_;
+    Options           options_;
+    int               fd_       = -1;
+    uint64_t          offset_   = 0;     // Bytes handed to the current segment
+    uint64_t          segment_  = 0;
+    uint64_t          records_  = 0;
+    std::string       buffer_;           // Reused encode buffer
+
+    IoRing            io_;
+    int               ioFile_   = -1;    // fd_ in io_
+    std::vector<char> pending_;          // Records since the last commit (registered)
+    size_t            pendingBytes_ = 0;
+    int               pendingIndex_ = -1;
+
+    // Sync thread (fsync only). queued_ holds the commits since its last
+    // round, starting at queuedOffset_; it swaps them into writing_. The
+    // ring is used only by that thread while it runs; segment switches
+    // touch it after sync(), with syncMutex_ held.
+    std::thread             syncer_;
+    std::mutex              syncMutex_;
+    std::condition_variable syncCv_;       // Wakes the sync thread
+    std::condition_variable syncedCv_;     // A round finished
+    std::vector<char>       queued_;
+    std::vector<char>       writing_;
+    uint64_t                queuedOffset_ = 0;
+    bool                    syncing_  = false;
+    bool                    syncFailed_ = false;
+    bool                    stopping_ = false;
+};
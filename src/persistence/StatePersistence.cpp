@@ -0,0 +1,207 @@
+#include "persistence/StatePersistence.h"
+#include "models/RequestId.h"
+
+#include <filesystem>
+#include <sstream>
+#include <iomanip>
+
+namespace fs = std::filesystem;
+
+StatePersistence::StatePersistence(Logger& logger, std::string directory, StateJournal::Options journal)
+    : logger_(logger)
+    , directory_(std::move(directory))
+    , journal_(directory_, journal)
+{
+}
+
+StatePersistence::~StatePersistence() {
+    stop();
+}
+
+std::string StatePersistence::snapshotPath() const {
+    return (fs::path(directory_) / "state.snap").string();
+}
+
+void StatePersistence::open() {
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+
+    std::string path = snapshotPath();
+    if (!fs::exists(path, ec)) return;
+
+    std::string error;
+    snapshot_ = SnapshotView::open(path, error);
+    if (!snapshot_) {
+        logger_.error("State snapshot " + path + " unusable (" + error + "); restarting from journal only");
+        fs::rename(path, path + ".corrupt", ec);
+    }
+}
+
+std::vector<AccountState> StatePersistence::restoredAccounts() const {
+    std::vector<AccountState> accounts;
+    if (!snapshot_) return accounts;
+    for (size_t i = 0; i < snapshot_->accountCount(); ++i) accounts.push_back(snapshot_->account(i));
+    return accounts;
+}
+
+StatePersistence::RestoreStats StatePersistence::restoreResults(const std::function<void(const TradeResult&)>& fn) {
+    auto start = std::chrono::steady_clock::now();
+    RestoreStats stats;
+
+    auto feed = [&](const TradeResult& result) {
+        uint64_t seq;
+        if (RequestIdFormat::parseSequence(result.requestId, seq)) {
+            if (!stats.anySequence || seq > stats.maxSequence) stats.maxSequence = seq;
+            stats.anySequence = true;
+        }
+        fn(result);
+    };
+
+    uint64_t firstSegment = 0;
+    if (snapshot_) {
+        for (size_t i = 0; i < snapshot_->resultCount(); ++i) feed(snapshot_->result(i));
+        stats.snapshotResults = snapshot_->resultCount();
+        stats.accounts        = snapshot_->accountCount();
+        stats.mappedBytes     = snapshot_->mappedBytes();
+        firstSegment          = snapshot_->journalSegment();
+    }
+
+    // Journal tail: segments the snapshot does not cover (older ones are
+    // leftovers from a compaction interrupted after its rename).
+    uint64_t nextSegment = firstSegment;
+    for (uint64_t segment : StateJournal::listSegments(directory_)) {
+        if (segment < firstSegment) continue;
+        StateJournal::replay(journal_.segmentPath(segment), [&](TradeResult&& result) {
+            feed(result);
+            ++stats.journalResults;
+        });
+        nextSegment = segment + 1;
+    }
+
+    // Append to a fresh segment rather than after a possibly torn record.
+    std::string error;
+    if (!journal_.open(nextSegment, error)) {
+        logger_.error("State journal not writable (" + error + "); results will not be persisted");
+    }
+
+    stats.elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+void StatePersistence::setAccountSource(std::function<std::vector<AccountState>()> source) {
+    accountSource_ = std::move(source);
+}
+
+void StatePersistence::start(Rotate rotate, std::chrono::milliseconds interval) {
+    rotate_ = std::move(rotate);
+    {
+        std::lock_guard<std::mutex> lock(stopMutex_);
+        stopping_ = false;
+    }
+    if (interval.count() > 0) {
+        thread_ = std::thread(&StatePersistence::snapshotLoop, this, interval);
+    }
+}
+
+void StatePersistence::stop() {
+    {
+        std::lock_guard<std::mutex> lock(stopMutex_);
+        stopping_ = true;
+    }
+    stopCv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+
+    if (rotate_) {
+        snapshotNow();
+        rotate_ = nullptr;
+    }
+}
+
+void StatePersistence::snapshotLoop(std::chrono::milliseconds interval) {
+    std::unique_lock<std::mutex> lock(stopMutex_);
+    while (!stopCv_.wait_for(lock, interval, [this] { return stopping_; })) {
+        lock.unlock();
+        snapshotNow();
+        lock.lock();
+    }
+}
+
+bool StatePersistence::snapshotNow() {
+    std::lock_guard<std::mutex> guard(snapshotMutex_);
+    if (!rotate_) return false;
+
+    // Consistent cut: everything tracked so far is in segments <= closed.
+    uint64_t closed = 0;
+    std::string error;
+    if (!rotate_(closed, error)) {
+        logger_.error("State journal rotation failed (" + error + "); still appending to segment " +
+                      std::to_string(journal_.segment()) + ", snapshot retried next interval");
+        return false;
+    }
+    std::vector<AccountState> accounts = accountSource_ ? accountSource_() : std::vector<AccountState>{};
+
+    auto start = std::chrono::steady_clock::now();
+    if (!writer_) {
+        // First snapshot of this run: seed the writer from the one on disk
+        writer_.emplace();
+        if (snapshot_) {
+            for (size_t i = 0; i < snapshot_->resultCount(); ++i) {
+                writer_->addResult(snapshot_->resultRecord(i), snapshot_->arena());
+            }
+            nextFold_ = snapshot_->journalSegment();
+        }
+    }
+
+    // Fold only the segments closed since the last call
+    std::vector<uint64_t> segments;
+    size_t journaled = 0;
+    for (uint64_t segment : StateJournal::listSegments(directory_)) {
+        if (segment > closed) continue;
+        segments.push_back(segment);
+        if (segment < nextFold_) continue;   // Folded already (or a leftover the snapshot covers)
+        StateJournal::replay(journal_.segmentPath(segment), [&](TradeResult&& result) {
+            writer_->addResult(result);
+            ++journaled;
+        });
+    }
+    nextFold_  = closed + 1;
+    unwritten_ = unwritten_ || journaled > 0;
+    size_t expired = retainResults_ > 0 ? writer_->retain(retainResults_) : 0;
+    unwritten_ = unwritten_ || expired > 0;
+
+    std::error_code ec;
+    if (!unwritten_ && snapshot_) {
+        for (uint64_t segment : segments) fs::remove(journal_.segmentPath(segment), ec);
+        return true;   // Nothing new since the last snapshot
+    }
+
+    writer_->clearAccounts();
+    for (const auto& account : accounts) writer_->addAccount(account);
+
+    // On failure the folded segments stay on disk until a write succeeds
+    if (!writer_->write(snapshotPath(), closed + 1, error)) {
+        logger_.error("State snapshot failed: " + error);
+        return false;
+    }
+
+    // The new file is in place; remap it, then drop the folded segments.
+    auto view = SnapshotView::open(snapshotPath(), error);
+    if (!view) {
+        logger_.error("State snapshot unreadable after write: " + error);
+        return false;
+    }
+    snapshot_  = std::move(view);
+    unwritten_ = false;
+    for (uint64_t segment : segments) fs::remove(journal_.segmentPath(segment), ec);
+
+    std::ostringstream oss;
+    oss << "State snapshot: " << writer_->resultCount() << " results (" << journaled
+        << " from journal, " << expired << " expired), " << accounts.size() << " accounts, "
+        << snapshot_->mappedBytes() / 1024 << " KB on disk, " << writer_->memoryBytes() / 1024
+        << " KB in memory, written in " << std::fixed << std::setprecision(1)
+        << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+        << "ms";
+    logger_.info(oss.str());
+    return true;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "persistence/StateJournal.h"
+#include "persistence/StateSnapshot.h"
+#include "logger/Logger.h"
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+/// Snapshot + journal persistence for warm restarts.
+///
+/// State directory layout:
+///   state.snap              - results + account state, memory-mappable
+///   journal.<segment>.bin   - results tracked since that snapshot
+///
+/// Every tracked result is appended to the current journal segment (by
+/// ResultTracker, under its lock, committed once per recorded batch; with
+/// state.fsync the journal's sync thread does the fdatasync).
+/// Snapshots are built incrementally and fork-free: the tracker only
+/// rotates to a new segment under its lock (with state.fsync, after
+/// waiting for the sync in progress); a background thread
+/// then folds the newly closed segments into its in-memory SnapshotWriter
+/// (seeded once from the snapshot on disk), writes it out and deletes
+/// those segments. Trading never waits on the snapshot. If the next
+/// segment cannot be created, the journal keeps appending to the current
+/// one and the snapshot is retried on the next interval.
+///
+/// The snapshot keeps the newest state.retain_results results (0 = all), so
+/// neither the folded state in memory nor the time to write it grows with
+/// the age of the state directory. Older results are not restored, and a
+/// duplicate of one of their request IDs is not detected after a restart;
+/// the request ID sequence still continues past every restored ID.
+///
+/// Warm restart maps the snapshot, replays only the segments written after
+/// it, and rebuilds the tracker and dedup set from the combined results.
+class StatePersistence {
+public:
+    struct RestoreStats {
+        size_t   snapshotResults = 0;
+        size_t   journalResults  = 0;
+        size_t   accounts        = 0;
+        size_t   mappedBytes     = 0;
+        uint64_t maxSequence     = 0;    // Highest request ID sequence seen
+        bool     anySequence     = false;
+        double   elapsedMs       = 0.0;
+    };
+
+    StatePersistence(Logger& logger, std::string directory, StateJournal::Options journal = {});
+    ~StatePersistence();
+
+    StatePersistence(const StatePersistence&) = delete;
+    StatePersistence& operator=(const StatePersistence&) = delete;
+
+    /// Map the existing snapshot, if any. A corrupt snapshot is set aside
+    /// (renamed *.corrupt) and the restart proceeds from the journal alone.
+    void open();
+
+    /// Account state from the snapshot; match it to brokers by
+    /// (server, login), not by position.
+    std::vector<AccountState> restoredAccounts() const;
+
+    /// Feed every persisted result to `fn` (snapshot, then journal tail),
+    /// then open a fresh journal segment for appending. Call once.
+    RestoreStats restoreResults(const std::function<void(const TradeResult&)>& fn);
+
+    StateJournal& journal() { return journal_; }
+
+    /// Source of account state for snapshots (captured right after each
+    /// journal rotation).
+    void setAccountSource(std::function<std::vector<AccountState>()> source);
+
+    /// Keep only the newest `maxResults` results in snapshots (0 = all).
+    void setRetainResults(size_t maxResults) { retainResults_ = maxResults; }
+
+    /// Switches the journal to its next segment under the tracker's lock
+    /// (ResultTracker::rotateJournal).
+    using Rotate = std::function<bool(uint64_t& closed, std::string& error)>;
+
+    /// Snapshot every `interval` in the background.
+    void start(Rotate rotate, std::chrono::milliseconds interval);
+
+    /// Stop the background thread and take a final snapshot.
+    void stop();
+
+    /// Take a snapshot now (no-op if nothing was journaled since the last).
+    bool snapshotNow();
+
+    const std::string& directory() const { return directory_; }
+
+private:
+    std::string snapshotPath() const;
+    void snapshotLoop(std::chrono::milliseconds interval);
+
+    Logger&                                    logger_;
+    std::string                                directory_;
+    StateJournal                               journal_;
+    std::optional<SnapshotView>                snapshot_;        // Latest snapshot on disk
+    std::function<std::vector<AccountState>()> accountSource_;
+    Rotate                                     rotate_;
+    size_t                                     retainResults_ = 0;
+
+    // Folded state, under snapshotMutex_: snapshot_ plus segments below nextFold_
+    std::optional<SnapshotWriter>              writer_;
+    uint64_t                                   nextFold_ = 0;
+    bool                                       unwritten_ = false;   // Folded results not on disk yet
+
+    std::mutex                                 snapshotMutex_;   // One snapshot at a time
+    std::thread                                thread_;
+    std::mutex                                 stopMutex_;
+    std::condition_variable                    stopCv_;
+    bool                                       stopping_ = false;
+};
@@ -0,0 +1,208 @@
+#include "persistence/StateSnapshot.h"
+
+#include <filesystem>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static constexpr char SNAPSHOT_MAGIC[8] = {'M', 'T', '5', 'S', 'N', 'A', 'P', '1'};
+
+std::optional<SnapshotView> SnapshotView::open(const std::string& path, std::string& error) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "not found";
+        return std::nullopt;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SnapshotHeader)) {
+        ::close(fd);
+        error = "truncated header";
+        return std::nullopt;
+    }
+
+    SnapshotView view;
+    view.size_    = static_cast<size_t>(st.st_size);
+    view.mapping_ = ::mmap(nullptr, view.size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view.mapping_ == MAP_FAILED) {
+        view.mapping_ = nullptr;
+        error = "mmap failed";
+        return std::nullopt;
+    }
+
+    const char* base = static_cast<const char*>(view.mapping_);
+    view.header_ = reinterpret_cast<const SnapshotHeader*>(base);
+    const SnapshotHeader& h = *view.header_;
+    if (std::memcmp(h.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+        h.version != VERSION || h.headerSize != sizeof(SnapshotHeader)) {
+        error = "not a version " + std::to_string(VERSION) + " snapshot";
+        return std::nullopt;
+    }
+
+    uint64_t body = view.size_ - sizeof(SnapshotHeader);
+    uint64_t expected = h.resultCount * sizeof(ResultRecord) + h.accountCount * sizeof(AccountRecord) + h.arenaSize;
+    if (h.resultCount > body / sizeof(ResultRecord) || h.accountCount > body / sizeof(AccountRecord) ||
+        expected != body) {
+        error = "section sizes do not match file size";
+        return std::nullopt;
+    }
+    if (stateChecksum(base + sizeof(SnapshotHeader), body) != h.bodyChecksum) {
+        error = "checksum mismatch";
+        return std::nullopt;
+    }
+
+    const char* p = base + sizeof(SnapshotHeader);
+    view.results_  = reinterpret_cast<const ResultRecord*>(p);
+    p += h.resultCount * sizeof(ResultRecord);
+    view.accounts_ = reinterpret_cast<const AccountRecord*>(p);
+    p += h.accountCount * sizeof(AccountRecord);
+    view.arena_    = p;
+
+    for (size_t i = 0; i < h.resultCount; ++i) {
+        if (!resultFits(view.results_[i], h.arenaSize)) {
+            error = "result " + std::to_string(i) + " out of bounds";
+            return std::nullopt;
+        }
+    }
+    for (size_t i = 0; i < h.accountCount; ++i) {
+        const StateString& c = view.accounts_[i].currency;
+        const StateString& s = view.accounts_[i].server;
+        if (uint64_t{c.offset} + c.length > h.arenaSize || uint64_t{s.offset} + s.length > h.arenaSize) {
+            error = "account " + std::to_string(i) + " out of bounds";
+            return std::nullopt;
+        }
+    }
+    return view;
+}
+
+SnapshotView::SnapshotView(SnapshotView&& other) noexcept {
+    *this = std::move(other);
+}
+
+SnapshotView& SnapshotView::operator=(SnapshotView&& other) noexcept {
+    if (this != &other) {
+        if (mapping_) ::munmap(mapping_, size_);
+        mapping_  = other.mapping_;
+        size_     = other.size_;
+        header_   = other.header_;
+        results_  = other.results_;
+        accounts_ = other.accounts_;
+        arena_    = other.arena_;
+        other.mapping_ = nullptr;
+        other.size_    = 0;
+    }
+    return *this;
+}
+
+SnapshotView::~SnapshotView() {
+    if (mapping_) ::munmap(mapping_, size_);
+}
+
+void SnapshotWriter::put(const ResultRecord& record) {
+    std::string key(stateView(arena_.bytes().data(), record.requestId));
+    auto [it, inserted] = index_.emplace(std::move(key), results_.size());
+    if (inserted) {
+        results_.push_back(record);
+    } else {
+        results_[it->second] = record;   // Superseded strings stay in the arena
+    }
+}
+
+void SnapshotWriter::addResult(const TradeResult& result) {
+    put(encodeResult(result, arena_));
+}
+
+/// `record` with its strings copied from `from` into `to`.
+static ResultRecord relocate(const ResultRecord& record, const char* from, StateArena& to) {
+    ResultRecord copy = record;
+    copy.requestId    = to.add(stateView(from, record.requestId));
+    copy.clientId     = to.add(stateView(from, record.clientId));
+    copy.symbol       = to.add(stateView(from, record.symbol));
+    copy.mtTicketId   = to.add(stateView(from, record.mtTicketId));
+    copy.errorMessage = to.add(stateView(from, record.errorMessage));
+    return copy;
+}
+
+void SnapshotWriter::addResult(const ResultRecord& record, const char* arena) {
+    put(relocate(record, arena, arena_));
+}
+
+size_t SnapshotWriter::retain(size_t maxResults) {
+    if (results_.size() <= maxResults) return 0;
+    size_t expired = results_.size() - maxResults;
+
+    StateArena arena;
+    std::vector<ResultRecord> kept;
+    kept.reserve(maxResults);
+    index_.clear();
+    for (size_t i = expired; i < results_.size(); ++i) {
+        kept.push_back(relocate(results_[i], arena_.bytes().data(), arena));
+        index_.emplace(std::string(stateView(arena.bytes().data(), kept.back().requestId)), kept.size() - 1);
+    }
+    results_.swap(kept);
+    arena_ = std::move(arena);
+    accounts_.clear();
+    return expired;
+}
+
+size_t SnapshotWriter::memoryBytes() const {
+    // Index: one node (key, slot, next pointer) per result plus the buckets;
+    // IDs longer than the small-string buffer add their own allocation
+    size_t indexBytes = index_.size() * (sizeof(decltype(index_)::value_type) + sizeof(void*)) +
+                        index_.bucket_count() * sizeof(void*);
+    return results_.capacity() * sizeof(ResultRecord) + accounts_.capacity() * sizeof(AccountRecord) +
+           arena_.bytes().capacity() + indexBytes;
+}
+
+void SnapshotWriter::addAccount(const AccountState& account) {
+    accounts_.push_back(encodeAccount(account, arena_));
+}
+
+bool SnapshotWriter::write(const std::string& path, uint64_t journalSegment, std::string& error) const {
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version        = SnapshotView::VERSION;
+    header.headerSize     = sizeof(SnapshotHeader);
+    header.journalSegment = journalSegment;
+    header.resultCount    = results_.size();
+    header.accountCount   = accounts_.size();
+    header.arenaSize      = arena_.bytes().size();
+    header.createdNs      = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::system_clock::now().time_since_epoch()).count();
+
+    uint64_t checksum = stateChecksum(results_.data(), results_.size() * sizeof(ResultRecord));
+    checksum = stateChecksum(accounts_.data(), accounts_.size() * sizeof(AccountRecord), checksum);
+    checksum = stateChecksum(arena_.bytes().data(), arena_.bytes().size(), checksum);
+    header.bodyChecksum = checksum;
+
+    std::string temp = path + ".tmp";
+    std::FILE* file = std::fopen(temp.c_str(), "wb");
+    if (!file) {
+        error = "cannot create " + temp;
+        return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && std::fwrite(results_.data(), sizeof(ResultRecord), results_.size(), file) == results_.size();
+    ok = ok && std::fwrite(accounts_.data(), sizeof(AccountRecord), accounts_.size(), file) == accounts_.size();
+    ok = ok && std::fwrite(arena_.bytes().data(), 1, arena_.bytes().size(), file) == arena_.bytes().size();
+    ok = ok && std::fflush(file) == 0 && ::fsync(::fileno(file)) == 0;
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok || std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::remove(temp.c_str());
+        error = "cannot write " + path;
+        return false;
+    }
+
+    // The rename lives in the directory: sync it too
+    std::string directory = std::filesystem::path(path).parent_path().string();
+    int dir = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    ok = dir >= 0 && ::fsync(dir) == 0;
+    if (dir >= 0) ::close(dir);
+    if (!ok) {
+        error = "cannot sync directory of " + path;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "persistence/StateFormat.h"
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <unordered_map>
+#include <cstdint>
+
+/// Header of a snapshot file. Sections follow it in the order results,
+/// accounts, string arena; the checksum covers everything after the header.
+struct SnapshotHeader {
+    char     magic[8];            // "MT5SNAP1"
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t journalSegment;      // First journal segment NOT folded in
+    uint64_t resultCount;
+    uint64_t accountCount;
+    uint64_t arenaSize;
+    uint64_t bodyChecksum;
+    int64_t  createdNs;           // system_clock, since epoch
+};
+
+/// Read-only, memory-mapped snapshot.
+///
+/// open() validates the header, bounds and checksum once; after that the
+/// records are read straight out of the mapping (no parsing or copying
+/// until a caller decodes one).
+class SnapshotView {
+public:
+    static constexpr uint32_t VERSION = 3;
+
+    /// Map and validate `path`. nullopt with `error` set if it is missing,
+    /// truncated or corrupt.
+    static std::optional<SnapshotView> open(const std::string& path, std::string& error);
+
+    SnapshotView(SnapshotView&& other) noexcept;
+    SnapshotView& operator=(SnapshotView&& other) noexcept;
+    ~SnapshotView();
+
+    const SnapshotHeader& header() const { return *header_; }
+    uint64_t journalSegment() const { return header_->journalSegment; }
+
+    size_t resultCount()  const { return static_cast<size_t>(header_->resultCount); }
+    size_t accountCount() const { return static_cast<size_t>(header_->accountCount); }
+
+    const ResultRecord&  resultRecord(size_t i)  const { return results_[i]; }
+    const AccountRecord& accountRecord(size_t i) const { return accounts_[i]; }
+    const char*          arena()                 const { return arena_; }
+
+    TradeResult result(size_t i)  const { return decodeResult(results_[i], arena_); }
+    AccountState account(size_t i) const { return decodeAccount(accounts_[i], arena_); }
+
+    /// Request ID of result `i`, without copying.
+    std::string_view requestId(size_t i) const { return stateView(arena_, results_[i].requestId); }
+
+    size_t mappedBytes() const { return size_; }
+
+private:
+    SnapshotView() = default;
+
+    void*                 mapping_  = nullptr;
+    size_t                size_     = 0;
+    const SnapshotHeader* header_   = nullptr;
+    const ResultRecord*   results_  = nullptr;
+    const AccountRecord*  accounts_ = nullptr;
+    const char*           arena_    = nullptr;
+};
+
+/// Builds a snapshot file. Results with a request ID that was already added
+/// replace the earlier one (same last-write-wins rule as ResultTracker).
+/// A writer can be kept and written again after adding more: that is how
+/// StatePersistence folds only new journal segments into each snapshot.
+class SnapshotWriter {
+public:
+    void addResult(const TradeResult& result);
+    /// Copy a record straight from another snapshot (no decode).
+    void addResult(const ResultRecord& record, const char* arena);
+    void addAccount(const AccountState& account);
+    void clearAccounts() { accounts_.clear(); }
+
+    /// Keep only the newest `maxResults` results (in the order their request
+    /// IDs were first added) and compact the arena, dropping superseded
+    /// strings too. Clears the accounts; add them again afterwards. Returns
+    /// the number of results dropped.
+    size_t retain(size_t maxResults);
+
+    size_t resultCount() const { return results_.size(); }
+
+    /// Approximate heap bytes held: records, arena and the request ID index.
+    size_t memoryBytes() const;
+
+    /// Write to `path` atomically (temp file, fsync, rename, fsync of the
+    /// directory so the rename itself survives a power loss).
+    bool write(const std::string& path, uint64_t journalSegment, std::string& error) const;
+
+private:
+    void put(const ResultRecord& record);
+
+    std::vector<ResultRecord>                  results_;
+    std::vector<AccountRecord>                 accounts_;
+    StateArena                                 arena_;
+    std::unordered_map<std::string, size_t>    index_;   // request ID -> results_ slot
+};
@@ -0,0 +1,12 @@
+#include "processor/BatchValidator.h"
+
+void BatchValidator::checkNumeric(const RequestBatchSoA& batch, uint32_t* errors) {
+    const size_t n = batch.size();
+    for (size_t i = 0; i < n; ++i) {
+        double v = batch.volume[i];
+        errors[i] |= (v <= 0.0 ? CHECK_VOLUME_POSITIVE : 0u)
+                   | ((v < batch.minVolume[i] || v > batch.maxVolume[i]) ? CHECK_VOLUME_RANGE : 0u)
+                   | (batch.stopLoss[i]   <= 0.0 ? CHECK_STOP_LOSS   : 0u)
+                   | (batch.takeProfit[i] <= 0.0 ? CHECK_TAKE_PROFIT : 0u);
+    }
+}
@@ -0,0 +1,106 @@
+#include "processor/ClientSession.h"
+
+#include <algorithm>
+
+ClientSession::ClientSession(std::string clientId, size_t credits)
+    : clientId_(std::move(clientId))
+    , ring_(std::max<size_t>(1, credits))
+{
+}
+
+bool ClientSession::tryAcquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (inFlight_ + count_ >= ring_.size()) {
+        ++refused_;
+        return false;
+    }
+    ++inFlight_;
+    return true;
+}
+
+void ClientSession::release() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (inFlight_ > 0) --inFlight_;
+    }
+    creditCv_.notify_one();
+}
+
+void ClientSession::deliver(const TradeResult& result) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // The credit taken at submit reserved this slot, so the ring has room.
+        ring_[(head_ + count_) % ring_.size()] = result;
+        ++count_;
+        if (inFlight_ > 0) --inFlight_;
+    }
+    readyCv_.notify_one();
+}
+
+void ClientSession::deliver(const TradeResult* const* results, size_t count) {
+    if (count == 0) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < count; ++i) {
+            ring_[(head_ + count_) % ring_.size()] = *results[i];
+            ++count_;
+        }
+        inFlight_ -= std::min(inFlight_, count);
+    }
+    readyCv_.notify_one();
+}
+
+size_t ClientSession::poll(std::vector<SessionResult>& out, size_t maxN) {
+    size_t taken = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        taken = std::min(maxN, count_);
+        for (size_t i = 0; i < taken; ++i) {
+            out.push_back({nextSeq_++, std::move(ring_[head_])});
+            head_ = (head_ + 1) % ring_.size();
+        }
+        count_ -= taken;
+    }
+    if (taken > 0) creditCv_.notify_all();
+    return taken;
+}
+
+bool ClientSession::waitForResults(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return readyCv_.wait_for(lock, timeout, [this] { return count_ > 0; });
+}
+
+bool ClientSession::waitForCredit(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return creditCv_.wait_for(lock, timeout, [this] { return inFlight_ + count_ < ring_.size(); });
+}
+
+uint64_t ClientSession::cursor() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return nextSeq_;
+}
+
+size_t ClientSession::available() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return ring_.size() - inFlight_ - count_;
+}
+
+size_t ClientSession::inFlight() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return inFlight_;
+}
+
+size_t ClientSession::ready() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return count_;
+}
+
+uint64_t ClientSession::delivered() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return nextSeq_ - 1 + count_;
+}
+
+uint64_t ClientSession::refused() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return refused_;
+}
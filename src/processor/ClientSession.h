@@ -0,0 +1,84 @@
+#pragma once
+
+#include "models/TradeResult.h"
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+/// A result as delivered on a session, numbered in completion order.
+struct SessionResult {
+    uint64_t    sequence;   // 1, 2, 3, ... per session, no gaps
+    TradeResult result;
+};
+
+/// One client connection's ordered result stream, with credit-based flow
+/// control.
+///
+/// The session has a fixed window of `credits` slots. Submitting a request
+/// (BasicDealProcessor::submit(session, request)) takes one; the slot is
+/// held while the request is in flight and while its result waits to be
+/// polled, and returned by poll(). A consumer that stops polling therefore
+/// runs out of credits and further submits are refused, instead of the
+/// processor buffering an unbounded backlog for it. Since every in-flight
+/// request already owns a slot, delivery never blocks a worker and never
+/// drops a result.
+///
+/// Results sit in a ring of `credits` entries. poll() moves them out (no
+/// copy) in sequence order; cursor() is the sequence the next poll starts at.
+class ClientSession {
+public:
+    ClientSession(std::string clientId, size_t credits);
+
+    const std::string& clientId() const { return clientId_; }
+
+    /// Take one credit for a request about to be submitted. False if the
+    /// window is exhausted (in flight + unpolled == window).
+    bool tryAcquire();
+
+    /// Give back a credit taken by tryAcquire() for a request that was not
+    /// submitted after all.
+    void release();
+
+    /// Called by a worker when a request on this session completes.
+    void deliver(const TradeResult& result);
+
+    /// Deliver several completed results at once (in order), under one lock.
+    void deliver(const TradeResult* const* results, size_t count);
+
+    /// Move up to `maxN` results (in sequence order) into `out`, returning
+    /// their credits. Returns the number appended.
+    size_t poll(std::vector<SessionResult>& out, size_t maxN);
+
+    /// Wait until a result is ready to poll (or `timeout` passes).
+    bool waitForResults(std::chrono::milliseconds timeout);
+
+    /// Wait until a credit is free (or `timeout` passes).
+    bool waitForCredit(std::chrono::milliseconds timeout);
+
+    /// Sequence number of the next result poll() will return.
+    uint64_t cursor() const;
+
+    size_t   window()    const { return ring_.size(); }
+    size_t   available() const;   // Credits free right now
+    size_t   inFlight()  const;
+    size_t   ready()     const;
+    uint64_t delivered() const;
+    uint64_t refused()   const;   // Submits turned away for lack of credit
+
+private:
+    std::string              clientId_;
+    std::vector<TradeResult> ring_;             // Capacity = credit window
+
+    mutable std::mutex       mutex_;
+    std::condition_variable  readyCv_;
+    std::condition_variable  creditCv_;
+    size_t                   head_      = 0;    // Next slot to poll
+    size_t                   count_     = 0;    // Results waiting in the ring
+    size_t                   inFlight_  = 0;    // Credits held by submitted requests
+    uint64_t                 nextSeq_   = 1;    // Sequence of the next delivered result
+    uint64_t                 refused_   = 0;
+};
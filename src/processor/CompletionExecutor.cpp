@@ -0,0 +1,101 @@
+#include "processor/CompletionExecutor.h"
+
+#include <algorithm>
+#include <string>
+
+CompletionExecutor::CompletionExecutor(int threads, LatencyHistogram& wait, LatencyHistogram& run)
+    : wait_(wait)
+    , run_(run)
+{
+    for (int i = 0; i < std::max(1, threads); ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+    for (auto& shard : shards_) {
+        Shard& s = *shard;
+        s.thread = std::thread([&s] { s.loop.run(); });
+    }
+}
+
+CompletionExecutor::~CompletionExecutor() {
+    stop();
+}
+
+void CompletionExecutor::stop() {
+    for (auto& shard : shards_) shard->loop.stop();
+    for (auto& shard : shards_) {
+        if (shard->thread.joinable()) shard->thread.join();
+    }
+}
+
+void CompletionExecutor::dispatch(std::vector<TradeResult>& results, std::vector<ResultCallback>& callbacks,
+                                  std::vector<Clock::time_point>& completedAt) {
+    if (results.empty()) return;
+
+    // One thread: the whole batch goes as is
+    if (shards_.size() == 1) {
+        post(*shards_[0], new Batch{std::move(results), std::move(callbacks), std::move(completedAt)});
+    } else {
+        std::vector<Batch*> batches(shards_.size(), nullptr);
+        for (size_t i = 0; i < results.size(); ++i) {
+            size_t shard = std::hash<std::string>{}(results[i].clientId) % shards_.size();
+            Batch*& batch = batches[shard];
+            if (!batch) batch = new Batch;
+            batch->results.push_back(std::move(results[i]));
+            batch->callbacks.push_back(std::move(callbacks[i]));
+            batch->completedAt.push_back(completedAt[i]);
+        }
+        for (size_t shard = 0; shard < batches.size(); ++shard) {
+            if (batches[shard]) post(*shards_[shard], batches[shard]);
+        }
+    }
+    results.clear();
+    callbacks.clear();
+    completedAt.clear();
+}
+
+void CompletionExecutor::post(Shard& shard, Batch* batch) {
+    // Owned by the task; the loop runs every posted task before stop() returns
+    shard.loop.post([this, &shard, batch] {
+        runCallbacks(batch->results.data(), batch->callbacks.data(), batch->completedAt.data(),
+                     batch->results.size(), shard.scratch, wait_, run_);
+        delete batch;
+    });
+}
+
+void CompletionExecutor::runCallbacks(const TradeResult* results, const ResultCallback* callbacks,
+                                      const Clock::time_point* completedAt, size_t count,
+                                      SessionGroups& scratch, LatencyHistogram& wait, LatencyHistogram& run) {
+    Clock::time_point start = Clock::now();
+
+    // `start` is always when the next callback begins: its wait ends there
+    for (size_t i = 0; i < count; ++i) {
+        const ResultCallback& callback = callbacks[i];
+        if (const auto* delivery = callback.target<SessionDelivery>()) {
+            ClientSession* session = delivery->session.get();
+            auto group = std::find_if(scratch.begin(), scratch.end(),
+                                      [session](const auto& g) { return g.first == session; });
+            if (group == scratch.end()) {
+                scratch.push_back({session, {}});
+                group = std::prev(scratch.end());
+            }
+            group->second.push_back(&results[i]);
+        } else if (callback) {
+            wait.record(start - completedAt[i]);
+            callback(results[i]);
+            Clock::time_point done = Clock::now();
+            run.record(done - start);
+            start = done;
+        }
+    }
+
+    // A session group costs one lock; charge each result its share
+    for (const auto& [session, grouped] : scratch) {
+        for (const TradeResult* result : grouped) wait.record(start - completedAt[result - results]);
+        session->deliver(grouped.data(), grouped.size());
+        Clock::time_point done = Clock::now();
+        auto share = (done - start) / static_cast<int64_t>(grouped.size());
+        for (size_t i = 0; i < grouped.size(); ++i) run.record(share);
+        start = done;
+    }
+    scratch.clear();
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "models/TradeResult.h"
+#include "processor/ClientSession.h"
+#include "processor/LatencyHistogram.h"
+#include "reactor/EventLoop.h"
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/// Result callback of session submits. A named type (rather than a lambda)
+/// so whoever runs a batch of callbacks can recognise it and deliver each
+/// session's results under one session lock. It lives here, next to
+/// runCallbacks() that recognises it, rather than with the processor that
+/// creates it: the executor has no reason to depend on the processor.
+struct SessionDelivery {
+    std::shared_ptr<ClientSession> session;
+    void operator()(const TradeResult& result) const { session->deliver(result); }
+};
+
+/// Runs result callbacks on its own threads, off the processor's workers.
+///
+/// Workers hand over each flushed result batch with dispatch(), which only
+/// posts it (lock-free, see EventLoop::post) to the executor threads and
+/// returns; a slow callback then delays other callbacks on its thread, never
+/// a worker or the broker calls behind it. Results are sharded by
+/// hash(clientId), so one client's callbacks run on one thread, in the
+/// order their results were handed over.
+///
+/// Two latencies are recorded per result: `wait` (completed -> callback
+/// starts: batching plus queueing) and `run` (the callback itself).
+class CompletionExecutor {
+public:
+    using ResultCallback = std::function<void(const TradeResult&)>;
+    using Clock          = std::chrono::steady_clock;
+
+    /// Session deliveries of one batch, grouped per session (scratch space).
+    using SessionGroups = std::vector<std::pair<ClientSession*, std::vector<const TradeResult*>>>;
+
+    CompletionExecutor(int threads, LatencyHistogram& wait, LatencyHistogram& run);
+    ~CompletionExecutor();
+
+    CompletionExecutor(const CompletionExecutor&) = delete;
+    CompletionExecutor& operator=(const CompletionExecutor&) = delete;
+
+    /// Hand over a batch of completed results (moved out; the vectors are
+    /// left empty). `completedAt[i]` is when results[i] became ready.
+    void dispatch(std::vector<TradeResult>& results, std::vector<ResultCallback>& callbacks,
+                  std::vector<Clock::time_point>& completedAt);
+
+    /// Run everything handed over so far, then join the threads.
+    void stop();
+
+    int threads() const { return static_cast<int>(shards_.size()); }
+
+    /// Run a batch of callbacks in order on the calling thread, session
+    /// deliveries grouped per session (one lock each), recording both
+    /// latencies. Used by the executor threads, and by workers when there
+    /// is no executor.
+    static void runCallbacks(const TradeResult* results, const ResultCallback* callbacks,
+                             const Clock::time_point* completedAt, size_t count,
+                             SessionGroups& scratch, LatencyHistogram& wait, LatencyHistogram& run);
+
+private:
+    struct Batch {
+        std::vector<TradeResult>       results;
+        std::vector<ResultCallback>    callbacks;
+        std::vector<Clock::time_point> completedAt;
+    };
+
+    struct Shard {
+        EventLoop     loop;
+        SessionGroups scratch;
+        std::thread   thread;
+    };
+
+    void post(Shard& shard, Batch* batch);
+
+    LatencyHistogram&                   wait_;
+    LatencyHistogram&                   run_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
@@ -5,19 +5,44 @@
 #include "logger/Logger.h"
 #include "tracker/ResultTracker.h"
 #include "processor/Validator.h"
+#include "processor/ClientSession.h"
+#include "processor/CompletionExecutor.h"
+#include "processor/LatencyHistogram.h"
+#include "perf/StageCounters.h"
+#include "perf/SamplingProfiler.h"
+#include "reactor/EventLoop.h"
 #include "models/TradeRequest.h"
 #include "models/TradeResult.h"
 
 #include <vector>
+#include <algorithm>
 #include <thread>
 #include <atomic>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <chrono>
+
+/// How the processor runs requests (see BasicDealProcessor).
+enum class ExecutionModel {
+    THREADS,    // Worker pool blocking on a shared queue and on each broker call
+    REACTOR     // One event loop per core; broker calls complete asynchronously
+};
 
 /// Configuration for the Deal Processor
 struct ProcessorConfig {
+    ExecutionModel model = ExecutionModel::THREADS;
     int    numWorkers  = 4;      // Number of worker threads
     int    maxRetries  = 3;      // Max retry attempts for failed trades
     int    retryBaseMs = 100;    // Base delay for exponential backoff (ms)
+    int    validationBatchSize = 1;  // Requests a worker dequeues and validates at once
+    int    resultBatchSize = 1;      // Completed results a worker buffers before tracking/delivering
+    int    resultFlushUs   = 500;    // Longest a buffered result waits while its worker takes more work
+    int    reactorLoops    = 0;      // REACTOR: event loops (0 = one per core)
+    int    completionThreads = 0;    // Threads running result callbacks (0 = on the worker/loop)
+    bool   perfCounters    = false;  // Count cycles/instructions/misses per pipeline stage
 };
 
 /// Central Deal Processor - the core of the system.
@@ -35,12 +60,48 @@ struct ProcessorConfig {
 ///   - Queue uses mutex + condition_variable for blocking pop
 ///   - Logger uses its own mutex for output serialization
 ///   - ResultTracker uses its own mutex for result storage
-class DealProcessor {
+///   - With resultBatchSize > 1 a worker buffers completed results and
+///     flushes them together (one tracker lock, one lock per session), when
+///     the batch fills, once the oldest has waited resultFlushUs (checked
+///     whenever the worker takes more work), when it runs out of work, and
+///     before a broker call that is expected to end past the deadline. The
+///     expectation is the worker's slowest recent call (decaying by 1/8 per
+///     call; before the first call every execute flushes), so executes that
+///     fit the deadline batch too, and a result waits behind an execute
+///     only if that call is slower than the recent ones
+///   - With completionThreads > 0 a flush only records the batch in the
+///     tracker and hands it to a CompletionExecutor, whose threads run the
+///     callbacks (each client's on one thread, in order); a slow callback
+///     then never holds up a worker or a loop
+///
+/// Reactor model (config.model = REACTOR):
+///   - reactorLoops EventLoops, each on its own thread pinned to a core
+///   - submit() shards requests by hash(clientId), so one client's requests
+///     stay on one loop and are accepted in submit order; the hand-off is
+///     the loop's lock-free inbox, not a shared locked queue
+///   - a loop validates, sends via Broker::executeTradeAsync() and moves on;
+///     the broker's answer is posted back to the same loop, retry backoff is
+///     a loop timer, and results are flushed after each batch of events
+///     (resultFlushUs does not apply; resultBatchSize > 1 caps a flush) -
+///     no thread ever blocks on a broker call, so a few loops keep many
+///     requests in flight
+///   - loops still share a few locks: the validator's duplicate set, the
+///     logger, the tracker (once per flush) and whatever the broker takes
+///     (MockMTAPI serializes its random number generator)
+///
+/// Broker dispatch:
+///   BasicDealProcessor is templated on the broker type. DealProcessor
+///   (= BasicDealProcessor<IMTBrokerAPI>) calls the broker through the virtual
+///   interface and accepts any implementation. Instantiating it over a
+///   concrete, `final` broker (e.g. BasicDealProcessor<MockMTAPI>) makes every
+///   broker call in the validator and retry loop a direct, inlinable call.
+template <typename Broker>
+class BasicDealProcessor {
 public:
-    using ResultCallback = std::function<void(const TradeResult&)>;
+    using ResultCallback = CompletionExecutor::ResultCallback;
 
-    DealProcessor(IMTBrokerAPI& api, Logger& logger, const ProcessorConfig& config = {});
-    ~DealProcessor();
+    BasicDealProcessor(Broker& api, Logger& logger, const ProcessorConfig& config = {});
+    ~BasicDealProcessor();
 
     /// Start the worker thread pool
     void start();
@@ -48,32 +109,188 @@ public:
     /// Submit a trade request (thread-safe, called from client threads)
     void submit(TradeRequest request, ResultCallback callback = nullptr);
 
+    /// Open (or return the existing) result stream for `clientId`, with a
+    /// window of `credits` requests in flight or awaiting poll().
+    std::shared_ptr<ClientSession> openSession(const std::string& clientId, size_t credits = 64);
+
+    /// Session opened for `clientId`, or nullptr.
+    std::shared_ptr<ClientSession> findSession(const std::string& clientId) const;
+
+    /// Submit on a session: takes one of its credits and delivers the result
+    /// to its stream (through a SessionDelivery callback, CompletionExecutor.h).
+    /// Returns false (nothing queued) when the session is out of credits or
+    /// the processor is not running.
+    bool submit(const std::shared_ptr<ClientSession>& session, TradeRequest request);
+
     /// Graceful shutdown: stop accepting, drain queue, join workers
     void stop();
 
+    /// Process one request synchronously on the calling thread (validate ->
+    /// execute -> track), bypassing the queue. Used by benchmarks and by
+    /// callers that bring their own threading.
+    TradeResult process(const TradeRequest& request, int workerId = 0);
+
+    /// Apply configurable validation rules (nullptr = built-in checks only).
+    /// Call before start(); the engine must outlive the processor.
+    void setRules(const RuleEngine* rules) { validator_.setRules(rules); }
+
+    /// Reject requests for symbols outside their trading session before they
+    /// reach the broker (nullptr = no calendar). Call before start().
+    void setCalendar(const TradingCalendar* calendar) { validator_.setCalendar(calendar); }
+
+    /// Reload a persisted result (warm restart): tracked again and its
+    /// request ID counted as seen. Call before start().
+    void restoreResult(const TradeResult& result) {
+        tracker_.record(result);
+        validator_.markSeen(result.requestId);
+    }
+
     /// Access the result tracker for querying results
     ResultTracker& getTracker() { return tracker_; }
 
-    /// Current queue depth
-    size_t queueDepth() const { return queue_.size(); }
+    /// Current queue depth (REACTOR: requests in flight)
+    size_t queueDepth() const {
+        return config_.model == ExecutionModel::REACTOR ? inFlight_.load(std::memory_order_relaxed) : queue_.size();
+    }
+
+    /// Result batches flushed by workers (= tracker lock acquisitions on the
+    /// worker path); with resultBatchSize N this approaches requests / N.
+    uint64_t resultFlushes() const { return resultFlushes_.load(std::memory_order_relaxed); }
+
+    /// Picked up by a worker/loop -> result ready (validation, broker calls
+    /// and retries), per request.
+    const LatencyHistogram& executionLatency() const { return executionLatency_; }
+
+    /// Result ready -> its callback starts (result batching plus, with
+    /// completionThreads, the executor queue), per result.
+    const LatencyHistogram& callbackWait() const { return callbackWait_; }
+
+    /// Time spent in the callback itself, per result.
+    const LatencyHistogram& callbackRun() const { return callbackRun_; }
+
+    /// Hardware counters per pipeline stage (config.perfCounters).
+    const StageCounters& stageCounters() const { return stages_; }
 
 private:
+    /// A worker's completed results awaiting their flush (worker-local).
+    struct PendingResults {
+        std::vector<TradeResult>                  results;
+        std::vector<ResultCallback>               callbacks;
+        std::vector<std::chrono::steady_clock::time_point> completedAt;   // When each result was ready
+        std::chrono::steady_clock::time_point     deadline;   // Flush by (oldest result + resultFlushUs)
+        std::chrono::nanoseconds                  brokerCall{0};   // Expected execute time, 0 = none timed yet
+        CompletionExecutor::SessionGroups         sessions;   // Flush scratch
+    };
+
+    /// Buffer a completed result (picked up at `startedAt`); flush when the
+    /// batch is full or its oldest result has waited resultFlushUs.
+    void complete(PendingResults& pending, TradeResult&& result, ResultCallback&& callback,
+                  std::chrono::steady_clock::time_point startedAt);
+
+    /// Record the batch in the tracker (one lock), then hand it to the
+    /// completion executor, or run its callbacks here (session results
+    /// grouped per session, one lock each; other callbacks in order).
+    void flushResults(PendingResults& pending);
+
+    /// How long a worker holding `pending` may wait for more work.
+    static std::chrono::microseconds untilFlush(const PendingResults& pending);
+
+    /// Stop the completion executor once nothing can flush to it any more.
+    void stopCompletion();
+
+    /// A request moving through a reactor loop. Owned by the loop from
+    /// accept until settle (passed between events as a raw pointer).
+    struct Operation {
+        TradeRequest   request;
+        ResultCallback callback;
+        std::chrono::steady_clock::time_point startedAt;
+        int            attempt = 0;
+    };
+
+    /// One event loop of the reactor model and the state only it touches.
+    struct Reactor {
+        int            id;
+        std::string    name;       // "Loop-<id>", as workers are "Worker-<id>"
+        EventLoop      loop;
+        PendingResults pending;
+        std::thread    thread;
+    };
+
+    /// Start reactorLoops event loops; false (nothing started) if the
+    /// epoll descriptors could not be created.
+    bool startReactors();
+
+    /// Hand a request to its client's loop (REACTOR) or the queue (THREADS).
+    /// False (request dropped) if the reactor started stopping meanwhile.
+    bool dispatch(TradeRequest&& request, ResultCallback&& callback);
+
+    /// Loop side of the reactor model: validate, send, handle the answer
+    /// (retrying on a timer), then track and call back.
+    void accept(Reactor& reactor, Operation* op);
+    void send(Reactor& reactor, Operation* op);
+    void answer(Reactor& reactor, Operation* op, TradeResult&& result);
+    void settle(Reactor& reactor, Operation* op, TradeResult&& result);
+
     /// Worker thread main loop
     void workerLoop(int workerId);
 
-    /// Process a single request: validate -> execute -> retry if needed -> track
-    TradeResult processRequest(const TradeRequest& request, int workerId);
+    /// Worker loop for validationBatchSize > 1: drains up to that many queued
+    /// requests, validates them in one BasicValidator::validateBatch call,
+    /// then executes, tracks and calls back each one in order.
+    void batchWorkerLoop(int workerId);
+
+    /// Process a single request: validate -> execute -> retry if needed -> track.
+    /// A worker passes its `pending` results, flushed before the broker call.
+    TradeResult processRequest(const TradeRequest& request, int workerId, PendingResults* pending = nullptr);
+
+    /// Everything after validation: report a validation failure, or flush
+    /// `pending`, execute (with retries) and log the outcome.
+    TradeResult finishRequest(const TradeRequest& request, std::optional<TradeResult> validationError,
+                              int workerId, PendingResults* pending = nullptr);
 
     /// Execute with retry logic (bonus feature)
     TradeResult executeWithRetry(const TradeRequest& request, int workerId);
 
-    IMTBrokerAPI&                api_;
+    /// Retry helpers shared by the worker and reactor paths.
+    int  retryDelayMs(int attempt) const { return config_.retryBaseMs * (1 << (attempt - 1)); }
+    void logRetry(const std::string& name, const TradeRequest& request, int attempt, int delayMs);
+    void giveUp(TradeResult& result) const;
+    void logOutcome(const std::string& name, const TradeResult& result);
+
+    Broker&                      api_;
     Logger&                      logger_;
     ProcessorConfig              config_;
+
+    // Throttled log call sites (limits configurable via "log.site.<name>.*")
+    LogSite&                     receivedSite_;    // processor.received  - per-request INFO
+    LogSite&                     traceSite_;       // processor.trace     - per-stage INFO
+    LogSite&                     transientSite_;   // processor.transient - WARN per transient failure
+    LogSite&                     retrySite_;       // processor.retry     - WARN per retry attempt
+
     ResultTracker                tracker_;
-    Validator                    validator_;
+    BasicValidator<Broker>       validator_;
 
     ThreadSafeQueue<std::pair<TradeRequest, ResultCallback>> queue_;
     std::vector<std::thread>     workers_;
     std::atomic<bool>            running_{false};
+    std::atomic<uint64_t>        resultFlushes_{0};
+
+    std::unique_ptr<CompletionExecutor> completion_;   // completionThreads > 0
+    LatencyHistogram             executionLatency_;
+    LatencyHistogram             callbackWait_;
+    LatencyHistogram             callbackRun_;
+    StageCounters                stages_;
+
+    std::vector<std::unique_ptr<Reactor>> reactors_;
+    std::atomic<size_t>          inFlight_{0};      // REACTOR: accepted, not yet settled
+    std::mutex                   drainMutex_;
+    std::condition_variable      drained_;
+
+    mutable std::mutex                                               sessionsMutex_;
+    std::unordered_map<std::string, std::shared_ptr<ClientSession>> sessions_;
 };
+
+/// Virtual-dispatch processor over any IMTBrokerAPI (the default).
+using DealProcessor = BasicDealProcessor<IMTBrokerAPI>;
+
+extern template class BasicDealProcessor<IMTBrokerAPI>;
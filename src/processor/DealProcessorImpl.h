@@ -0,0 +1,558 @@
+#pragma once
+
+// Member definitions for BasicDealProcessor<Broker>.
+//
+// Included by DealProcessor.cpp, which explicitly instantiates the processor
+// for IMTBrokerAPI (virtual dispatch) and MockMTAPI (static dispatch). A
+// translation unit that wants static dispatch over another concrete broker
+// includes this header and adds its own explicit instantiation.
+
+#include "processor/DealProcessor.h"
+
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+
+template <typename Broker>
+BasicDealProcessor<Broker>::BasicDealProcessor(Broker& api, Logger& logger, const ProcessorConfig& config)
+    : api_(api)
+    , logger_(logger)
+    , config_(config)
+    , receivedSite_(logger.site("processor.received"))
+    , traceSite_(logger.site("processor.trace"))
+    , transientSite_(logger.site("processor.transient", {20.0, 50.0, 1.0}))
+    , retrySite_(logger.site("processor.retry", {20.0, 50.0, 1.0}))
+    , validator_(api, logger)
+    , stages_(config.perfCounters)
+{}
+
+template <typename Broker>
+BasicDealProcessor<Broker>::~BasicDealProcessor() {
+    if (running_) {
+        stop();
+    }
+}
+
+template <typename Broker>
+void BasicDealProcessor<Broker>::start() {
+    if (running_) return;
+
+    running_ = true;
+    if (config_.completionThreads > 0) {
+        completion_ = std::make_unique<CompletionExecutor>(config_.completionThreads, callbackWait_, callbackRun_);
+        logger_.info("DealProcessor running result callbacks on " +
+                     std::to_string(config_.completionThreads) + " completion threads");
+    }
+    if (config_.model == ExecutionModel::REACTOR) {
+        if (startReactors()) return;
+        logger_.error("DealProcessor could not create event loops - falling back to worker threads");
+        config_.model = ExecutionModel::THREADS;
+    }
+    logger_.info("DealProcessor starting with " + std::to_string(config_.numWorkers) + " worker threads");
+
+    workers_.reserve(config_.numWorkers);
+    auto loop = config_.validationBatchSize > 1 ? &BasicDealProcessor::batchWorkerLoop
+                                                : &BasicDealProcessor::workerLoop;
+    for (int i = 0; i < config_.numWorkers; ++i) {
+        workers_.emplace_back(loop, this, i);
+    }
+
+    logger_.info("DealProcessor started successfully");
+}
+
+template <typename Broker>
+bool BasicDealProcessor<Broker>::startReactors() {
+    int loops = config_.reactorLoops > 0 ? config_.reactorLoops
+                                         : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (int i = 0; i < loops; ++i) {
+        auto reactor = std::make_unique<Reactor>();
+        if (!reactor->loop.valid()) {
+            reactors_.clear();
+            return false;
+        }
+        reactor->id = i;
+        reactor->name = "Loop-" + std::to_string(i);
+        reactors_.push_back(std::move(reactor));
+    }
+
+    logger_.info("DealProcessor starting with " + std::to_string(loops) + " event loops (reactor)");
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    for (auto& reactor : reactors_) {
+        Reactor& r = *reactor;
+        r.loop.setIdleHook([this, &r] { flushResults(r.pending); });
+        r.thread = std::thread([this, &r] {
+            SamplingProfiler::ThreadRegistration profiled;
+            logger_.info(r.name + " started");
+            r.loop.run();
+            logger_.info(r.name + " stopped (" + std::to_string(r.loop.wakeups()) + " wakeups)");
+        });
+
+        // One loop per core: keep each on its own CPU (best effort)
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(static_cast<unsigned>(r.id) % cores, &cpus);
+        if (int rc = pthread_setaffinity_np(r.thread.native_handle(), sizeof(cpus), &cpus); rc != 0) {
+            logger_.warn(r.name + " not pinned to CPU " + std::to_string(r.id % cores) + ": " +
+                         std::strerror(rc));
+        }
+    }
+
+    logger_.info("DealProcessor started successfully");
+    return true;
+}
+
+template <typename Broker>
+bool BasicDealProcessor<Broker>::dispatch(TradeRequest&& request, ResultCallback&& callback) {
+    if (config_.model != ExecutionModel::REACTOR) {
+        queue_.push({std::move(request), std::move(callback)});
+        return true;
+    }
+
+    // Count the request before the second look at running_: stop() clears
+    // running_ before it waits for inFlight_ to drain, so either it waits
+    // for this request or this request sees it stopping (both seq_cst)
+    inFlight_.fetch_add(1);
+    if (!running_) {
+        if (inFlight_.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(drainMutex_);
+            drained_.notify_all();
+        }
+        return false;
+    }
+    Reactor& reactor = *reactors_[std::hash<std::string>{}(request.clientId) % reactors_.size()];
+    auto* op = new Operation{std::move(request), std::move(callback), {}};
+    reactor.loop.post([this, &reactor, op] { accept(reactor, op); });
+    return true;
+}
+
+template <typename Broker>
+void BasicDealProcessor<Broker>::submit(TradeRequest request, ResultCallback callback) {
+    if (!running_) {
+        logger_.error("Cannot submit request - processor not running: " + request.requestId);
+        return;
+    }
+
+    if (logger_.admit(receivedSite_, LogLevel::INFO)) {
+        logger_.info("Request received: " + request.toString());
+    }
+    std::string requestId = request.requestId;
+    if (!dispatch(std::move(request), std::move(callback))) {
+        logger_.error("Cannot submit request - processor stopping: " + requestId);
+    }
+}
+
+template <typename Broker>
+std::shared_ptr<ClientSession> BasicDealProcessor<Broker>::openSession(const std::string& clientId, size_t credits) {
+    std::lock_guard<std::mutex> lock(sessionsMutex_);
+    auto& session = sessions_[clientId];
+    if (!session) session = std::make_shared<ClientSession>(clientId, credits);
+    return session;
+}
+
+template <typename Broker>
+std::shared_ptr<ClientSession> BasicDealProcessor<Broker>::findSession(const std::string& clientId) const {
+    std::lock_guard<std::mutex> lock(sessionsMutex_);
+    auto it = sessions_.find(clientId);
+    return it == sessions_.end() ? nullptr : it->second;
+}
+
+template <typename Broker>
+bool BasicDealProcessor<Broker>::submit(const std::shared_ptr<ClientSession>& session, TradeRequest request) {
+    if (!running_) {
+        logger_.error("Cannot submit request - processor not running: " + request.requestId);
+        return false;
+    }
+    if (!session->tryAcquire()) return false;
+
+    if (logger_.admit(receivedSite_, LogLevel::INFO)) {
+        logger_.info("Request received: " + request.toString());
+    }
+    std::string requestId = request.requestId;
+    if (!dispatch(std::move(request), SessionDelivery{session})) {
+        session->release();
+        logger_.error("Cannot submit request - processor stopping: " + requestId);
+        return false;
+    }
+    return true;
+}
+
+template <typename Broker>
+void BasicDealProcessor<Broker>::stop() {
+    if (!running_) return;
+
+    if (config_.model == ExecutionModel::REACTOR) {
+        logger_.info("DealProcessor shutting down... draining loops (" +
+                     std::to_string(inFlight_.load()) + " in flight)");
+        running_ = false;
+        {
+            std::unique_lock<std::mutex> lock(drainMutex_);
+            drained_.wait(lock, [this] { return inFlight_.load() == 0; });
+        }
+        for (auto& reactor : reactors_) reactor->loop.stop();
+        for (auto& reactor : reactors_) {
+            if (reactor->thread.joinable()) reactor->thread.join();
+        }
+        reactors_.clear();
+        stopCompletion();
+
+        logger_.reportSuppressed();
+        logger_.info("DealProcessor stopped. All event loops joined.");
+        return;
+    }
+
+    logger_.info("DealProcessor shutting down... draining queue (" +
+                 std::to_string(queue_.size()) + " pending)");
+
+    running_ = false;
+    queue_.shutdown();
+
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+    stopCompletion();
+
+    logger_.reportSuppressed();
+    logger_.info("DealProcessor stopped. All workers joined.");
+}
+
+template <typename Broker>
+void BasicDealProcessor<Broker>::stopCompletion() {
+    if (!completion_) return;
+    completion_->stop();   // Runs every callback already handed over
+    completion_.reset();
+}
+
+template <typename Broker>
+TradeResult BasicDealProcessor<Broker>::process(const TradeRequest& request, int workerId) {
+    TradeResult result = processRequest(request, workerId);
+    tracker_.record(result);
+    return result;
+}
+
+template <typename Broker>
+void BasicDealProcessor<Broker>::accept(Reactor& reactor, Operation* op) {
+    op->startedAt = std::chrono::steady_clock::now();
+    if (logger_.admit(traceSite_, LogLevel::INFO)) {
+        logger_.info(reactor.name + " validating: " + op->request.requestId);
+    }
+    std::optional<TradeResult> validationError;
+    {
+        StageCounters::Scope stage(stages_, PipelineStage::VALIDATE);
+        validationError = validator_.validate(op->request);
+    }
+    if (validationError) {
+        validationError->symbol = op->request.symbol;
+        logger_.warn(reactor.name + " validation failed: " + validationError->toString());
+        settle(reactor, op, std::move(*validationError));
+        return;
+    }
+    if (logger_.admit(traceSite_, LogLevel::INFO)) {
+        logger_.info(reactor.name + " validation passed: " + op->request.requestId);
+    }
+    send(reactor, op);
+}
+
+template <typename Broker>
+void BasicDealProcessor<Broker>::send(Reactor& reactor, Operation* op) {
+    StageCounters::Scope stage(stages_, PipelineStage::EXECUTE, 0);   // Counted once, when answered
+    if (logger_.admit(traceSite_, LogLevel::INFO)) {
+        logger_.info(reactor.name + " executing via MT API (DealerSend): " + op->request.toString());
+    }
+    // The answer may arrive on a broker thread: hand it back to this loop
+    api_.executeTradeAsync(op->request, [this, &reactor, op](TradeResult result) {
+        reactor.loop.post([this, &reactor, op, result = std::move(result)]() mutable {
+            answer(reactor, op, std::move(result));
+        });
+    });
+}
+
+template <typename Broker>
+void BasicDealProcessor<Broker>::answer(Reactor& reactor, Operation* op, TradeResult&& result) {
+    StageCounters::Scope stage(stages_, PipelineStage::EXECUTE);
+    result.retryCount = op->attempt;
+    if (result.isSuccess() || !result.isRetryable()) {
+        logOutcome(reactor.name, result);
+        settle(reactor, op, std::move(result));
+        return;
+    }
+
+    if (logger_.admit(transientSite_, LogLevel::WARN)) {
+        logger_.warn(reactor.name + " transient failure: " + result.errorMessage);
+    }
+    if (op->attempt >= config_.maxRetries) {
+        giveUp(result);
+        logOutcome(reactor.name, result);
+        settle(reactor, op, std::move(result));
+        return;
+    }
+
+    // Back off on a loop timer instead of sleeping the thread
+    stage.setItems(0);
+    int delayMs = retryDelayMs(++op->attempt);
+    logRetry(reactor.name, op->request, op->attempt, delayMs);
+    reactor.loop.runAfter(std::chrono::milliseconds(delayMs), [this, &reactor, op] { send(reactor, op); });
+}
+
+template <typename Broker>
+void BasicDealProcessor<Broker>::settle(Reactor& reactor, Operation* op, TradeResult&& result) {
+    result.symbol = op->request.symbol;
+    // Buffered until the loop has handled its current batch of events (the
+    // idle hook flushes), or until resultBatchSize results are waiting
+    auto now = std::chrono::steady_clock::now();
+    executionLatency_.record(now - op->startedAt);
+    PendingResults& pending = reactor.pending;
+    pending.results.push_back(std::move(result));
+    pending.callbacks.push_back(std::move(op->callback));
+    pending.completedAt.push_back(now);
+    if (config_.resultBatchSize > 1 && pending.results.size() >= static_cast<size_t>(config_.resultBatchSize)) {
+        flushResults(pending);
+    }
+    delete op;
+    if (inFlight_.fetch_sub(1, std::memory_order_acq_rel) == 1 && !running_) {
+        std::lock_guard<std::mutex> lock(drainMutex_);
+        drained_.notify_all();
+    }
+}
+
+template <typename Broker>
+void BasicDealProcessor<Broker>::workerLoop(int workerId) {
+    std::string workerName = "Worker-" + std::to_string(workerId);
+    SamplingProfiler::ThreadRegistration profiled;
+    logger_.info(workerName + " started");
+
+    PendingResults pending;
+    while (true) {
+        // Holding results: wait no longer than their flush deadline
+        auto item = pending.results.empty() ? queue_.pop() : queue_.popFor(untilFlush(pending));
+        if (!item) {
+            flushResults(pending);
+            if (queue_.closed()) break;   // Queue shutdown signaled and empty
+            continue;
+        }
+
+        auto& [request, callback] = *item;
+        auto startedAt = std::chrono::steady_clock::now();
+        if (!pending.results.empty() && startedAt >= pending.deadline) flushResults(pending);
+        TradeResult result = processRequest(request, workerId, &pending);
+
+        // Track result and notify the client (batched per resultBatchSize)
+        complete(pending, std::move(result), std::move(callback), startedAt);
+    }
+
+    logger_.info(workerName + " stopped");
+}
+
+template <typename Broker>
+void BasicDealProcessor<Broker>::batchWorkerLoop(int workerId) {
+    std::string workerName = "Worker-" + std::to_string(workerId);
+    SamplingProfiler::ThreadRegistration profiled;
+    logger_.info(workerName + " started (validation batch " +
+                 std::to_string(config_.validationBatchSize) + ")");
+
+    const size_t batchSize = static_cast<size_t>(config_.validationBatchSize);
+    std::vector<std::pair<TradeRequest, ResultCallback>> batch;
+    std::vector<const TradeRequest*> requests;
+    std::vector<std::optional<TradeResult>> validation;
+    typename BasicValidator<Broker>::BatchScratch scratch;
+    batch.reserve(batchSize);
+    requests.reserve(batchSize);
+
+    PendingResults pending;
+    while (true) {
+        batch.clear();
+        bool popped = pending.results.empty() ? queue_.popBatch(batch, batchSize)
+                                              : queue_.popBatchFor(batch, batchSize, untilFlush(pending));
+        if (!popped) {
+            flushResults(pending);
+            if (queue_.closed()) break;   // Queue shutdown signaled and empty
+            continue;
+        }
+
+        if (!pending.results.empty() && std::chrono::steady_clock::now() >= pending.deadline) {
+            flushResults(pending);
+        }
+        // The first request's time includes validating the batch; each
+        // later one starts when the one before it is done
+        auto startedAt = std::chrono::steady_clock::now();
+        requests.clear();
+        for (auto& item : batch) requests.push_back(&item.first);
+        {
+            StageCounters::Scope stage(stages_, PipelineStage::VALIDATE, requests.size());
+            validator_.validateBatch(requests, validation, scratch);
+        }
+
+        for (size_t i = 0; i < batch.size(); ++i) {
+            auto& [request, callback] = batch[i];
+            TradeResult result = finishRequest(request, std::move(validation[i]), workerId, &pending);
+            complete(pending, std::move(result), std::move(callback), startedAt);
+            startedAt = std::chrono::steady_clock::now();
+        }
+    }
+
+    logger_.info(workerName + " stopped");
+}
+
+template <typename Broker>
+void BasicDealProcessor<Broker>::complete(PendingResults& pending, TradeResult&& result, ResultCallback&& callback,
+                                          std::chrono::steady_clock::time_point startedAt) {
+    auto now = std::chrono::steady_clock::now();
+    executionLatency_.record(now - startedAt);
+    if (pending.results.empty()) {
+        pending.deadline = now + std::chrono::microseconds(config_.resultFlushUs);
+    }
+    pending.results.push_back(std::move(result));
+    pending.callbacks.push_back(std::move(callback));
+    pending.completedAt.push_back(now);
+    if (pending.results.size() >= static_cast<size_t>(config_.resultBatchSize) || now >= pending.deadline) {
+        flushResults(pending);
+    }
+}
+
+template <typename Broker>
+void BasicDealProcessor<Broker>::flushResults(PendingResults& pending) {
+    if (pending.results.empty()) return;
+    StageCounters::Scope stage(stages_, PipelineStage::FLUSH, pending.results.size());
+    tracker_.record(pending.results.data(), pending.results.size());
+    resultFlushes_.fetch_add(1, std::memory_order_relaxed);
+
+    if (completion_) {
+        completion_->dispatch(pending.results, pending.callbacks, pending.completedAt);
+        return;
+    }
+    CompletionExecutor::runCallbacks(pending.results.data(), pending.callbacks.data(), pending.completedAt.data(),
+                                     pending.results.size(), pending.sessions, callbackWait_, callbackRun_);
+    pending.results.clear();
+    pending.callbacks.clear();
+    pending.completedAt.clear();
+}
+
+template <typename Broker>
+std::chrono::microseconds BasicDealProcessor<Broker>::untilFlush(const PendingResults& pending) {
+    auto left = std::chrono::duration_cast<std::chrono::microseconds>(
+        pending.deadline - std::chrono::steady_clock::now());
+    return std::max(left, std::chrono::microseconds(0));
+}
+
+template <typename Broker>
+TradeResult BasicDealProcessor<Broker>::processRequest(const TradeRequest& request, int workerId,
+                                                       PendingResults* pending) {
+    std::string workerName = "Worker-" + std::to_string(workerId);
+
+    // Step 1: Validate the request before hitting the MT API
+    if (logger_.admit(traceSite_, LogLevel::INFO)) {
+        logger_.info(workerName + " validating: " + request.requestId);
+    }
+    std::optional<TradeResult> validationError;
+    {
+        StageCounters::Scope stage(stages_, PipelineStage::VALIDATE);
+        validationError = validator_.validate(request);
+    }
+    return finishRequest(request, std::move(validationError), workerId, pending);
+}
+
+template <typename Broker>
+TradeResult BasicDealProcessor<Broker>::finishRequest(const TradeRequest& request,
+                                                      std::optional<TradeResult> validationError,
+                                                      int workerId, PendingResults* pending) {
+    std::string workerName = "Worker-" + std::to_string(workerId);
+
+    if (validationError) {
+        validationError->symbol = request.symbol;
+        logger_.warn(workerName + " validation failed: " + validationError->toString());
+        return *validationError;
+    }
+    if (logger_.admit(traceSite_, LogLevel::INFO)) {
+        logger_.info(workerName + " validation passed: " + request.requestId);
+    }
+
+    // Step 2: Execute trade (with retry logic for transient failures). If
+    // the call is expected to end past the flush deadline, deliver what is
+    // buffered first
+    auto callStart = std::chrono::steady_clock::now();
+    if (pending && !pending->results.empty() &&
+        (pending->brokerCall.count() == 0 || callStart + pending->brokerCall >= pending->deadline)) {
+        flushResults(*pending);
+        callStart = std::chrono::steady_clock::now();
+    }
+    StageCounters::Scope stage(stages_, PipelineStage::EXECUTE);
+    TradeResult result = executeWithRetry(request, workerId);
+    result.symbol = request.symbol;
+    if (pending) {
+        // Slowest recent call: a slow call raises it at once, fast ones lower it by 1/8
+        auto took = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - callStart);
+        pending->brokerCall = std::max(took, pending->brokerCall - pending->brokerCall / 8);
+    }
+
+    // Step 3: Log the final result
+    logOutcome(workerName, result);
+    return result;
+}
+
+template <typename Broker>
+void BasicDealProcessor<Broker>::logOutcome(const std::string& name, const TradeResult& result) {
+    if (result.isSuccess()) {
+        if (logger_.isEnabled(LogLevel::INFO)) {
+            logger_.info(name + " EXECUTED: " + result.toString());
+        }
+    } else {
+        logger_.error(name + " FAILED: " + result.toString());
+    }
+}
+
+template <typename Broker>
+void BasicDealProcessor<Broker>::logRetry(const std::string& name, const TradeRequest& request,
+                                          int attempt, int delayMs) {
+    if (logger_.admit(retrySite_, LogLevel::WARN)) {
+        logger_.warn(name + " retrying " + request.requestId +
+                     " (attempt " + std::to_string(attempt + 1) + "/" +
+                     std::to_string(config_.maxRetries + 1) +
+                     ", delay=" + std::to_string(delayMs) + "ms)");
+    }
+}
+
+template <typename Broker>
+void BasicDealProcessor<Broker>::giveUp(TradeResult& result) const {
+    result.status = TradeStatus::RETRY_EXHAUSTED;
+    result.errorMessage = "All " + std::to_string(config_.maxRetries + 1) +
+                          " attempts failed. Last error: " + result.errorMessage;
+    result.retryCount = config_.maxRetries;
+}
+
+template <typename Broker>
+TradeResult BasicDealProcessor<Broker>::executeWithRetry(const TradeRequest& request, int workerId) {
+    std::string workerName = "Worker-" + std::to_string(workerId);
+    TradeResult result;
+
+    for (int attempt = 0; attempt <= config_.maxRetries; ++attempt) {
+        if (attempt > 0) {
+            // Exponential backoff: 100ms, 200ms, 400ms, ...
+            int delayMs = retryDelayMs(attempt);
+            logRetry(workerName, request, attempt, delayMs);
+            std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+        }
+
+        // Call MT API: DealerSend equivalent
+        if (logger_.admit(traceSite_, LogLevel::INFO)) {
+            logger_.info(workerName + " executing via MT API (DealerSend): " + request.toString());
+        }
+        result = api_.executeTrade(request);
+        result.retryCount = attempt;
+
+        if (result.isSuccess() || !result.isRetryable()) {
+            // Success or permanent failure - don't retry
+            return result;
+        }
+
+        // Transient failure - will retry
+        if (logger_.admit(transientSite_, LogLevel::WARN)) {
+            logger_.warn(workerName + " transient failure: " + result.errorMessage);
+        }
+    }
+
+    // All retries exhausted
+    giveUp(result);
+    return result;
+}
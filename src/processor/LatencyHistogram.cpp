@@ -0,0 +1,62 @@
+#include "processor/LatencyHistogram.h"
+#include "format/TextWriter.h"
+
+#include <algorithm>
+
+int LatencyHistogram::bucketFor(uint64_t ns) {
+    if (ns < SUB_BUCKETS) return static_cast<int>(ns);
+    int msb = 63 - __builtin_clzll(ns);
+    int sub = static_cast<int>((ns >> (msb - 2)) & (SUB_BUCKETS - 1));
+    return (msb - 1) * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::upperBoundNs(int bucket) {
+    if (bucket < SUB_BUCKETS) return static_cast<uint64_t>(bucket);
+    int msb = bucket / SUB_BUCKETS + 1;
+    int sub = bucket % SUB_BUCKETS;
+    return (static_cast<uint64_t>(SUB_BUCKETS + sub + 1) << (msb - 2)) - 1;
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds latency) {
+    uint64_t ns = latency.count() > 0 ? static_cast<uint64_t>(latency.count()) : 0;
+    buckets_[bucketFor(ns)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    totalNs_.fetch_add(ns, std::memory_order_relaxed);
+
+    uint64_t max = maxNs_.load(std::memory_order_relaxed);
+    while (ns > max && !maxNs_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+    }
+}
+
+double LatencyHistogram::meanUs() const {
+    uint64_t n = count();
+    return n ? totalNs_.load(std::memory_order_relaxed) / 1000.0 / n : 0.0;
+}
+
+double LatencyHistogram::percentileUs(double fraction) const {
+    uint64_t n = count();
+    if (n == 0) return 0.0;
+    uint64_t rank = static_cast<uint64_t>(fraction * n);
+    if (rank >= n) rank = n - 1;
+
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < BUCKETS; ++bucket) {
+        seen += buckets_[bucket].load(std::memory_order_relaxed);
+        if (seen > rank) {
+            // Never report beyond the largest sample actually seen
+            uint64_t bound = std::min(upperBoundNs(bucket), maxNs_.load(std::memory_order_relaxed));
+            return bound / 1000.0;
+        }
+    }
+    return maxUs();
+}
+
+std::string LatencyHistogram::summary() const {
+    return TextWriter::render([&](TextWriter& out) {
+        out.append("n=").appendUInt(count())
+           .append(" mean=").appendFixed(meanUs(), 1).append("us")
+           .append(" p50=").appendFixed(percentileUs(0.50), 1).append("us")
+           .append(" p99=").appendFixed(percentileUs(0.99), 1).append("us")
+           .append(" max=").appendFixed(maxUs(), 1).append("us");
+    });
+}
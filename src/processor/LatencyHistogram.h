@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/// Lock-free latency histogram, safe to record() from any number of threads.
+///
+/// Buckets are log-linear: four per power of two of nanoseconds, so a
+/// percentile is reported as its bucket's upper bound, at most 25% above the
+/// true value. Counts use relaxed atomics; a reader sees a consistent-enough
+/// picture for reporting, not a snapshot.
+class LatencyHistogram {
+public:
+    void record(std::chrono::nanoseconds latency);
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    double   meanUs() const;
+    double   maxUs() const { return maxNs_.load(std::memory_order_relaxed) / 1000.0; }
+
+    /// Latency at or below which `fraction` (0..1) of the samples fall (upper
+    /// bucket bound, in microseconds). 0 if nothing was recorded.
+    double percentileUs(double fraction) const;
+
+    /// "n=1200 mean=35.2us p50=32.0us p99=120.0us max=410.3us"
+    std::string summary() const;
+
+private:
+    static constexpr int SUB_BUCKETS = 4;
+    static constexpr int BUCKETS     = 64 * SUB_BUCKETS;
+
+    static int      bucketFor(uint64_t ns);
+    static uint64_t upperBoundNs(int bucket);
+
+    std::array<std::atomic<uint64_t>, BUCKETS> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> totalNs_{0};
+    std::atomic<uint64_t> maxNs_{0};
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+/// Set of request IDs seen so far, for duplicate detection.
+///
+/// Open addressing with linear probing over a flat array of hashes: a
+/// lookup touches one or two cache lines of 8-byte hashes and compares a
+/// stored ID only when the full 64-bit hash matches. The IDs themselves are
+/// appended back to back to one byte buffer; growing re-slots the stored
+/// hashes without rehashing any ID. Unlike a node-based unordered_set there
+/// is no allocation and no pointer chase per insert.
+///
+/// The hash is exposed so callers can compute it before taking their lock
+/// and prefetch the slot of the next insert while doing the current one.
+///
+/// Not thread-safe: the validator guards it with its dedup mutex.
+class RequestIdSet {
+public:
+    RequestIdSet() { rebuild(1024); }
+
+    static uint64_t hash(const std::string& id) {
+        uint64_t h = std::hash<std::string>{}(id);
+        return h ? h : 1;   // 0 marks an empty slot
+    }
+
+    /// Pull the slot for `hash` into cache ahead of insert().
+    void prefetch(uint64_t hash) const {
+        __builtin_prefetch(&hashes_[hash & mask_]);
+    }
+
+    /// Add `id` (whose hash() is `hash`). False if it was already present.
+    bool insert(const std::string& id, uint64_t hash) {
+        size_t slot = hash & mask_;
+        while (uint64_t stored = hashes_[slot]) {
+            if (stored == hash && equals(index_[slot], id)) return false;
+            slot = (slot + 1) & mask_;
+        }
+        hashes_[slot] = hash;
+        index_[slot]  = static_cast<uint32_t>(ends_.size());
+        bytes_.insert(bytes_.end(), id.begin(), id.end());
+        ends_.push_back(bytes_.size());
+        if (ends_.size() * 2 > hashes_.size()) rebuild(hashes_.size() * 2);
+        return true;
+    }
+
+    bool insert(const std::string& id) { return insert(id, hash(id)); }
+
+    size_t size() const { return ends_.size(); }
+
+private:
+    /// True if stored ID number `index` is `id`.
+    bool equals(uint32_t index, const std::string& id) const {
+        uint64_t begin = index ? ends_[index - 1] : 0;
+        return ends_[index] - begin == id.size() &&
+               std::memcmp(bytes_.data() + begin, id.data(), id.size()) == 0;
+    }
+
+    /// Re-slot every stored hash into a table of `slots` entries (power of two).
+    void rebuild(size_t slots) {
+        std::vector<uint64_t> hashes(slots, 0);
+        std::vector<uint32_t> index(slots, 0);
+        size_t mask = slots - 1;
+        for (size_t i = 0; i < hashes_.size(); ++i) {
+            if (!hashes_[i]) continue;
+            size_t slot = hashes_[i] & mask;
+            while (hashes[slot]) slot = (slot + 1) & mask;
+            hashes[slot] = hashes_[i];
+            index[slot]  = index_[i];
+        }
+        hashes_.swap(hashes);
+        index_.swap(index);
+        mask_ = mask;
+    }
+
+    std::vector<uint64_t>    hashes_;   // Per slot: the ID's hash, 0 = empty
+    std::vector<uint32_t>    index_;    // Per slot: number of the stored ID
+    std::vector<char>        bytes_;    // Stored IDs, back to back
+    std::vector<uint64_t>    ends_;     // Per stored ID: its end offset in bytes_
+    size_t                   mask_ = 0;
+};
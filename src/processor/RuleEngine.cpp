@@ -0,0 +1,375 @@
+#include "processor/RuleEngine.h"
+
+#include <sstream>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+enum class RuleScope { GLOBAL, SYMBOL, CLIENT };
+
+struct ParsedRule {
+    RuleScope   scope = RuleScope::GLOBAL;
+    std::string scopeName;
+    bool        isSet = false;
+    CompiledRule numeric{};
+    SetRule      set{};
+};
+
+static bool parseFeature(const std::string& field, RuleFeature& feature) {
+    if (field == "volume")      { feature = RuleFeature::VOLUME;      return true; }
+    if (field == "notional")    { feature = RuleFeature::NOTIONAL;    return true; }
+    if (field == "stop_loss")   { feature = RuleFeature::STOP_LOSS;   return true; }
+    if (field == "take_profit") { feature = RuleFeature::TAKE_PROFIT; return true; }
+    return false;
+}
+
+/// `op threshold` as the closed interval of passing values.
+static bool toInterval(const std::string& op, double t, double& lo, double& hi) {
+    lo = -HUGE_VAL;
+    hi =  HUGE_VAL;
+    if      (op == "<")  hi = std::nextafter(t, -HUGE_VAL);
+    else if (op == "<=") hi = t;
+    else if (op == ">")  lo = std::nextafter(t, HUGE_VAL);
+    else if (op == ">=") lo = t;
+    else if (op == "==") lo = hi = t;
+    else return false;
+    return true;
+}
+
+static std::unordered_set<std::string> parseList(const std::string& text) {
+    std::unordered_set<std::string> values;
+    std::istringstream in(text);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        size_t first = item.find_first_not_of(" \t");
+        if (first == std::string::npos) continue;
+        size_t last = item.find_last_not_of(" \t");
+        values.insert(item.substr(first, last - first + 1));
+    }
+    return values;
+}
+
+/// Parse "<field> <op> <value...> [for symbol|client <name>]".
+static bool parseRule(const std::string& text, uint32_t source, std::string& field,
+                      ParsedRule& rule, std::string& error) {
+    std::istringstream in(text);
+    std::vector<std::string> tokens;
+    for (std::string token; in >> token; ) tokens.push_back(token);
+
+    size_t valueEnd = tokens.size();
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        if (tokens[i] == "for") { valueEnd = i; break; }
+    }
+    if (valueEnd < 3) {
+        error = "expected '<field> <op> <value>'";
+        return false;
+    }
+
+    if (valueEnd < tokens.size()) {
+        if (valueEnd + 3 != tokens.size()) {
+            error = "expected 'for symbol <name>' or 'for client <name>'";
+            return false;
+        }
+        const std::string& kind = tokens[valueEnd + 1];
+        if      (kind == "symbol") rule.scope = RuleScope::SYMBOL;
+        else if (kind == "client") rule.scope = RuleScope::CLIENT;
+        else {
+            error = "unknown scope '" + kind + "'";
+            return false;
+        }
+        rule.scopeName = tokens[valueEnd + 2];
+    }
+
+    field = tokens[0];
+    const std::string& op = tokens[1];
+    std::string value = tokens[2];
+    for (size_t i = 3; i < valueEnd; ++i) value += " " + tokens[i];
+
+    if (field == "symbol" || field == "client") {
+        if (op != "in" && op != "not_in") {
+            error = "'" + field + "' supports only 'in' and 'not_in'";
+            return false;
+        }
+        rule.isSet        = true;
+        rule.set.onClient = (field == "client");
+        rule.set.negate   = (op == "not_in");
+        rule.set.values   = parseList(value);
+        rule.set.source   = source;
+        return true;
+    }
+
+    RuleFeature feature;
+    if (!parseFeature(field, feature)) {
+        error = "unknown field '" + field + "'";
+        return false;
+    }
+    char* end = nullptr;
+    double threshold = std::strtod(value.c_str(), &end);
+    if (end == value.c_str() || *end != '\0' || std::isnan(threshold)) {
+        error = "invalid number '" + value + "'";
+        return false;
+    }
+    rule.numeric.feature = feature;
+    rule.numeric.source  = source;
+    if (!toInterval(op, threshold, rule.numeric.lo, rule.numeric.hi)) {
+        error = "unknown operator '" + op + "'";
+        return false;
+    }
+    return true;
+}
+
+static void setBit(std::vector<uint64_t>& bits, int id) {
+    if (bits.size() <= static_cast<size_t>(id / 64)) bits.resize(id / 64 + 1, 0);
+    bits[id / 64] |= uint64_t{1} << (id % 64);
+}
+
+/// Add `rule` to a table. For a table that serves exactly one symbol
+/// (`fixedSymbol` non-null), symbol set rules are decided here.
+static void addToTable(RuleTable& table, const ParsedRule& rule, const std::string* fixedSymbol) {
+    if (!rule.isSet) {
+        table.numeric.push_back(rule.numeric);
+        return;
+    }
+    if (!rule.set.onClient && fixedSymbol) {
+        bool passes = (rule.set.values.count(*fixedSymbol) != 0) != rule.set.negate;
+        if (!passes && table.alwaysFails < 0) table.alwaysFails = static_cast<int32_t>(rule.set.source);
+        return;
+    }
+    table.sets.push_back(rule.set);
+}
+
+std::shared_ptr<const RuleProgram> RuleProgram::compile(const ConfigFile& config, std::string& error) {
+    auto program = std::make_shared<RuleProgram>();
+
+    std::vector<ParsedRule> parsed;
+    for (const auto& key : config.keysWithPrefix("rule.")) {
+        RuleDefinition def;
+        def.name = key.substr(5);
+        def.text = config.getString(key);
+
+        ParsedRule rule;
+        std::string why;
+        if (!parseRule(def.text, static_cast<uint32_t>(program->definitions_.size()),
+                       def.field, rule, why)) {
+            error = key + ": " + why;
+            return nullptr;
+        }
+        program->definitions_.push_back(std::move(def));
+        parsed.push_back(std::move(rule));
+    }
+
+    // Dense client IDs for every client a rule names (scope or set member).
+    auto clientId = [&](const std::string& name) {
+        auto [it, inserted] = program->clientIds_.emplace(name, static_cast<int>(program->clientIds_.size()));
+        if (inserted) program->clientNames_.push_back(name);
+        return it->second;
+    };
+    for (auto& rule : parsed) {
+        if (rule.scope == RuleScope::CLIENT) clientId(rule.scopeName);
+        if (!rule.isSet) continue;
+        for (const auto& value : rule.set.values) {
+            if (rule.set.onClient) {
+                setBit(rule.set.members, clientId(value));
+            } else if (int id = DEFAULT_SYMBOL_TABLE.find(value); id >= 0) {
+                setBit(rule.set.members, id);
+            }
+        }
+    }
+
+    // Global rules go into every symbol table; symbol rules only into theirs.
+    std::unordered_set<std::string> scopedSymbols;
+    for (const auto& rule : parsed) {
+        if (rule.scope == RuleScope::GLOBAL) addToTable(program->global_, rule, nullptr);
+        if (rule.scope == RuleScope::SYMBOL) scopedSymbols.insert(rule.scopeName);
+    }
+    for (size_t id = 0; id < DEFAULT_INSTRUMENTS.size(); ++id) {
+        scopedSymbols.insert(std::string(DEFAULT_INSTRUMENTS[id]));
+    }
+    for (const auto& symbol : scopedSymbols) {
+        int id = DEFAULT_SYMBOL_TABLE.find(symbol);
+        RuleTable& table = id >= 0 ? program->instruments_[id] : program->otherSymbols_[symbol];
+        for (const auto& rule : parsed) {
+            if (rule.scope == RuleScope::GLOBAL ||
+                (rule.scope == RuleScope::SYMBOL && rule.scopeName == symbol)) {
+                addToTable(table, rule, &symbol);
+            }
+        }
+    }
+
+    program->clients_.resize(program->clientIds_.size());
+    for (const auto& rule : parsed) {
+        if (rule.scope == RuleScope::CLIENT) {
+            addToTable(program->clients_[program->clientIds_.at(rule.scopeName)], rule, nullptr);
+        }
+    }
+
+    return program;
+}
+
+const RuleTable& RuleProgram::symbolTable(const std::string& symbol) const {
+    int id = DEFAULT_SYMBOL_TABLE.find(symbol);
+    if (id >= 0) return instruments_[id];
+    auto it = otherSymbols_.find(symbol);
+    return it == otherSymbols_.end() ? global_ : it->second;
+}
+
+/// Index of the first failing numeric rule, or -1. Failures are accumulated
+/// into a bitmask 64 rules at a time, so the scan has no data-dependent
+/// branches. NaN features (absent SL/TP) fail neither compare and pass.
+static int firstNumericFailure(const std::vector<CompiledRule>& rules, const double* features) {
+    const size_t n = rules.size();
+    for (size_t base = 0; base < n; base += 64) {
+        size_t end = base + 64 < n ? base + 64 : n;
+        uint64_t failed = 0;
+        for (size_t i = base; i < end; ++i) {
+            const CompiledRule& rule = rules[i];
+            double x = features[static_cast<size_t>(rule.feature)];
+            failed |= static_cast<uint64_t>((x < rule.lo) | (x > rule.hi)) << (i - base);
+        }
+        if (failed) return static_cast<int>(base + __builtin_ctzll(failed));
+    }
+    return -1;
+}
+
+static std::string formatValue(double value) {
+    std::ostringstream oss;
+    oss << value;
+    return oss.str();
+}
+
+/// A handful of named clients is cheaper to scan (length check, then memcmp)
+/// than to hash the request's client ID.
+int RuleProgram::findClient(const std::string& clientId) const {
+    constexpr size_t LINEAR_SCAN_MAX = 8;
+    if (clientNames_.size() <= LINEAR_SCAN_MAX) {
+        for (size_t i = 0; i < clientNames_.size(); ++i) {
+            if (clientNames_[i] == clientId) return static_cast<int>(i);
+        }
+        return -1;
+    }
+    auto it = clientIds_.find(clientId);
+    return it == clientIds_.end() ? -1 : it->second;
+}
+
+std::optional<std::string> RuleProgram::checkTable(const RuleTable& table, const TradeRequest& request,
+                                                   int symbolId, int clientId, const double* features) const {
+    int failed = firstNumericFailure(table.numeric, features);
+    if (failed >= 0) {
+        const CompiledRule& rule = table.numeric[failed];
+        return describe(rule.source, formatValue(features[static_cast<size_t>(rule.feature)]));
+    }
+    if (table.alwaysFails >= 0) {
+        return describe(static_cast<uint32_t>(table.alwaysFails), request.symbol);
+    }
+    for (const auto& set : table.sets) {
+        bool member = set.onClient ? set.contains(clientId)
+                    : symbolId >= 0 ? set.contains(symbolId)
+                    : set.values.count(request.symbol) != 0;
+        if (member == set.negate) {
+            return describe(set.source, set.onClient ? request.clientId : request.symbol);
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> RuleProgram::check(const TradeRequest& request, const SymbolInfo& info) const {
+    int symbolId = DEFAULT_SYMBOL_TABLE.find(request.symbol);
+    const RuleTable& bySymbol = symbolId >= 0 ? instruments_[symbolId] : symbolTable(request.symbol);
+
+    int clientId = findClient(request.clientId);
+    const RuleTable* byClient = clientId >= 0 ? &clients_[clientId] : nullptr;
+    if (bySymbol.empty() && (!byClient || byClient->empty())) return std::nullopt;
+
+    double price = request.tradeType == TradeType::BUY ? info.ask : info.bid;
+    double features[static_cast<size_t>(RuleFeature::COUNT)] = {
+        request.volume,
+        request.volume * price,
+        request.stopLoss   ? *request.stopLoss   : NAN,
+        request.takeProfit ? *request.takeProfit : NAN,
+    };
+
+    if (auto violation = checkTable(bySymbol, request, symbolId, clientId, features)) return violation;
+    if (byClient) return checkTable(*byClient, request, symbolId, clientId, features);
+    return std::nullopt;
+}
+
+std::string RuleProgram::describe(uint32_t source, const std::string& got) const {
+    const RuleDefinition& def = definitions_[source];
+    return "Rule " + def.name + " violated: " + def.text + " (" + def.field + "=" + got + ")";
+}
+
+/// Source of program generations; global so a cache entry can never match
+/// a different engine that reused the same address.
+static std::atomic<uint64_t> nextGeneration{1};
+
+RuleEngine::RuleEngine(Logger& logger)
+    : logger_(logger)
+{
+    std::string unused;
+    program_ = RuleProgram::compile(ConfigFile{}, unused);
+    generation_ = nextGeneration.fetch_add(1);
+}
+
+RuleEngine::~RuleEngine() {
+    {
+        std::lock_guard<std::mutex> lock(watchMutex_);
+        stopping_ = true;
+    }
+    watchCv_.notify_all();
+    if (watcher_.joinable()) watcher_.join();
+}
+
+std::optional<std::string> RuleEngine::check(const TradeRequest& request, const SymbolInfo& info) const {
+    struct Cached {
+        uint64_t                           generation = 0;
+        std::shared_ptr<const RuleProgram> program;
+    };
+    thread_local Cached cache;
+
+    uint64_t generation = generation_.load(std::memory_order_acquire);
+    if (cache.generation != generation) {
+        cache.program    = program();
+        cache.generation = generation;
+    }
+    return cache.program->check(request, info);
+}
+
+bool RuleEngine::load(const ConfigFile& config) {
+    std::string error;
+    auto program = RuleProgram::compile(config, error);
+    if (!program) {
+        logger_.error("Validation rules not loaded (keeping previous set): " + error);
+        return false;
+    }
+    std::atomic_store(&program_, std::move(program));
+    generation_.store(nextGeneration.fetch_add(1), std::memory_order_release);
+    logger_.info("Loaded " + std::to_string(RuleEngine::program()->ruleCount()) + " validation rules" +
+                 (config.path().empty() ? "" : " from " + config.path()));
+    return true;
+}
+
+void RuleEngine::watch(const std::string& path, std::chrono::milliseconds interval) {
+    if (watcher_.joinable()) return;
+    watcher_ = std::thread(&RuleEngine::watchLoop, this, path, interval);
+}
+
+void RuleEngine::watchLoop(std::string path, std::chrono::milliseconds interval) {
+    std::error_code ec;
+    auto lastWrite = fs::last_write_time(path, ec);
+
+    std::unique_lock<std::mutex> lock(watchMutex_);
+    while (!watchCv_.wait_for(lock, interval, [this] { return stopping_; })) {
+        auto modified = fs::last_write_time(path, ec);
+        if (ec || modified == lastWrite) continue;
+        lastWrite = modified;
+
+        lock.unlock();
+        if (auto config = ConfigFile::load(path)) {
+            load(*config);
+        }
+        lock.lock();
+    }
+}
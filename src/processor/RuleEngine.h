@@ -0,0 +1,152 @@
+#pragma once
+
+#include "models/TradeRequest.h"
+#include "mt_api/IMTBrokerAPI.h"
+#include "mt_api/SymbolTable.h"
+#include "config/ConfigFile.h"
+#include "logger/Logger.h"
+
+#include <array>
+#include <vector>
+#include <string>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+/// Request values a numeric rule can test.
+enum class RuleFeature : uint8_t { VOLUME, NOTIONAL, STOP_LOSS, TAKE_PROFIT, COUNT };
+
+/// A rule as written in the config file, kept for error messages.
+struct RuleDefinition {
+    std::string name;     // "rule.<name>"
+    std::string text;     // "volume <= 5 for symbol XAUUSD"
+    std::string field;    // "volume", "notional", "symbol", ...
+};
+
+/// Compiled numeric rule: passes iff lo <= feature <= hi. Every comparison
+/// operator becomes a closed interval at compile time (strict bounds via
+/// nextafter), so evaluation is two compares and no operator dispatch.
+struct CompiledRule {
+    RuleFeature feature;
+    double      lo;
+    double      hi;
+    uint32_t    source;   // Index into RuleProgram's definitions
+};
+
+/// Compiled "field in a,b,c" / "field not_in a,b,c" rule on symbol or client.
+/// Membership is a bitset over dense IDs: the perfect-hash instrument ID for
+/// symbols, a per-program client ID for clients. Symbols outside the standard
+/// instruments fall back to `values`.
+struct SetRule {
+    bool                            onClient;   // false: tests the symbol
+    bool                            negate;     // not_in
+    std::vector<uint64_t>           members;
+    std::unordered_set<std::string> values;
+    uint32_t                        source;
+
+    bool contains(int id) const {
+        return id >= 0 && static_cast<size_t>(id / 64) < members.size() &&
+               ((members[id / 64] >> (id % 64)) & 1);
+    }
+};
+
+/// Rules that apply to one symbol (global + that symbol's rules) or one
+/// client, in file order. Symbol set rules in a per-symbol table are decided
+/// at compile time: they either vanish or become `alwaysFails`.
+struct RuleTable {
+    std::vector<CompiledRule> numeric;
+    std::vector<SetRule>      sets;
+    int32_t                   alwaysFails = -1;   // Source of a statically failing rule
+
+    bool empty() const { return numeric.empty() && sets.empty() && alwaysFails < 0; }
+};
+
+/// An immutable, compiled rule set.
+///
+/// Global rules are merged into every symbol's table when the program is
+/// built, so a check is: resolve the symbol table (perfect hash for the
+/// standard instruments), resolve the client ID (one string hash, skipped when
+/// no rule mentions clients), scan the symbol's flat rule array accumulating a
+/// failure bitmask, then do the same for the client's table if it has one.
+class RuleProgram {
+public:
+    /// Compile the "rule.*" entries of `config`. Returns nullptr and sets
+    /// `error` if any rule is malformed; a config without rules compiles to
+    /// an empty program.
+    static std::shared_ptr<const RuleProgram> compile(const ConfigFile& config, std::string& error);
+
+    /// Violation message of the first failing rule, or std::nullopt.
+    /// `info` supplies the price for the notional (volume x price) feature.
+    std::optional<std::string> check(const TradeRequest& request, const SymbolInfo& info) const;
+
+    size_t ruleCount() const { return definitions_.size(); }
+
+private:
+    const RuleTable& symbolTable(const std::string& symbol) const;
+    int         findClient(const std::string& clientId) const;
+    std::string describe(uint32_t source, const std::string& got) const;
+    std::optional<std::string> checkTable(const RuleTable& table, const TradeRequest& request,
+                                          int symbolId, int clientId, const double* features) const;
+
+    std::vector<RuleDefinition>                         definitions_;
+    RuleTable                                           global_;        // Symbols without own rules
+    std::array<RuleTable, DEFAULT_INSTRUMENTS.size()>   instruments_;   // By perfect-hash ID
+    std::unordered_map<std::string, RuleTable>          otherSymbols_;
+    std::unordered_map<std::string, int>                clientIds_;     // Clients named by any rule
+    std::vector<std::string>                            clientNames_;   // By client ID
+    std::vector<RuleTable>                              clients_;       // By client ID
+};
+
+/// Owner of the active RuleProgram, with atomic hot reload.
+///
+/// Rules live in the config file as
+///   rule.<name> = <field> <op> <value> [for symbol|client <name>]
+/// with numeric fields volume, notional, stop_loss, take_profit (ops < <= >
+/// >= ==) and set fields symbol, client (ops in, not_in; comma-separated).
+///
+/// Reloading compiles the new program off to the side and publishes it with
+/// one atomic shared_ptr store. Workers keep evaluating whichever program
+/// they loaded; a rule file that fails to compile leaves the old one active.
+class RuleEngine {
+public:
+    explicit RuleEngine(Logger& logger);
+    ~RuleEngine();
+
+    RuleEngine(const RuleEngine&) = delete;
+    RuleEngine& operator=(const RuleEngine&) = delete;
+
+    /// Compile and publish rules from `config`. Returns false on error.
+    bool load(const ConfigFile& config);
+
+    /// Re-read `path` whenever its modification time changes.
+    void watch(const std::string& path, std::chrono::milliseconds interval);
+
+    /// The current program (never null).
+    std::shared_ptr<const RuleProgram> program() const {
+        return std::atomic_load(&program_);
+    }
+
+    /// Check against the current program. Each thread caches its reference
+    /// and only re-reads the shared pointer when the generation changes, so
+    /// the hot path is one atomic load instead of a reference-count round trip.
+    std::optional<std::string> check(const TradeRequest& request, const SymbolInfo& info) const;
+
+private:
+    void watchLoop(std::string path, std::chrono::milliseconds interval);
+
+    Logger&                             logger_;
+    std::shared_ptr<const RuleProgram>  program_;
+    std::atomic<uint64_t>               generation_{0};   // Unique across engines
+
+    std::thread                         watcher_;
+    std::mutex                          watchMutex_;
+    std::condition_variable             watchCv_;
+    bool                                stopping_ = false;
+};
@@ -4,84 +4,277 @@
 #include "models/TradeResult.h"
 #include "mt_api/IMTBrokerAPI.h"
 #include "logger/Logger.h"
+#include "processor/BatchValidator.h"
+#include "processor/RequestIdSet.h"
+#include "processor/RuleEngine.h"
+#include "mt_api/TradingCalendar.h"
+#include "mt_api/SymbolTable.h"
 
-#include <unordered_set>
+#include <array>
+#include <unordered_map>
+#include <vector>
 #include <mutex>
 #include <string>
 #include <optional>
+#include <cmath>
 
 /// Pre-execution validation layer.
 /// Checks requests BEFORE they reach the MT API, catching obvious errors early.
 /// This mirrors what a production system would do before calling DealerSend().
-class Validator {
+///
+/// Templated on the broker type like BasicDealProcessor: with a concrete
+/// `final` broker the symbol lookup below is a direct call.
+///
+/// Specifications of the DEFAULT_INSTRUMENTS are fetched from the broker
+/// once, on first use, and read from that immutable table afterwards: the
+/// fast path takes no broker lock and copies nothing. Volume limits and
+/// trading permission are static for a broker session; the cached bid/ask
+/// only feed price-based rules (max notional), where a quote from the
+/// start of the session is close enough. Other symbols still ask the broker.
+template <typename Broker>
+class BasicValidator {
 public:
-    Validator(IMTBrokerAPI& api, Logger& logger)
+    BasicValidator(Broker& api, Logger& logger)
         : api_(api), logger_(logger) {}
 
+    /// Configurable rules checked after the built-in ones (nullptr = none).
+    /// The engine must outlive the validator.
+    void setRules(const RuleEngine* rules) { rules_ = rules; }
+
+    /// Trading sessions to enforce before dispatch (nullptr = always open).
+    /// The calendar must outlive the validator.
+    void setCalendar(const TradingCalendar* calendar) {
+        calendar_ = calendar && !calendar->empty() ? calendar : nullptr;
+    }
+
+    /// Treat `requestId` as already seen (warm restart of the dedup set).
+    void markSeen(const std::string& requestId) {
+        std::lock_guard<std::mutex> lock(dedupMutex_);
+        seenRequests_.insert(requestId);
+    }
+
     /// Validate a trade request. Returns a TradeResult with error details on failure,
     /// or std::nullopt if validation passes.
     std::optional<TradeResult> validate(const TradeRequest& request) {
-        // 1. Check for duplicate request IDs
+        // 1. Check for duplicate request IDs (hashed before taking the lock)
+        uint64_t idHash = RequestIdSet::hash(request.requestId);
         {
             std::lock_guard<std::mutex> lock(dedupMutex_);
-            if (seenRequests_.count(request.requestId)) {
+            if (!seenRequests_.insert(request.requestId, idHash)) {
                 logger_.warn("Duplicate request detected: " + request.requestId);
-                return makeError(request, TradeStatus::DUPLICATE,
-                                 "Duplicate request ID: " + request.requestId);
+                return checkError(request, CHECK_DUPLICATE, nullptr);
             }
-            seenRequests_.insert(request.requestId);
         }
 
         // 2. Basic parameter validation
-        if (request.clientId.empty()) {
-            return makeError(request, TradeStatus::INVALID_PARAMS, "Empty client ID");
-        }
-
-        if (request.symbol.empty()) {
-            return makeError(request, TradeStatus::INVALID_PARAMS, "Empty symbol");
-        }
-
-        if (request.volume <= 0.0) {
-            return makeError(request, TradeStatus::INVALID_PARAMS,
-                             "Invalid volume: " + std::to_string(request.volume));
-        }
-
-        // 3. Symbol validation (calls SymbolGet equivalent)
-        auto symbolInfo = api_.getSymbolInfo(request.symbol);
-        if (!symbolInfo) {
-            return makeError(request, TradeStatus::INVALID_PARAMS,
-                             "Unknown symbol: " + request.symbol);
-        }
+        if (request.clientId.empty()) return checkError(request, CHECK_EMPTY_CLIENT, nullptr);
+        if (request.symbol.empty())   return checkError(request, CHECK_EMPTY_SYMBOL, nullptr);
+        if (request.volume <= 0.0)    return checkError(request, CHECK_VOLUME_POSITIVE, nullptr);
 
-        if (!symbolInfo->tradeAllowed) {
-            return makeError(request, TradeStatus::REJECTED,
-                             "Trading not allowed for: " + request.symbol);
+        // 3. Symbol validation (SymbolGet equivalent, cached for known instruments)
+        std::optional<SymbolInfo> fetched;
+        const SymbolInfo* symbolInfo = findSymbol(request.symbol, fetched);
+        if (!symbolInfo)               return checkError(request, CHECK_UNKNOWN_SYMBOL, nullptr);
+        if (!symbolInfo->tradeAllowed) return checkError(request, CHECK_TRADE_DISABLED, nullptr);
+        if (calendar_ && !calendar_->isOpen(request.symbol, std::chrono::system_clock::now())) {
+            return checkError(request, CHECK_MARKET_CLOSED, nullptr);
         }
 
         // 4. Volume range check
         if (request.volume < symbolInfo->minVolume || request.volume > symbolInfo->maxVolume) {
-            return makeError(request, TradeStatus::INVALID_PARAMS,
-                             "Volume " + std::to_string(request.volume) +
-                             " outside range [" + std::to_string(symbolInfo->minVolume) +
-                             ", " + std::to_string(symbolInfo->maxVolume) + "]");
+            return checkError(request, CHECK_VOLUME_RANGE, symbolInfo);
         }
 
         // 5. SL/TP sanity check (if provided)
         if (request.stopLoss && *request.stopLoss <= 0.0) {
-            return makeError(request, TradeStatus::INVALID_PARAMS,
-                             "Invalid stop loss: " + std::to_string(*request.stopLoss));
+            return checkError(request, CHECK_STOP_LOSS, nullptr);
         }
-
         if (request.takeProfit && *request.takeProfit <= 0.0) {
-            return makeError(request, TradeStatus::INVALID_PARAMS,
-                             "Invalid take profit: " + std::to_string(*request.takeProfit));
+            return checkError(request, CHECK_TAKE_PROFIT, nullptr);
+        }
+
+        // 6. Configured rules (max notional, client whitelists, ...)
+        if (rules_) {
+            if (auto violation = rules_->check(request, *symbolInfo)) {
+                return makeError(request, TradeStatus::REJECTED, *violation);
+            }
         }
 
         // All checks passed
         return std::nullopt;
     }
 
+    /// Working storage for validateBatch(), owned by the calling thread and
+    /// reused from batch to batch so a batch allocates nothing.
+    struct BatchScratch {
+        std::vector<uint32_t>                                      errors;
+        std::vector<uint64_t>                                      idHashes;
+        std::vector<const SymbolInfo*>                             info;
+        std::unordered_map<std::string, std::optional<SymbolInfo>> symbols;   // Symbols outside the cache
+        RequestBatchSoA                                            soa;
+    };
+
+    /// Validate a burst of requests at once. results[i] ends up exactly as
+    /// validate(*requests[i]) would have left it, called in order.
+    ///
+    /// Amortizes the per-request costs: one dedup lock per batch, with the
+    /// IDs hashed before it is taken and each insert's slot prefetched a few
+    /// requests ahead (the dedup insert is most of a request's validation
+    /// cost, and mostly a cache miss); one symbol lookup per distinct symbol;
+    /// and the numeric checks (volume, range, SL/TP) as one pass over a
+    /// structure-of-arrays copy. Error messages are built for failing
+    /// requests only.
+    /// Configured rules are evaluated against one rule program per batch.
+    void validateBatch(const std::vector<const TradeRequest*>& requests,
+                       std::vector<std::optional<TradeResult>>& results, BatchScratch& scratch) {
+        const size_t n = requests.size();
+        results.assign(n, std::nullopt);
+        if (n == 0) return;
+
+        std::vector<uint32_t>& errors = scratch.errors;
+        errors.assign(n, 0);
+
+        // Dedup: the first occurrence of an ID (in this or an earlier batch) passes.
+        std::vector<uint64_t>& idHashes = scratch.idHashes;
+        idHashes.resize(n);
+        for (size_t i = 0; i < n; ++i) idHashes[i] = RequestIdSet::hash(requests[i]->requestId);
+        {
+            std::lock_guard<std::mutex> lock(dedupMutex_);
+            for (size_t i = 0; i < n && i < DEDUP_PREFETCH; ++i) seenRequests_.prefetch(idHashes[i]);
+            for (size_t i = 0; i < n; ++i) {
+                if (i + DEDUP_PREFETCH < n) seenRequests_.prefetch(idHashes[i + DEDUP_PREFETCH]);
+                if (!seenRequests_.insert(requests[i]->requestId, idHashes[i])) {
+                    errors[i] |= CHECK_DUPLICATE;
+                }
+            }
+        }
+
+        // Symbol lookups: the cached table, or once per distinct unknown symbol.
+        const SymbolSpecs& specs = symbolSpecs();
+        auto& symbols = scratch.symbols;
+        symbols.clear();
+        std::optional<TradingCalendar::Moment> now;   // One clock read per batch
+        if (calendar_) now = calendar_->at(std::chrono::system_clock::now());
+        std::vector<const SymbolInfo*>& info = scratch.info;
+        info.assign(n, nullptr);
+        RequestBatchSoA& soa = scratch.soa;
+        soa.resize(n);
+
+        for (size_t i = 0; i < n; ++i) {
+            const TradeRequest& req = *requests[i];
+            if (req.clientId.empty()) errors[i] |= CHECK_EMPTY_CLIENT;
+
+            if (req.symbol.empty()) {
+                errors[i] |= CHECK_EMPTY_SYMBOL;
+            } else if (req.volume <= 0.0) {
+                // CHECK_VOLUME_POSITIVE (set by the numeric pass) outranks
+                // every symbol check: skip the lookup
+            } else {
+                int id = DEFAULT_SYMBOL_TABLE.find(req.symbol);
+                if (id >= 0 && specs[id]) {
+                    info[i] = &*specs[id];
+                } else {
+                    auto it = symbols.find(req.symbol);
+                    if (it == symbols.end()) {
+                        it = symbols.emplace(req.symbol, api_.getSymbolInfo(req.symbol)).first;
+                    }
+                    if (it->second) info[i] = &*it->second;
+                }
+                if (!info[i]) {
+                    errors[i] |= CHECK_UNKNOWN_SYMBOL;
+                } else {
+                    if (!info[i]->tradeAllowed) errors[i] |= CHECK_TRADE_DISABLED;
+                    if (now && !calendar_->isOpen(req.symbol, *now)) errors[i] |= CHECK_MARKET_CLOSED;
+                }
+            }
+
+            soa.volume[i]     = req.volume;
+            soa.minVolume[i]  = info[i] ? info[i]->minVolume : -HUGE_VAL;
+            soa.maxVolume[i]  = info[i] ? info[i]->maxVolume :  HUGE_VAL;
+            soa.stopLoss[i]   = req.stopLoss   ? *req.stopLoss   : 1.0;
+            soa.takeProfit[i] = req.takeProfit ? *req.takeProfit : 1.0;
+        }
+
+        BatchValidator::checkNumeric(soa, errors.data());
+
+        auto program = rules_ ? rules_->program() : nullptr;
+        for (size_t i = 0; i < n; ++i) {
+            if (errors[i] == 0) {
+                if (program) {
+                    if (auto violation = program->check(*requests[i], *info[i])) {
+                        results[i] = makeError(*requests[i], TradeStatus::REJECTED, *violation);
+                    }
+                }
+                continue;
+            }
+            // Lowest bit = first check the scalar path would have failed.
+            auto check = static_cast<ValidationCheck>(errors[i] & (~errors[i] + 1));
+            if (check == CHECK_DUPLICATE) {
+                logger_.warn("Duplicate request detected: " + requests[i]->requestId);
+            }
+            results[i] = checkError(*requests[i], check, info[i]);
+        }
+    }
+
 private:
+    /// Dedup inserts a batch prefetches ahead of the current one.
+    static constexpr size_t DEDUP_PREFETCH = 8;
+
+    using SymbolSpecs = std::array<std::optional<SymbolInfo>, DEFAULT_INSTRUMENTS.size()>;
+
+    /// The cached specifications, by DEFAULT_SYMBOL_TABLE id (filled once).
+    const SymbolSpecs& symbolSpecs() {
+        std::call_once(specsOnce_, [this] {
+            for (size_t id = 0; id < DEFAULT_INSTRUMENTS.size(); ++id) {
+                specs_[id] = api_.getSymbolInfo(std::string(DEFAULT_INSTRUMENTS[id]));
+            }
+        });
+        return specs_;
+    }
+
+    /// `symbol`'s specification: from the cache, or fetched into `fetched`.
+    const SymbolInfo* findSymbol(const std::string& symbol, std::optional<SymbolInfo>& fetched) {
+        int id = DEFAULT_SYMBOL_TABLE.find(symbol);
+        if (id >= 0) {
+            if (const auto& cached = symbolSpecs()[id]) return &*cached;
+        }
+        fetched = api_.getSymbolInfo(symbol);
+        return fetched ? &*fetched : nullptr;
+    }
+
+    /// Error result for a failed check. `info` is only needed for CHECK_VOLUME_RANGE.
+    TradeResult checkError(const TradeRequest& req, ValidationCheck check, const SymbolInfo* info) {
+        switch (check) {
+            case CHECK_DUPLICATE:
+                return makeError(req, TradeStatus::DUPLICATE, "Duplicate request ID: " + req.requestId);
+            case CHECK_EMPTY_CLIENT:
+                return makeError(req, TradeStatus::INVALID_PARAMS, "Empty client ID");
+            case CHECK_EMPTY_SYMBOL:
+                return makeError(req, TradeStatus::INVALID_PARAMS, "Empty symbol");
+            case CHECK_VOLUME_POSITIVE:
+                return makeError(req, TradeStatus::INVALID_PARAMS,
+                                 "Invalid volume: " + std::to_string(req.volume));
+            case CHECK_UNKNOWN_SYMBOL:
+                return makeError(req, TradeStatus::INVALID_PARAMS, "Unknown symbol: " + req.symbol);
+            case CHECK_TRADE_DISABLED:
+                return makeError(req, TradeStatus::REJECTED, "Trading not allowed for: " + req.symbol);
+            case CHECK_MARKET_CLOSED:
+                return makeError(req, TradeStatus::REJECTED, "Market closed for: " + req.symbol);
+            case CHECK_VOLUME_RANGE:
+                return makeError(req, TradeStatus::INVALID_PARAMS,
+                                 "Volume " + std::to_string(req.volume) +
+                                 " outside range [" + std::to_string(info->minVolume) +
+                                 ", " + std::to_string(info->maxVolume) + "]");
+            case CHECK_STOP_LOSS:
+                return makeError(req, TradeStatus::INVALID_PARAMS,
+                                 "Invalid stop loss: " + std::to_string(*req.stopLoss));
+            case CHECK_TAKE_PROFIT:
+                return makeError(req, TradeStatus::INVALID_PARAMS,
+                                 "Invalid take profit: " + std::to_string(*req.takeProfit));
+        }
+        return makeError(req, TradeStatus::INVALID_PARAMS, "Validation failed");
+    }
+
     TradeResult makeError(const TradeRequest& req, TradeStatus status, const std::string& msg) {
         TradeResult result;
         result.requestId = req.requestId;
@@ -94,8 +287,14 @@ private:
         return result;
     }
 
-    IMTBrokerAPI& api_;
+    Broker& api_;
     Logger& logger_;
-    std::unordered_set<std::string> seenRequests_;
+    const RuleEngine* rules_ = nullptr;
+    const TradingCalendar* calendar_ = nullptr;
+    SymbolSpecs specs_;             // Written once under specsOnce_, read-only afterwards
+    std::once_flag specsOnce_;
+    RequestIdSet seenRequests_;
     std::mutex dedupMutex_;
 };
+
+using Validator = BasicValidator<IMTBrokerAPI>;
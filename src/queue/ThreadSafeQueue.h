@@ -4,6 +4,8 @@
 #include <mutex>
 #include <condition_variable>
 #include <optional>
+#include <chrono>
+#include <vector>
 
 /// Thread-safe, blocking queue used as the central request buffer.
 /// Multiple client threads push requests; worker threads pop them.
@@ -34,6 +36,52 @@ public:
         return item;
     }
 
+    /// Blocking batch pop - waits for the first item, then takes up to `maxItems`
+    /// under the same lock. Appends to `out`; returns false on shutdown with
+    /// empty queue.
+    bool popBatch(std::vector<T>& out, size_t maxItems) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !queue_.empty() || shutdown_; });
+
+        if (queue_.empty()) {
+            return false;
+        }
+
+        for (size_t taken = 0; taken < maxItems && !queue_.empty(); ++taken) {
+            out.push_back(std::move(queue_.front()));
+            queue_.pop();
+        }
+        return true;
+    }
+
+    /// Timed pop - like pop(), but gives up after `timeout`. Returns
+    /// std::nullopt on timeout, or on shutdown with empty queue (closed()).
+    std::optional<T> popFor(std::chrono::microseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!cv_.wait_for(lock, timeout, [this] { return !queue_.empty() || shutdown_; }) || queue_.empty()) {
+            return std::nullopt;
+        }
+
+        T item = std::move(queue_.front());
+        queue_.pop();
+        return item;
+    }
+
+    /// Timed batch pop - like popBatch(), but gives up after `timeout`.
+    /// Returns false on timeout, or on shutdown with empty queue (closed()).
+    bool popBatchFor(std::vector<T>& out, size_t maxItems, std::chrono::microseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!cv_.wait_for(lock, timeout, [this] { return !queue_.empty() || shutdown_; }) || queue_.empty()) {
+            return false;
+        }
+
+        for (size_t taken = 0; taken < maxItems && !queue_.empty(); ++taken) {
+            out.push_back(std::move(queue_.front()));
+            queue_.pop();
+        }
+        return true;
+    }
+
     /// Non-blocking pop attempt.
     std::optional<T> tryPop() {
         std::lock_guard<std::mutex> lock(mutex_);
@@ -54,6 +102,12 @@ public:
         return queue_.empty();
     }
 
+    /// Shutdown signaled and nothing left to pop.
+    bool closed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return shutdown_ && queue_.empty();
+    }
+
     /// Signal all waiting threads to wake up and exit.
     void shutdown() {
         {
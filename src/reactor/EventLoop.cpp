@@ -0,0 +1,144 @@
+#include "reactor/EventLoop.h"
+
+#include <algorithm>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+static constexpr int MAX_EVENTS = 64;
+
+EventLoop::EventLoop() {
+    epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    wakeFd_  = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    timerFd_ = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (!valid()) return;
+
+    epoll_event ev{};
+    ev.events  = EPOLLIN;
+    ev.data.fd = wakeFd_;
+    ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &ev);
+    ev.data.fd = timerFd_;
+    ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, timerFd_, &ev);
+}
+
+EventLoop::~EventLoop() {
+    for (Node* node = inbox_.exchange(nullptr); node; ) {
+        Node* next = node->next;
+        delete node;
+        node = next;
+    }
+    for (int fd : {epollFd_, wakeFd_, timerFd_}) {
+        if (fd >= 0) ::close(fd);
+    }
+}
+
+void EventLoop::post(Task task) {
+    Node* node = new Node{std::move(task), inbox_.load(std::memory_order_relaxed)};
+    while (!inbox_.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+    }
+    // Only the first task into an empty inbox needs to wake the loop
+    if (!node->next) {
+        uint64_t one = 1;
+        [[maybe_unused]] ssize_t n = ::write(wakeFd_, &one, sizeof(one));
+    }
+}
+
+void EventLoop::drainInbox() {
+    // Tasks come off the stack newest first; reverse to run them in post order
+    Node* node = inbox_.exchange(nullptr, std::memory_order_acquire);
+    Node* ordered = nullptr;
+    while (node) {
+        Node* next = node->next;
+        node->next = ordered;
+        ordered = node;
+        node = next;
+    }
+    while (ordered) {
+        Node* next = ordered->next;
+        ordered->task();
+        delete ordered;
+        ordered = next;
+    }
+}
+
+void EventLoop::runAfter(std::chrono::microseconds delay, Task task) {
+    timers_.push({std::chrono::steady_clock::now() + delay, timerOrder_++, std::move(task)});
+    armTimer();
+}
+
+void EventLoop::armTimer() {
+    auto next = timers_.empty() ? std::chrono::steady_clock::time_point::max() : timers_.top().deadline;
+    if (next == armedFor_) return;
+    armedFor_ = next;
+
+    itimerspec spec{};
+    if (!timers_.empty()) {
+        // steady_clock is CLOCK_MONOTONIC; a zero it_value would disarm
+        auto ns = std::max<int64_t>(1, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                           next.time_since_epoch()).count());
+        spec.it_value.tv_sec  = static_cast<time_t>(ns / 1000000000);
+        spec.it_value.tv_nsec = static_cast<long>(ns % 1000000000);
+    }
+    ::timerfd_settime(timerFd_, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+void EventLoop::runTimers() {
+    auto now = std::chrono::steady_clock::now();
+    while (!timers_.empty() && timers_.top().deadline <= now) {
+        Task task = std::move(const_cast<Timer&>(timers_.top()).task);
+        timers_.pop();
+        task();
+    }
+    armedFor_ = std::chrono::steady_clock::time_point::min();   // Force a re-arm
+    armTimer();
+}
+
+bool EventLoop::watch(int fd, uint32_t events, std::function<void(uint32_t)> fn) {
+    epoll_event ev{};
+    ev.events  = events;
+    ev.data.fd = fd;
+    int op = watchers_.count(fd) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+    if (::epoll_ctl(epollFd_, op, fd, &ev) != 0) return false;
+    watchers_[fd] = std::move(fn);
+    return true;
+}
+
+void EventLoop::unwatch(int fd) {
+    if (watchers_.erase(fd)) ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+void EventLoop::run() {
+    epoll_event events[MAX_EVENTS];
+    drainInbox();
+    while (!stopping_.load(std::memory_order_acquire)) {
+        int n = ::epoll_wait(epollFd_, events, MAX_EVENTS, -1);
+        if (n < 0) continue;   // EINTR
+        wakeups_.fetch_add(1, std::memory_order_relaxed);
+
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            uint64_t count;
+            if (fd == wakeFd_) {
+                [[maybe_unused]] ssize_t r = ::read(wakeFd_, &count, sizeof(count));
+                drainInbox();
+            } else if (fd == timerFd_) {
+                [[maybe_unused]] ssize_t r = ::read(timerFd_, &count, sizeof(count));
+                runTimers();
+            } else if (auto it = watchers_.find(fd); it != watchers_.end()) {
+                auto handler = it->second;   // May unwatch itself
+                handler(events[i].events);
+            }
+        }
+        if (idleHook_) idleHook_();
+    }
+    drainInbox();
+    if (idleHook_) idleHook_();
+}
+
+void EventLoop::stop() {
+    stopping_.store(true, std::memory_order_release);
+    uint64_t one = 1;
+    [[maybe_unused]] ssize_t n = ::write(wakeFd_, &one, sizeof(one));
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+/// Single-threaded event loop over epoll (Linux).
+///
+/// Everything a loop owns is touched only by the thread inside run(), so
+/// the handlers need no locks. Other threads talk to it through post():
+///   - post()     - lock-free inbox (a CAS push) plus an eventfd wakeup,
+///                  written only when the inbox goes from empty to non-empty;
+///   - runAfter() - timers in a min-heap, with a timerfd armed for the
+///                  earliest deadline;
+///   - watch()    - readiness callbacks for arbitrary file descriptors.
+/// After each batch of ready events the idle hook runs (e.g. to flush
+/// results buffered while handling them).
+class EventLoop {
+public:
+    using Task = std::function<void()>;
+
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /// False if the epoll/eventfd/timerfd descriptors could not be created.
+    bool valid() const { return epollFd_ >= 0 && wakeFd_ >= 0 && timerFd_ >= 0; }
+
+    /// Run `task` on the loop thread (any thread; never blocks).
+    void post(Task task);
+
+    /// Loop thread only: run `task` once `delay` has passed.
+    void runAfter(std::chrono::microseconds delay, Task task);
+
+    /// Loop thread only: call fn(events) whenever `fd` is ready for `events`
+    /// (EPOLLIN, EPOLLOUT, ...). Returns false if epoll refused the fd.
+    bool watch(int fd, uint32_t events, std::function<void(uint32_t)> fn);
+    void unwatch(int fd);
+
+    /// Called on the loop thread after every batch of events. Set before run().
+    void setIdleHook(Task hook) { idleHook_ = std::move(hook); }
+
+    /// Handle events on the calling thread until stop(). Tasks posted before
+    /// stop() still run; timers that have not fired are dropped.
+    void run();
+
+    /// Make run() return (any thread).
+    void stop();
+
+    uint64_t wakeups() const { return wakeups_.load(std::memory_order_relaxed); }
+
+private:
+    struct Node {
+        Task  task;
+        Node* next;
+    };
+
+    struct Timer {
+        std::chrono::steady_clock::time_point deadline;
+        uint64_t                              order;     // FIFO among equal deadlines
+        Task                                  task;
+        bool operator>(const Timer& other) const {
+            return deadline != other.deadline ? deadline > other.deadline : order > other.order;
+        }
+    };
+
+    void drainInbox();
+    void runTimers();
+    void armTimer();
+
+    int epollFd_ = -1;
+    int wakeFd_  = -1;     // eventfd: inbox non-empty / stop
+    int timerFd_ = -1;     // timerfd: earliest timer due
+
+    std::atomic<Node*> inbox_{nullptr};
+    std::atomic<bool>  stopping_{false};
+    std::atomic<uint64_t> wakeups_{0};
+
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers_;
+    uint64_t timerOrder_ = 0;
+    std::chrono::steady_clock::time_point armedFor_ = std::chrono::steady_clock::time_point::max();
+
+    std::unordered_map<int, std::function<void(uint32_t)>> watchers_;
+    Task idleHook_;
+};
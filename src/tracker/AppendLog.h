@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstddef>
+
+/// Append-only sequence with one (externally serialized) writer and any
+/// number of lock-free readers.
+///
+/// Elements live in fixed chunks that never move, so a published element
+/// stays valid for the log's lifetime. The writer fills the next slot and
+/// then publishes the new size (release); a reader loads the size (acquire)
+/// and may read every element below it without a lock. The chunk directory
+/// grows by copying into a larger one; old directories are retired, not
+/// freed, until the log is destroyed (their total is below the final size).
+template <typename T, size_t CHUNK_BITS = 10>
+class AppendLog {
+public:
+    static constexpr size_t CHUNK = size_t{1} << CHUNK_BITS;
+
+    AppendLog() { grow(4); }
+
+    AppendLog(const AppendLog&) = delete;
+    AppendLog& operator=(const AppendLog&) = delete;
+
+    /// Published element count (readers: everything below is readable).
+    size_t size() const { return size_.load(std::memory_order_acquire); }
+
+    const T& operator[](size_t i) const {
+        const Directory* dir = directory_.load(std::memory_order_acquire);
+        return dir->chunks[i >> CHUNK_BITS][i & (CHUNK - 1)];
+    }
+
+    /// Writer only: a published element, for updating its atomic members.
+    T& operator[](size_t i) {
+        Directory* dir = directory_.load(std::memory_order_relaxed);
+        return dir->chunks[i >> CHUNK_BITS][i & (CHUNK - 1)];
+    }
+
+    /// Writer only: the slot the next publish() will expose, for in-place
+    /// construction of large elements.
+    T& next() {
+        size_t i = size_.load(std::memory_order_relaxed);
+        Directory* dir = directory_.load(std::memory_order_relaxed);
+        size_t chunk = i >> CHUNK_BITS;
+        if (chunk >= dir->chunks.size()) dir = grow(dir->chunks.size() * 2);
+        if (!dir->chunks[chunk]) {
+            chunks_.push_back(std::make_unique<T[]>(CHUNK));
+            dir->chunks[chunk] = chunks_.back().get();
+        }
+        return dir->chunks[chunk][i & (CHUNK - 1)];
+    }
+
+    /// Writer only: make the slot filled through next() visible.
+    void publish() {
+        size_.store(size_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    void push_back(const T& value) {
+        next() = value;
+        publish();
+    }
+
+    /// First index in [0, size()) whose element is not less than `key`,
+    /// for logs kept sorted by `less`.
+    template <typename Key, typename Less>
+    size_t lowerBound(size_t size, const Key& key, Less less) const {
+        size_t lo = 0, hi = size;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (less((*this)[mid], key)) lo = mid + 1; else hi = mid;
+        }
+        return lo;
+    }
+
+private:
+    struct Directory {
+        std::vector<T*> chunks;
+    };
+
+    Directory* grow(size_t capacity) {
+        auto dir = std::make_unique<Directory>();
+        dir->chunks.assign(capacity, nullptr);
+        if (Directory* old = directory_.load(std::memory_order_relaxed)) {
+            std::copy(old->chunks.begin(), old->chunks.end(), dir->chunks.begin());
+        }
+        Directory* raw = dir.get();
+        directories_.push_back(std::move(dir));
+        directory_.store(raw, std::memory_order_release);
+        return raw;
+    }
+
+    std::atomic<size_t>                     size_{0};
+    std::atomic<Directory*>                 directory_{nullptr};
+    std::vector<std::unique_ptr<T[]>>       chunks_;        // Owned storage (writer only)
+    std::vector<std::unique_ptr<Directory>> directories_;   // Current + retired
+};
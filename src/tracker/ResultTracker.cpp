@@ -2,72 +2,209 @@
 #include <iostream>
 #include <iomanip>
 
+static int64_t toSecond(std::chrono::system_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::seconds>(t.time_since_epoch()).count();
+}
+
+static uint32_t statusBit(TradeStatus status) {
+    return 1u << static_cast<uint32_t>(status);
+}
+
+ResultTracker::Postings& ResultTracker::postingsFor(
+        std::unordered_map<std::string, std::unique_ptr<Postings>>& index,
+        const std::string& key, std::shared_mutex& mutex) {
+    // Only the writer inserts, so the unlocked find cannot race an insert
+    auto it = index.find(key);
+    if (it != index.end()) return *it->second;
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    return *index.emplace(key, std::make_unique<Postings>()).first->second;
+}
+
+const ResultTracker::Postings* ResultTracker::findPostings(
+        const std::unordered_map<std::string, std::unique_ptr<Postings>>& index,
+        const std::string& key) const {
+    std::shared_lock<std::shared_mutex> lock(keysMutex_);
+    auto it = index.find(key);
+    return it != index.end() ? it->second.get() : nullptr;
+}
+
 void ResultTracker::record(const TradeResult& result) {
     std::lock_guard<std::mutex> lock(mutex_);
-    results_[result.requestId] = result;
-    clientRequests_[result.clientId].push_back(result.requestId);
+    recordLocked(result);
+    if (journal_) journal_->commit();
 }
 
-std::optional<TradeResult> ResultTracker::getByRequestId(const std::string& requestId) const {
+void ResultTracker::record(const TradeResult* results, size_t count) {
     std::lock_guard<std::mutex> lock(mutex_);
-    auto it = results_.find(requestId);
-    if (it == results_.end()) return std::nullopt;
-    return it->second;
+    for (size_t i = 0; i < count; ++i) recordLocked(results[i]);
+    if (journal_) journal_->commit();     // One write (and fsync) per batch
 }
 
-std::vector<TradeResult> ResultTracker::getByClientId(const std::string& clientId) const {
+void ResultTracker::recordLocked(const TradeResult& result) {
+    uint32_t id = static_cast<uint32_t>(entries_.size());
+
+    Entry& entry = entries_.next();
+    entry.result = result;
+    entry.supersededBy.store(NONE, std::memory_order_relaxed);
+
+    // Index first, publish the entry last: a reader's snapshot (entry count)
+    // then never includes an entry its posting lists are missing.
+    byStatus_[static_cast<size_t>(result.status)].push_back(id);
+    postingsFor(bySymbol_, result.symbol, keysMutex_).push_back(id);
+    postingsFor(byClient_, result.clientId, keysMutex_).push_back(id);
+
+    // Record-time second, never below the result's own timestamp, so every
+    // entry before a bucket has timestamp < that bucket's second.
+    int64_t second = std::max(toSecond(std::chrono::system_clock::now()), toSecond(result.timestamp));
+    size_t buckets = buckets_.size();
+    if (buckets == 0 || buckets_[buckets - 1].second < second) {
+        buckets_.push_back({second, id});
+    }
+
+    auto [it, inserted] = latest_.try_emplace(result.requestId, id);
+    if (!inserted) {
+        entries_[it->second].supersededBy.store(id, std::memory_order_release);
+        it->second = id;
+    }
+
+    entries_.publish();
+    if (journal_) journal_->append(result);
+    if (feed_) feed_->append(result);
+}
+
+void ResultTracker::setJournal(StateJournal* journal) {
     std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<TradeResult> results;
-    auto it = clientRequests_.find(clientId);
-    if (it == clientRequests_.end()) return results;
+    journal_ = journal;
+}
+
+void ResultTracker::setFeed(ResultFeed* feed) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    feed_ = feed;
+}
+
+bool ResultTracker::rotateJournal(uint64_t& closed, std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!journal_) {
+        closed = 0;
+        return true;
+    }
+    return journal_->rotate(closed, error);
+}
+
+std::optional<TradeResult> ResultTracker::getByRequestId(const std::string& requestId) const {
+    uint32_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = latest_.find(requestId);
+        if (it == latest_.end()) return std::nullopt;
+        id = it->second;
+    }
+    return entries_[id].result;
+}
 
-    for (const auto& reqId : it->second) {
-        auto resIt = results_.find(reqId);
-        if (resIt != results_.end()) {
-            results.push_back(resIt->second);
+std::vector<TradeResult> ResultTracker::getByClientId(const std::string& clientId) const {
+    return query(ResultQuery().forClient(clientId));
+}
+
+void ResultTracker::scan(const ResultQuery& query, const std::function<bool(const TradeResult&)>& fn) const {
+    const uint32_t n = static_cast<uint32_t>(entries_.size());
+
+    // Time index: entries before the first bucket at or after `from` were
+    // recorded (hence stamped) earlier than `from`.
+    uint32_t start = 0;
+    if (query.from) {
+        int64_t second = toSecond(*query.from);
+        size_t buckets = buckets_.size();
+        size_t b = buckets_.lowerBound(buckets, second,
+                                       [](const Bucket& bucket, int64_t s) { return bucket.second < s; });
+        start = b < buckets ? std::min(buckets_[b].firstEntry, n) : n;
+    }
+
+    // Narrowest posting list among the indexed conditions
+    const Postings* postings = nullptr;
+    auto consider = [&](const Postings* list) {
+        if (!postings || list->size() < postings->size()) postings = list;
+    };
+    if (!query.clientId.empty()) {
+        const Postings* list = findPostings(byClient_, query.clientId);
+        if (!list) return;
+        consider(list);
+    }
+    if (!query.symbol.empty()) {
+        const Postings* list = findPostings(bySymbol_, query.symbol);
+        if (!list) return;
+        consider(list);
+    }
+    if (query.statuses != ResultQuery::ALL_STATUSES && __builtin_popcount(query.statuses) == 1) {
+        consider(&byStatus_[__builtin_ctz(query.statuses)]);
+    }
+
+    auto matches = [&](uint32_t id) {
+        const Entry& entry = entries_[id];
+        if (entry.supersededBy.load(std::memory_order_acquire) < n) return false;
+        const TradeResult& r = entry.result;
+        return (query.statuses & statusBit(r.status)) &&
+               (query.clientId.empty() || r.clientId == query.clientId) &&
+               (query.symbol.empty() || r.symbol == query.symbol) &&
+               (!query.from || r.timestamp >= *query.from) &&
+               (!query.to || r.timestamp < *query.to);
+    };
+
+    if (postings) {
+        size_t size = postings->size();
+        for (size_t i = postings->lowerBound(size, start, std::less<uint32_t>()); i < size; ++i) {
+            uint32_t id = (*postings)[i];
+            if (id >= n) break;
+            if (matches(id) && !fn(entries_[id].result)) return;
+        }
+    } else {
+        for (uint32_t id = start; id < n; ++id) {
+            if (matches(id) && !fn(entries_[id].result)) return;
         }
     }
+}
+
+std::vector<TradeResult> ResultTracker::query(const ResultQuery& query) const {
+    std::vector<TradeResult> results;
+    if (query.limit == 0) return results;
+    scan(query, [&](const TradeResult& result) {
+        results.push_back(result);
+        return results.size() < query.limit;
+    });
     return results;
 }
 
+size_t ResultTracker::count(const ResultQuery& query) const {
+    size_t matched = 0;
+    scan(query, [&](const TradeResult&) { ++matched; return true; });
+    return matched;
+}
+
+void ResultTracker::tally(Stats& stats, TradeStatus status) {
+    stats.totalRequests++;
+    switch (status) {
+        case TradeStatus::SUCCESS:         stats.successful++; break;
+        case TradeStatus::DUPLICATE:       stats.duplicates++; break;
+        case TradeStatus::REJECTED:
+        case TradeStatus::MARGIN_ERROR:
+        case TradeStatus::RETRY_EXHAUSTED: stats.rejected++;   break;
+        case TradeStatus::CONNECTION_ERROR:
+        case TradeStatus::INVALID_PARAMS:  stats.errors++;     break;
+    }
+}
+
 ResultTracker::Stats ResultTracker::getStats() const {
-    std::lock_guard<std::mutex> lock(mutex_);
     Stats stats;
-    for (const auto& [id, result] : results_) {
-        stats.totalRequests++;
-        switch (result.status) {
-            case TradeStatus::SUCCESS:         stats.successful++; break;
-            case TradeStatus::DUPLICATE:       stats.duplicates++; break;
-            case TradeStatus::REJECTED:
-            case TradeStatus::MARGIN_ERROR:
-            case TradeStatus::RETRY_EXHAUSTED: stats.rejected++;   break;
-            case TradeStatus::CONNECTION_ERROR:
-            case TradeStatus::INVALID_PARAMS:  stats.errors++;     break;
-        }
-    }
+    scan(ResultQuery(), [&](const TradeResult& result) { tally(stats, result.status); return true; });
     return stats;
 }
 
 ResultTracker::Stats ResultTracker::getClientStats(const std::string& clientId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
     Stats stats;
-    auto it = clientRequests_.find(clientId);
-    if (it == clientRequests_.end()) return stats;
-
-    for (const auto& reqId : it->second) {
-        auto resIt = results_.find(reqId);
-        if (resIt == results_.end()) continue;
-        stats.totalRequests++;
-        switch (resIt->second.status) {
-            case TradeStatus::SUCCESS:         stats.successful++; break;
-            case TradeStatus::DUPLICATE:       stats.duplicates++; break;
-            case TradeStatus::REJECTED:
-            case TradeStatus::MARGIN_ERROR:
-            case TradeStatus::RETRY_EXHAUSTED: stats.rejected++;   break;
-            case TradeStatus::CONNECTION_ERROR:
-            case TradeStatus::INVALID_PARAMS:  stats.errors++;     break;
-        }
-    }
+    scan(ResultQuery().forClient(clientId), [&](const TradeResult& result) {
+        tally(stats, result.status);
+        return true;
+    });
     return stats;
 }
 
@@ -91,7 +228,11 @@ void ResultTracker::printSummary() const {
               << "================================================================\n";
 
     // Per-client breakdown
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> clients;
+    {
+        std::shared_lock<std::shared_mutex> lock(keysMutex_);
+        for (const auto& [clientId, postings] : byClient_) clients.push_back(clientId);
+    }
     std::cout << "\n  Per-Client Breakdown:\n";
     std::cout << "  " << std::left << std::setw(12) << "Client"
               << std::setw(8) << "Total"
@@ -100,20 +241,13 @@ void ResultTracker::printSummary() const {
               << std::setw(8) << "Dup" << "\n";
     std::cout << "  " << std::string(44, '-') << "\n";
 
-    for (const auto& [clientId, reqIds] : clientRequests_) {
-        int ok = 0, fail = 0, dup = 0;
-        for (const auto& reqId : reqIds) {
-            auto it = results_.find(reqId);
-            if (it == results_.end()) continue;
-            if (it->second.isSuccess()) ok++;
-            else if (it->second.status == TradeStatus::DUPLICATE) dup++;
-            else fail++;
-        }
+    for (const auto& clientId : clients) {
+        Stats client = getClientStats(clientId);
         std::cout << "  " << std::left << std::setw(12) << clientId
-                  << std::setw(8) << reqIds.size()
-                  << std::setw(8) << ok
-                  << std::setw(8) << fail
-                  << std::setw(8) << dup << "\n";
+                  << std::setw(8) << client.totalRequests
+                  << std::setw(8) << client.successful
+                  << std::setw(8) << client.totalRequests - client.successful - client.duplicates
+                  << std::setw(8) << client.duplicates << "\n";
     }
 
     // Request ID -> Ticket ID mapping (bonus feature)
@@ -122,13 +256,12 @@ void ResultTracker::printSummary() const {
               << std::setw(12) << "Ticket"
               << "Price" << "\n";
     std::cout << "  " << std::string(50, '-') << "\n";
-    for (const auto& [reqId, result] : results_) {
-        if (result.isSuccess()) {
-            std::cout << "  " << std::left << std::setw(22) << reqId
-                      << std::setw(12) << ("#" + result.mtTicketId)
-                      << std::fixed << std::setprecision(5) << result.executionPrice
-                      << "\n";
-        }
-    }
+    scan(ResultQuery().withStatus(TradeStatus::SUCCESS), [](const TradeResult& result) {
+        std::cout << "  " << std::left << std::setw(22) << result.requestId
+                  << std::setw(12) << ("#" + result.mtTicketId)
+                  << std::fixed << std::setprecision(5) << result.executionPrice
+                  << "\n";
+        return true;
+    });
     std::cout << "================================================================\n\n";
 }
@@ -1,22 +1,104 @@
 #pragma once
 
 #include "models/TradeResult.h"
+#include "persistence/StateJournal.h"
+#include "persistence/ResultFeed.h"
+#include "tracker/AppendLog.h"
 
+#include <array>
+#include <atomic>
 #include <unordered_map>
 #include <vector>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <optional>
+#include <chrono>
+#include <limits>
+#include <functional>
+
+/// Filter for ResultTracker::query(). Conditions compose with AND; the
+/// status set is an OR over statuses. Example:
+///   ResultQuery().forSymbol("XAUUSD").failuresOnly().since(now - 5min)
+struct ResultQuery {
+    static constexpr uint32_t ALL_STATUSES = 0xFFFFFFFFu;
+
+    std::string clientId;                     // Empty = any client
+    std::string symbol;                       // Empty = any symbol
+    uint32_t    statuses = ALL_STATUSES;      // Bit (1 << TradeStatus)
+    std::optional<std::chrono::system_clock::time_point> from;   // timestamp >= from
+    std::optional<std::chrono::system_clock::time_point> to;     // timestamp <  to
+    size_t      limit = std::numeric_limits<size_t>::max();
+
+    ResultQuery& forClient(std::string id)    { clientId = std::move(id); return *this; }
+    ResultQuery& forSymbol(std::string name)  { symbol = std::move(name); return *this; }
+    /// Restrict to `status`; repeated calls add statuses.
+    ResultQuery& withStatus(TradeStatus status) {
+        uint32_t bit = 1u << static_cast<uint32_t>(status);
+        statuses = statuses == ALL_STATUSES ? bit : statuses | bit;
+        return *this;
+    }
+    ResultQuery& failuresOnly() {
+        statuses = ALL_STATUSES & ~(1u << static_cast<uint32_t>(TradeStatus::SUCCESS));
+        return *this;
+    }
+    ResultQuery& since(std::chrono::system_clock::time_point t) { from = t; return *this; }
+    ResultQuery& until(std::chrono::system_clock::time_point t) { to = t; return *this; }
+    /// Results from the last `window` (relative to now).
+    ResultQuery& within(std::chrono::system_clock::duration window) {
+        return since(std::chrono::system_clock::now() - window);
+    }
+    ResultQuery& take(size_t n) { limit = n; return *this; }
+};
 
 /// Thread-safe result tracker.
 /// Maintains the mapping between client request IDs and MT ticket IDs (bonus requirement).
-/// Allows querying results by request ID or client ID.
+/// Allows querying results by request ID or client ID, and ad-hoc queries
+/// by client, symbol, status and time.
+///
+/// Storage is an append-only log of entries (one per record() call) plus
+/// secondary indexes, all maintained incrementally by record():
+///   - per status, per symbol and per client: ascending entry positions;
+///   - per wall-clock second: the first entry recorded in it.
+/// A result recorded again for the same request ID supersedes the earlier
+/// entry (last write wins, as for getByRequestId()).
+///
+/// Queries never take the record() lock. They pin a snapshot (the published
+/// entry count), narrow the range with the time index, walk the smallest
+/// matching posting list, and filter. Entries and posting lists never move
+/// once published (AppendLog), so readers run concurrently with writers and
+/// see exactly the results recorded before the snapshot.
 class ResultTracker {
 public:
     void record(const TradeResult& result);
 
+    /// Record `count` results under one lock acquisition (workers flushing
+    /// their result batch).
+    void record(const TradeResult* results, size_t count);
+
+    /// Append every recorded result to `journal` (nullptr = stop). Set after
+    /// restoring persisted results, so they are not journaled twice.
+    void setJournal(StateJournal* journal);
+
+    /// Switch the journal to its next segment (StateJournal::rotate); sets
+    /// `closed` to the closed segment. Under the tracker lock, so the closed
+    /// segments hold exactly the results recorded so far.
+    bool rotateJournal(uint64_t& closed, std::string& error);
+
+    /// Publish every recorded result to the change-data-capture `feed`
+    /// (nullptr = stop), in record order. Like setJournal(), set it after
+    /// restoring persisted results.
+    void setFeed(ResultFeed* feed);
+
     std::optional<TradeResult> getByRequestId(const std::string& requestId) const;
     std::vector<TradeResult>   getByClientId(const std::string& clientId) const;
 
+    /// Matching results in record order (at most query.limit).
+    std::vector<TradeResult> query(const ResultQuery& query) const;
+
+    /// Number of matching results (ignores query.limit).
+    size_t count(const ResultQuery& query) const;
+
     // Summary statistics
     struct Stats {
         int totalRequests  = 0;
@@ -31,10 +113,50 @@ public:
     void  printSummary() const;
 
 private:
-    // request ID -> result
-    std::unordered_map<std::string, TradeResult> results_;
-    // client ID -> list of request IDs
-    std::unordered_map<std::string, std::vector<std::string>> clientRequests_;
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+    static constexpr size_t   STATUS_COUNT = static_cast<size_t>(TradeStatus::RETRY_EXHAUSTED) + 1;
+
+    struct Entry {
+        TradeResult           result;
+        std::atomic<uint32_t> supersededBy{NONE};   // Later entry for the same request ID
+    };
+
+    struct Bucket {
+        int64_t  second;       // Wall-clock second (non-decreasing)
+        uint32_t firstEntry;   // First entry recorded in it
+    };
+
+    using Postings = AppendLog<uint32_t>;
+
+    /// Posting list for `key`, created on first use (writer only).
+    static Postings& postingsFor(std::unordered_map<std::string, std::unique_ptr<Postings>>& index,
+                                 const std::string& key, std::shared_mutex& mutex);
+    const Postings* findPostings(const std::unordered_map<std::string, std::unique_ptr<Postings>>& index,
+                                 const std::string& key) const;
+
+    /// Call fn(entry) for each match in snapshot order; stop when fn returns false.
+    void scan(const ResultQuery& query, const std::function<bool(const TradeResult&)>& fn) const;
+
+    static void tally(Stats& stats, TradeStatus status);
+
+    void recordLocked(const TradeResult& result);
+
+    // Writers (record) serialize on mutex_; readers use the lock-free logs
+    AppendLog<Entry>                          entries_;
+    std::array<Postings, STATUS_COUNT>        byStatus_;
+    AppendLog<Bucket>                         buckets_;
+
+    // Posting lists by symbol / client: the maps change only when a new key
+    // appears (unique lock); queries look up under a shared lock.
+    std::unordered_map<std::string, std::unique_ptr<Postings>> bySymbol_;
+    std::unordered_map<std::string, std::unique_ptr<Postings>> byClient_;
+    mutable std::shared_mutex                                  keysMutex_;
+
+    // request ID -> latest entry (guarded by mutex_)
+    std::unordered_map<std::string, uint32_t> latest_;
+
+    StateJournal* journal_ = nullptr;
+    ResultFeed*   feed_    = nullptr;
 
     mutable std::mutex mutex_;
 };
@@ -0,0 +1,109 @@
+#include "TestSupport.h"
+#include "tracker/AppendLog.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Two fields written separately: a reader that sees one without the other
+/// has read an element before it was published.
+struct Entry {
+    uint64_t value = 0;
+    uint64_t check = 0;
+};
+
+static void publishesInOrder() {
+    AppendLog<int, 2> log;   // 4 per chunk: the directory grows several times
+    CHECK(log.size() == 0);
+
+    const int* first = nullptr;
+    for (int i = 0; i < 100; ++i) {
+        log.push_back(i * 10);
+        if (i == 0) first = &log[0];
+        CHECK(log.size() == static_cast<size_t>(i + 1));
+    }
+    for (int i = 0; i < 100; ++i) CHECK(log[i] == i * 10);
+
+    // Elements never move when the directory grows
+    CHECK(first == &log[0]);
+}
+
+static void nextIsHiddenUntilPublished() {
+    AppendLog<std::string, 2> log;
+    log.next() = "pending";
+    CHECK(log.size() == 0);
+    log.publish();
+    CHECK(log.size() == 1);
+    CHECK(log[0] == "pending");
+
+    // Writer-side updates of a published element
+    log[0] += "!";
+    CHECK(static_cast<const AppendLog<std::string, 2>&>(log)[0] == "pending!");
+}
+
+static void lowerBoundOnSortedLog() {
+    AppendLog<int, 2> log;
+    for (int i = 0; i < 50; ++i) log.push_back(i * 2);
+    auto less = [](int element, int key) { return element < key; };
+    CHECK(log.lowerBound(log.size(), 0, less) == 0);
+    CHECK(log.lowerBound(log.size(), 7, less) == 4);
+    CHECK(log.lowerBound(log.size(), 8, less) == 4);
+    CHECK(log.lowerBound(log.size(), 1000, less) == 50);
+
+    // Bounded by a size read earlier, not the current one
+    CHECK(log.lowerBound(10, 1000, less) == 10);
+}
+
+static void readersSeeOnlyPublishedElements() {
+    constexpr uint64_t COUNT   = 200000;
+    constexpr int      READERS = 3;
+
+    AppendLog<Entry, 4> log;
+    std::atomic<bool>   done{false};
+    std::atomic<int>    torn{0};
+    std::atomic<uint64_t> reads{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < READERS; ++r) {
+        readers.emplace_back([&] {
+            size_t seen = 0;
+            while (!done.load(std::memory_order_acquire) || seen < log.size()) {
+                size_t size = log.size();
+                if (size < seen) ++torn;   // Published size went backwards
+                // Everything newly published, plus the first element again
+                for (size_t i = seen; i < size; ++i) {
+                    const Entry& entry = log[i];
+                    if (entry.value != i || entry.check != ~entry.value) ++torn;
+                }
+                if (size > 0 && log[0].check != ~uint64_t{0}) ++torn;
+                reads.fetch_add(size - seen, std::memory_order_relaxed);
+                seen = size;
+            }
+        });
+    }
+
+    for (uint64_t i = 0; i < COUNT; ++i) {
+        Entry& entry = log.next();
+        entry.value = i;
+        entry.check = ~i;
+        log.publish();
+        if (i % 1024 == 0) std::this_thread::yield();   // Interleave with readers on few cores
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& t : readers) t.join();
+
+    CHECK(log.size() == COUNT);
+    CHECK(torn.load() == 0);
+    CHECK(reads.load() == COUNT * READERS);
+}
+
+int main() {
+    return runTests({
+        {"publishes in order", publishesInOrder},
+        {"next is hidden until published", nextIsHiddenUntilPublished},
+        {"lower bound on a sorted log", lowerBoundOnSortedLog},
+        {"readers see only published elements", readersSeeOnlyPublishedElements},
+    });
+}
@@ -0,0 +1,191 @@
+#include "TestSupport.h"
+#include "mt_api/BrokerRouter.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/// Backend that answers every trade with `status`, optionally holding each
+/// one until release() is called.
+class FakeBackend final : public IMTBrokerAPI {
+public:
+    FakeBackend(TradeStatus status, std::string ticket, bool gated = false)
+        : status_(status), ticket_(std::move(ticket)), gated_(gated) {}
+
+    bool connect(const std::string&, int, const std::string&) override { return true; }
+    void disconnect() override {}
+    bool isConnected() const override { return true; }
+    std::optional<SymbolInfo>  getSymbolInfo(const std::string&) override { return std::nullopt; }
+    std::optional<AccountInfo> getAccountInfo(int) override { return std::nullopt; }
+    std::optional<TradeResult> getTicketInfo(const std::string&) override { return std::nullopt; }
+    std::vector<std::string>   getSymbols() override { return {}; }
+
+    TradeResult executeTrade(const TradeRequest& request) override {
+        calls.fetch_add(1);
+        if (gated_) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return released_; });
+        }
+        TradeResult result;
+        result.requestId      = request.requestId;
+        result.clientId       = request.clientId;
+        result.status         = status_;
+        result.mtTicketId     = status_ == TradeStatus::SUCCESS ? ticket_ : "";
+        result.executionPrice = 1.0;
+        result.retryCount     = 0;
+        result.timestamp      = std::chrono::system_clock::now();
+        return result;
+    }
+
+    void release() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            released_ = true;
+        }
+        cv_.notify_all();
+    }
+
+    /// Wait until `count` trades have reached the backend.
+    void waitForCalls(int count) {
+        while (calls.load() < count) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::atomic<int> calls{0};
+
+private:
+    TradeStatus             status_;
+    std::string             ticket_;
+    bool                    gated_;
+    std::mutex              mutex_;
+    std::condition_variable cv_;
+    bool                    released_ = false;
+};
+
+static TradeRequest makeRequest(const std::string& requestId) {
+    TradeRequest request;
+    request.clientId  = "CLIENT_1";
+    request.requestId = requestId;
+    request.tradeType = TradeType::BUY;
+    request.symbol    = "EURUSD";
+    request.volume    = 0.1;
+    request.timestamp = std::chrono::system_clock::now();
+    return request;
+}
+
+static BrokerRouter::Options firstPolicy() {
+    BrokerRouter::Options options;
+    options.policy           = RoutingPolicy::FIRST;
+    options.failureThreshold = 2;
+    options.cooldown         = std::chrono::milliseconds(60000);
+    options.queueTimeout     = std::chrono::milliseconds(50);
+    return options;
+}
+
+static bool summaryHas(const BrokerRouter& router, const std::string& backend, const std::string& text) {
+    for (const auto& line : router.backendSummary()) {
+        if (line.find("Backend " + backend + " ") == 0) return line.find(text) != std::string::npos;
+    }
+    return false;
+}
+
+static void connectionErrorFailsOver() {
+    Logger logger("", LogLevel::ERROR);
+    FakeBackend down(TradeStatus::CONNECTION_ERROR, "");
+    FakeBackend up(TradeStatus::SUCCESS, "T1");
+    BrokerRouter router(logger, firstPolicy());
+    router.addBackend("down", down);
+    router.addBackend("up", up);
+
+    for (int i = 0; i < 2; ++i) {
+        TradeResult result = router.executeTrade(makeRequest("R" + std::to_string(i)));
+        CHECK(result.isSuccess());
+        CHECK(result.mtTicketId == "up:T1");
+    }
+    CHECK(down.calls.load() == 2);
+    CHECK(summaryHas(router, "down", "[UNHEALTHY]"));
+    CHECK(summaryHas(router, "down", "conn_errors=2"));
+
+    // Marked down after failureThreshold errors: tried last from now on
+    CHECK(router.executeTrade(makeRequest("R2")).isSuccess());
+    CHECK(down.calls.load() == 2);
+    CHECK(up.calls.load() == 3);
+}
+
+static void allBackendsDown() {
+    Logger logger("", LogLevel::ERROR);
+    FakeBackend a(TradeStatus::CONNECTION_ERROR, "");
+    FakeBackend b(TradeStatus::CONNECTION_ERROR, "");
+    BrokerRouter router(logger, firstPolicy());
+    router.addBackend("a", a);
+    router.addBackend("b", b);
+
+    TradeResult result = router.executeTrade(makeRequest("R1"));
+    CHECK(result.status == TradeStatus::CONNECTION_ERROR);
+    CHECK(result.mtTicketId.empty());
+    CHECK(a.calls.load() == 1);
+    CHECK(b.calls.load() == 1);
+}
+
+static void queueTimeoutFailsOver() {
+    Logger logger("", LogLevel::ERROR);
+    FakeBackend slow(TradeStatus::SUCCESS, "S1", true);
+    FakeBackend fast(TradeStatus::SUCCESS, "F1");
+    BrokerRouter router(logger, firstPolicy());
+    router.addBackend("slow", slow, BackendConfig{1, 8});
+    router.addBackend("fast", fast);
+
+    // Occupy slow's only executor thread
+    TradeResult first;
+    std::thread holder([&] { first = router.executeTrade(makeRequest("R1")); });
+    slow.waitForCalls(1);
+
+    // Queued behind it: withdrawn after queueTimeout and sent to fast
+    TradeResult second = router.executeTrade(makeRequest("R2"));
+    CHECK(second.isSuccess());
+    CHECK(second.mtTicketId == "fast:F1");
+    CHECK(summaryHas(router, "slow", "timeouts=1"));
+
+    // A trade already executing is waited for, not failed over
+    slow.release();
+    holder.join();
+    CHECK(first.isSuccess());
+    CHECK(first.mtTicketId == "slow:S1");
+    CHECK(fast.calls.load() == 1);
+
+    // The withdrawn job is never executed
+    CHECK(router.executeTrade(makeRequest("R3")).mtTicketId == "slow:S1");
+    CHECK(slow.calls.load() == 2);
+    CHECK(summaryHas(router, "slow", "[healthy]"));
+}
+
+static void fullQueueFailsOver() {
+    Logger logger("", LogLevel::ERROR);
+    FakeBackend slow(TradeStatus::SUCCESS, "S1", true);
+    FakeBackend fast(TradeStatus::SUCCESS, "F1");
+    BrokerRouter router(logger, firstPolicy());
+    router.addBackend("slow", slow, BackendConfig{1, 0});
+    router.addBackend("fast", fast);
+
+    TradeResult first;
+    std::thread holder([&] { first = router.executeTrade(makeRequest("R1")); });
+    slow.waitForCalls(1);
+
+    TradeResult second = router.executeTrade(makeRequest("R2"));
+    CHECK(second.mtTicketId == "fast:F1");
+    CHECK(summaryHas(router, "slow", "overflows=1"));
+    CHECK(summaryHas(router, "slow", "timeouts=0"));
+
+    slow.release();
+    holder.join();
+    CHECK(first.mtTicketId == "slow:S1");
+}
+
+int main() {
+    return runTests({
+        {"connection error fails over", connectionErrorFailsOver},
+        {"all backends down", allBackendsDown},
+        {"queue timeout fails over", queueTimeoutFailsOver},
+        {"full queue fails over", fullQueueFailsOver},
+    });
+}
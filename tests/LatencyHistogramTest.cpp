@@ -0,0 +1,107 @@
+#include "TestSupport.h"
+#include "processor/LatencyHistogram.h"
+
+#include <cmath>
+#include <thread>
+#include <vector>
+
+using std::chrono::nanoseconds;
+
+static constexpr uint64_t HUGE_NS = uint64_t{1} << 41;
+
+static uint64_t toNs(double us) {
+    return static_cast<uint64_t>(std::llround(us * 1000.0));
+}
+
+/// Upper bound of the bucket holding `ns`: the lowest percentile of
+/// {ns, HUGE_NS}, which max() does not clamp.
+static uint64_t bucketBoundNs(uint64_t ns) {
+    LatencyHistogram histogram;
+    histogram.record(nanoseconds(ns));
+    histogram.record(nanoseconds(HUGE_NS));
+    return toNs(histogram.percentileUs(0.0));
+}
+
+static void bucketBoundsContainTheSample() {
+    // Below SUB_BUCKETS every nanosecond has its own bucket
+    for (uint64_t ns = 0; ns < 4; ++ns) CHECK(bucketBoundNs(ns) == ns);
+
+    uint64_t previous = 0;
+    for (uint64_t ns = 4; ns < (uint64_t{1} << 40); ns = ns + ns / 7 + 1) {
+        uint64_t bound = bucketBoundNs(ns);
+        CHECK(bound >= ns);
+        CHECK(static_cast<double>(bound) <= 1.25 * static_cast<double>(ns));   // Four buckets per power of two
+        CHECK(bound >= previous);
+
+        // The bound is the bucket's last value; one more is the next bucket
+        CHECK(bucketBoundNs(bound) == bound);
+        CHECK(bucketBoundNs(bound + 1) > bound);
+        previous = bound;
+    }
+}
+
+static void bucketEdgesAtPowersOfTwo() {
+    for (int shift = 2; shift < 40; ++shift) {
+        uint64_t power = uint64_t{1} << shift;
+        uint64_t width = power / 4;
+        // [2^k, 2^k + w) is the first of four equal buckets
+        CHECK(bucketBoundNs(power) == power + width - 1);
+        CHECK(bucketBoundNs(power - 1) == power - 1);
+        CHECK(bucketBoundNs(2 * power - 1) == 2 * power - 1);
+    }
+}
+
+static void percentilesAreClampedToMax() {
+    LatencyHistogram histogram;
+    CHECK(histogram.count() == 0);
+    CHECK(histogram.percentileUs(0.99) == 0.0);
+
+    histogram.record(nanoseconds(1001));
+    CHECK(toNs(histogram.percentileUs(0.5)) == 1001);   // Bucket bound is 1023
+    CHECK(toNs(histogram.percentileUs(1.0)) == 1001);
+
+    // Negative latencies count as zero
+    histogram.record(nanoseconds(-5));
+    CHECK(histogram.count() == 2);
+    CHECK(toNs(histogram.percentileUs(0.0)) == 0);
+}
+
+static void percentileRanks() {
+    LatencyHistogram histogram;
+    for (int us = 1; us <= 100; ++us) histogram.record(std::chrono::microseconds(us));
+    CHECK(histogram.count() == 100);
+    CHECK(std::abs(histogram.meanUs() - 50.5) < 1e-9);
+    CHECK(histogram.maxUs() == 100.0);
+
+    // p50 is the 51st sample's bucket, p99 the 100th (clamped to max)
+    double p50 = histogram.percentileUs(0.50);
+    CHECK(p50 >= 51.0 && p50 <= 51.0 * 1.25);
+    CHECK(histogram.percentileUs(0.99) == 100.0);
+    CHECK(histogram.summary().find("n=100 mean=50.5us") == 0);
+}
+
+static void concurrentRecords() {
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 50000;
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < PER_THREAD; ++i) histogram.record(nanoseconds(1000 * (t + 1)));
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    CHECK(histogram.count() == uint64_t{THREADS} * PER_THREAD);
+    CHECK(toNs(histogram.maxUs()) == 4000);
+    CHECK(std::abs(histogram.meanUs() - 2.5) < 1e-9);
+}
+
+int main() {
+    return runTests({
+        {"bucket bounds contain the sample", bucketBoundsContainTheSample},
+        {"bucket edges at powers of two", bucketEdgesAtPowersOfTwo},
+        {"percentiles are clamped to max", percentilesAreClampedToMax},
+        {"percentile ranks", percentileRanks},
+        {"concurrent records", concurrentRecords},
+    });
+}
@@ -0,0 +1,107 @@
+#include "TestSupport.h"
+#include "processor/DealProcessor.h"
+#include "mt_api/NullBroker.h"
+
+#include <atomic>
+#include <thread>
+
+static TradeRequest makeRequest(const std::string& clientId, RequestIdSequence& ids) {
+    TradeRequest request;
+    request.clientId  = clientId;
+    request.requestId = RequestIdFormat::format(clientId, ids.next());
+    request.tradeType = TradeType::BUY;
+    request.symbol    = "EURUSD";
+    request.volume    = 0.1;
+    request.timestamp = std::chrono::system_clock::now();
+    return request;
+}
+
+static ProcessorConfig reactorConfig() {
+    ProcessorConfig config;
+    config.model        = ExecutionModel::REACTOR;
+    config.reactorLoops = 2;
+    config.maxRetries   = 0;
+    return config;
+}
+
+/// Producers keep submitting while stop() runs: every request accepted
+/// before it is answered, everything after it is refused, and stop()
+/// returns.
+static void stopWithSubmitsInFlight(bool withCompletionThreads) {
+    constexpr int PRODUCERS = 4;
+    constexpr int REQUESTS  = 3000;
+
+    for (int round = 0; round < 5; ++round) {
+        Logger logger("", LogLevel::ERROR);
+        NullBroker broker;
+        broker.connect("test", 1, "");
+        ProcessorConfig config = reactorConfig();
+        config.completionThreads = withCompletionThreads ? 1 : 0;
+        DealProcessor processor(broker, logger, config);
+        processor.start();
+
+        // Half the producers use callbacks, half use sessions
+        std::atomic<int> callbacks{0};
+        std::vector<std::shared_ptr<ClientSession>> sessions;
+        std::vector<int> accepted(PRODUCERS, 0);
+        for (int p = 0; p < PRODUCERS; ++p) {
+            sessions.push_back(p % 2 ? processor.openSession("SESSION_" + std::to_string(p), REQUESTS) : nullptr);
+        }
+
+        std::atomic<int> started{0};
+        std::vector<std::thread> producers;
+        for (int p = 0; p < PRODUCERS; ++p) {
+            producers.emplace_back([&, p] {
+                RequestIdSequence ids;
+                std::string clientId = "CLIENT_" + std::to_string(p);
+                started.fetch_add(1);
+                for (int i = 0; i < REQUESTS; ++i) {
+                    if (sessions[p]) {
+                        if (processor.submit(sessions[p], makeRequest(clientId, ids))) ++accepted[p];
+                    } else {
+                        processor.submit(makeRequest(clientId, ids), [&](const TradeResult&) { callbacks.fetch_add(1); });
+                    }
+                }
+            });
+        }
+
+        while (started.load() < PRODUCERS) std::this_thread::yield();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1 + round));
+        processor.stop();
+        for (auto& t : producers) t.join();
+
+        int sessionAccepted = 0;
+        for (int p = 0; p < PRODUCERS; ++p) {
+            if (!sessions[p]) continue;
+            sessionAccepted += accepted[p];
+            CHECK(sessions[p]->delivered() == static_cast<uint64_t>(accepted[p]));
+            CHECK(sessions[p]->inFlight() == 0);
+        }
+
+        // Everything tracked was delivered; nothing arrives after stop()
+        int tracked = processor.getTracker().getStats().totalRequests;
+        CHECK(tracked == callbacks.load() + sessionAccepted);
+        CHECK(tracked <= PRODUCERS * REQUESTS);
+
+        // Refused once stopped, with the session credit returned
+        RequestIdSequence ids;
+        size_t available = sessions[1]->available();
+        CHECK(!processor.submit(sessions[1], makeRequest("SESSION_1", ids)));
+        CHECK(sessions[1]->available() == available);
+    }
+}
+
+static void stopDrainsLoops() {
+    stopWithSubmitsInFlight(false);
+}
+
+static void stopDrainsCompletionThreads() {
+    stopWithSubmitsInFlight(true);
+}
+
+int main() {
+    return runTests({
+        {"stop with submits in flight", stopDrainsLoops},
+        {"stop with submits in flight (completion threads)", stopDrainsCompletionThreads},
+    });
+}
@@ -0,0 +1,241 @@
+#include "TestSupport.h"
+#include "persistence/ResultFeed.h"
+#include "models/RequestId.h"
+
+#include <cstddef>
+#include <fstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+static TradeResult makeResult(uint64_t seq) {
+    TradeResult result;
+    result.requestId      = RequestIdFormat::format("CLIENT_" + std::to_string(seq % 7), seq);
+    result.clientId       = "CLIENT_" + std::to_string(seq % 7);
+    result.symbol         = "EURUSD";
+    result.status         = TradeStatus::SUCCESS;
+    result.mtTicketId     = "T" + std::to_string(seq);
+    result.executionPrice = 1.0 + seq / 1e5;
+    result.retryCount     = 0;
+    result.timestamp      = std::chrono::system_clock::now();
+    return result;
+}
+
+static ResultFeed::Options smallSegments(size_t retain = 0) {
+    ResultFeed::Options options;
+    options.segmentBytes   = 64 * 1024;
+    options.retainSegments = retain;
+    return options;
+}
+
+static FeedSegmentHeader readHeader(const std::string& path) {
+    FeedSegmentHeader header{};
+    std::ifstream in(path, std::ios::binary);
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    return header;
+}
+
+/// Append records [from, to], retrying any the feed drops because its spare
+/// segment is not ready yet (append() never waits for one).
+static void appendAll(ResultFeed& feed, uint64_t from, uint64_t to) {
+    for (uint64_t seq = from; seq <= to; ++seq) {
+        uint64_t appended;
+        while ((appended = feed.append(makeResult(seq))) == 0) std::this_thread::yield();
+        CHECK(appended == seq);
+    }
+}
+
+/// Read everything from `from` on; checks each record against makeResult().
+static uint64_t readAll(FeedReader& reader, uint64_t from, bool& intact) {
+    uint64_t expected = from;
+    uint64_t count = 0;
+    while (reader.poll([&](uint64_t sequence, TradeResult&& result) {
+        if (sequence != expected || result.mtTicketId != "T" + std::to_string(sequence) ||
+            result.requestId != makeResult(sequence).requestId) {
+            intact = false;
+        }
+        expected = sequence + 1;
+        ++count;
+    }) > 0) {}
+    return count;
+}
+
+static void rollsOverAndSeals() {
+    TempDir dir("feed_rollover");
+    {
+        ResultFeed feed(dir.path(), smallSegments());
+        std::string error;
+        CHECK(feed.open(error));
+        appendAll(feed, 1, 2000);
+        CHECK(feed.nextSequence() == 2001);
+    }
+
+    auto segments = ResultFeed::listSegments(dir.path());
+    CHECK(segments.size() > 2);
+    CHECK(!segments.empty() && segments.front() == 1);
+    CHECK(!fs::exists(fs::path(dir.path()) / "feed.spare") ||
+          readHeader((fs::path(dir.path()) / "feed.spare").string()).committed == 0);
+
+    // Every full segment is sealed and continues where the previous ended
+    for (size_t i = 0; i + 1 < segments.size(); ++i) {
+        FeedSegmentHeader header = readHeader(ResultFeed::segmentPath(dir.path(), segments[i]));
+        CHECK(header.firstSequence == segments[i]);
+        CHECK(header.sealed == 1);
+        CHECK(header.committed > 0 && header.committed <= header.capacity);
+    }
+    CHECK(readHeader(ResultFeed::segmentPath(dir.path(), segments.back())).sealed == 0);
+
+    FeedReader reader(dir.path());
+    std::string error;
+    CHECK(reader.seek(1, error));
+    bool intact = true;
+    CHECK(readAll(reader, 1, intact) == 2000);
+    CHECK(intact);
+    CHECK(reader.cursor() == 2001);
+    CHECK(reader.skipped() == 0);
+    CHECK(reader.corrupt() == 0);
+
+    // A restarted producer continues after the last committed record
+    {
+        ResultFeed feed(dir.path(), smallSegments());
+        CHECK(feed.open(error));
+        CHECK(feed.nextSequence() == 2001);
+        CHECK(feed.append(makeResult(2001)) == 2001);
+    }
+    CHECK(readAll(reader, 2001, intact) == 1);
+    CHECK(intact);
+}
+
+static void readerFollowsLiveProducer() {
+    TempDir dir("feed_live");
+    ResultFeed feed(dir.path(), smallSegments());
+    std::string error;
+    CHECK(feed.open(error));
+
+    FeedReader reader(dir.path());
+    CHECK(reader.seek(1, error));
+    bool intact = true;
+    uint64_t read = 0;
+    for (uint64_t seq = 1; seq <= 1000; ++seq) {
+        appendAll(feed, seq, seq);
+        if (seq % 50 == 0) read += readAll(reader, read + 1, intact);
+    }
+    CHECK(read == 1000);
+    CHECK(intact);
+
+    // Cursors persist by name
+    CHECK(FeedReader::saveCursor(dir.path(), "risk", reader.cursor()));
+    auto saved = FeedReader::loadCursor(dir.path(), "risk");
+    CHECK(saved && *saved == 1001);
+    CHECK(!FeedReader::loadCursor(dir.path(), "backoffice"));
+}
+
+static void retentionCountsTheGap() {
+    TempDir dir("feed_retention");
+    {
+        ResultFeed feed(dir.path(), smallSegments(2));
+        std::string error;
+        CHECK(feed.open(error));
+        appendAll(feed, 1, 3000);
+    }
+    auto segments = ResultFeed::listSegments(dir.path());
+    CHECK(segments.size() == 2);
+
+    FeedReader reader(dir.path());
+    std::string error;
+    CHECK(reader.seek(1, error));
+    CHECK(reader.cursor() == segments.front());
+    CHECK(reader.skipped() == segments.front() - 1);
+    bool intact = true;
+    CHECK(readAll(reader, segments.front(), intact) == 3001 - segments.front());
+    CHECK(intact);
+}
+
+static void skipsCorruptRecord() {
+    TempDir dir("feed_corrupt");
+    std::string error;
+    {
+        ResultFeed feed(dir.path(), smallSegments());
+        CHECK(feed.open(error));
+        appendAll(feed, 1, 10);
+    }
+
+    // Flip a payload byte of record 5 (records are padded to 8 bytes)
+    std::string path = ResultFeed::segmentPath(dir.path(), 1);
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        uint64_t offset = FEED_DATA_OFFSET;
+        for (int i = 1; i < 5; ++i) {
+            FeedRecordHeader head;
+            file.seekg(offset);
+            file.read(reinterpret_cast<char*>(&head), sizeof(head));
+            offset += (sizeof(head) + head.length + 7) & ~uint64_t{7};
+        }
+        char byte;
+        file.seekg(offset + sizeof(FeedRecordHeader) + 4);
+        file.read(&byte, 1);
+        byte ^= 0x5a;
+        file.seekp(offset + sizeof(FeedRecordHeader) + 4);
+        file.write(&byte, 1);
+    }
+
+    FeedReader reader(dir.path());
+    CHECK(reader.seek(1, error));
+    std::vector<uint64_t> sequences;
+    while (reader.poll([&](uint64_t sequence, TradeResult&& result) {
+        CHECK(result.mtTicketId == "T" + std::to_string(sequence));
+        sequences.push_back(sequence);
+    }) > 0) {}
+
+    CHECK(sequences == std::vector<uint64_t>{1, 2, 3, 4, 6, 7, 8, 9, 10});
+    CHECK(reader.corrupt() == 1);
+    CHECK(reader.skipped() == 1);
+    CHECK(reader.cursor() == 11);
+}
+
+static void reopenSealsOlderSegments() {
+    TempDir dir("feed_unsealed");
+    std::string error;
+    {
+        ResultFeed feed(dir.path(), smallSegments());
+        CHECK(feed.open(error));
+        appendAll(feed, 1, 2000);
+    }
+
+    // A crash between naming a segment and sealing its predecessor
+    auto segments = ResultFeed::listSegments(dir.path());
+    CHECK(segments.size() > 2);
+    std::string middle = ResultFeed::segmentPath(dir.path(), segments[1]);
+    {
+        std::fstream file(middle, std::ios::in | std::ios::out | std::ios::binary);
+        uint32_t unsealed = 0;
+        file.seekp(offsetof(FeedSegmentHeader, sealed));
+        file.write(reinterpret_cast<const char*>(&unsealed), sizeof(unsealed));
+    }
+    CHECK(readHeader(middle).sealed == 0);
+
+    {
+        ResultFeed feed(dir.path(), smallSegments());
+        CHECK(feed.open(error));
+        CHECK(feed.nextSequence() == 2001);
+    }
+    CHECK(readHeader(middle).sealed == 1);
+    CHECK(readHeader(ResultFeed::segmentPath(dir.path(), segments.back())).sealed == 0);
+
+    // Consumers read past it
+    FeedReader reader(dir.path());
+    CHECK(reader.seek(1, error));
+    bool intact = true;
+    CHECK(readAll(reader, 1, intact) == 2000);
+    CHECK(intact);
+}
+
+int main() {
+    return runTests({
+        {"rolls over and seals", rollsOverAndSeals},
+        {"reader follows a live producer", readerFollowsLiveProducer},
+        {"retention counts the gap", retentionCountsTheGap},
+        {"skips a corrupt record", skipsCorruptRecord},
+        {"reopen seals older segments", reopenSealsOlderSegments},
+    });
+}
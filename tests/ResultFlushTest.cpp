@@ -0,0 +1,199 @@
+#include "TestSupport.h"
+#include "processor/DealProcessor.h"
+#include "mt_api/NullBroker.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+/// NullBroker whose fills each take `delay`, recording when each one
+/// finished.
+class DelayedBroker final : public IMTBrokerAPI {
+public:
+    explicit DelayedBroker(std::chrono::milliseconds delay) : delay_(delay) {}
+
+    bool connect(const std::string& server, int login, const std::string& password) override {
+        return fills_.connect(server, login, password);
+    }
+    void disconnect() override { fills_.disconnect(); }
+    bool isConnected() const override { return fills_.isConnected(); }
+    std::optional<SymbolInfo>  getSymbolInfo(const std::string& symbol) override { return fills_.getSymbolInfo(symbol); }
+    std::optional<AccountInfo> getAccountInfo(int login) override { return fills_.getAccountInfo(login); }
+    std::optional<TradeResult> getTicketInfo(const std::string& ticket) override { return fills_.getTicketInfo(ticket); }
+    std::vector<std::string>   getSymbols() override { return fills_.getSymbols(); }
+
+    TradeResult executeTrade(const TradeRequest& request) override {
+        std::this_thread::sleep_for(delay_);
+        TradeResult result = fills_.executeTrade(request);
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_[request.requestId] = Clock::now();
+        return result;
+    }
+
+    Clock::time_point finished(const std::string& requestId) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return finished_[requestId];
+    }
+
+private:
+    NullBroker                                         fills_;
+    std::chrono::milliseconds                          delay_;
+    std::mutex                                         mutex_;
+    std::unordered_map<std::string, Clock::time_point> finished_;
+};
+
+/// Arrival times of result callbacks, by request ID.
+class Deliveries {
+public:
+    DealProcessor::ResultCallback track(const std::string& requestId) {
+        return [this, requestId](const TradeResult& result) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            arrived_[requestId] = Clock::now();
+            statuses_[requestId] = result.status;
+            cv_.notify_all();
+        };
+    }
+
+    /// Arrival time of `requestId`, or nullopt if it has not arrived within `timeout`.
+    std::optional<Clock::time_point> wait(const std::string& requestId, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!cv_.wait_for(lock, timeout, [&] { return arrived_.count(requestId) > 0; })) return std::nullopt;
+        return arrived_[requestId];
+    }
+
+    TradeStatus status(const std::string& requestId) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return statuses_[requestId];
+    }
+
+private:
+    std::mutex                                         mutex_;
+    std::condition_variable                            cv_;
+    std::unordered_map<std::string, Clock::time_point> arrived_;
+    std::unordered_map<std::string, TradeStatus>       statuses_;
+};
+
+static TradeRequest makeRequest(const std::string& symbol) {
+    TradeRequest request;
+    request.clientId  = "CLIENT_1";
+    request.requestId = TradeRequest::generateRequestId(request.clientId);
+    request.tradeType = TradeType::BUY;
+    request.symbol    = symbol;
+    request.volume    = 0.1;
+    request.timestamp = std::chrono::system_clock::now();
+    return request;
+}
+
+static ProcessorConfig batchedConfig(int flushUs) {
+    ProcessorConfig config;
+    config.numWorkers      = 1;
+    config.maxRetries      = 0;
+    config.resultBatchSize = 32;
+    config.resultFlushUs   = flushUs;
+    return config;
+}
+
+static void idleWorkerFlushesAtDeadline() {
+    Logger logger("", LogLevel::ERROR);
+    NullBroker broker;
+    broker.connect("test", 1, "");
+    DealProcessor processor(broker, logger, batchedConfig(20000));
+    processor.start();
+
+    Deliveries deliveries;
+    TradeRequest request = makeRequest("NOSUCH");
+    auto submitted = Clock::now();
+    processor.submit(request, deliveries.track(request.requestId));
+
+    // Held for the 20ms deadline, not the rest of the batch
+    auto arrived = deliveries.wait(request.requestId, std::chrono::seconds(5));
+    CHECK(arrived.has_value());
+    if (arrived) CHECK(*arrived - submitted >= std::chrono::milliseconds(15));
+    CHECK(deliveries.status(request.requestId) == TradeStatus::INVALID_PARAMS);
+    CHECK(processor.resultFlushes() == 1);
+    processor.stop();
+}
+
+static void steadyTrickleFlushesAtDeadline() {
+    Logger logger("", LogLevel::ERROR);
+    NullBroker broker;
+    broker.connect("test", 1, "");
+    DealProcessor processor(broker, logger, batchedConfig(20000));
+    processor.start();
+
+    // A steady trickle of rejections, fewer than a batch: the first result
+    // must still go out at its deadline, while requests keep arriving.
+    Deliveries deliveries;
+    TradeRequest first = makeRequest("NOSUCH");
+    auto submitted = Clock::now();
+    processor.submit(first, deliveries.track(first.requestId));
+    std::optional<Clock::time_point> arrived;
+    for (int i = 0; i < 30 && !arrived; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        TradeRequest next = makeRequest("NOSUCH");
+        processor.submit(next, deliveries.track(next.requestId));
+        arrived = deliveries.wait(first.requestId, std::chrono::milliseconds(0));
+    }
+    CHECK(arrived.has_value());
+    if (arrived) CHECK(*arrived - submitted >= std::chrono::milliseconds(15));
+    processor.stop();
+    CHECK(processor.resultFlushes() >= 2);
+}
+
+static void fastBrokerCallsBatch() {
+    Logger logger("", LogLevel::ERROR);
+    NullBroker broker;
+    broker.connect("test", 1, "");
+    DealProcessor processor(broker, logger, batchedConfig(10 * 1000 * 1000));
+    processor.start();
+
+    // Only the first execute, not yet timed, flushes the rejection before
+    // it; the fills end far inside the 10s deadline and wait for stop()
+    Deliveries deliveries;
+    TradeRequest rejected = makeRequest("NOSUCH");
+    processor.submit(rejected, deliveries.track(rejected.requestId));
+    std::vector<TradeRequest> fills;
+    for (int i = 0; i < 20; ++i) {
+        fills.push_back(makeRequest("EURUSD"));
+        processor.submit(fills.back(), deliveries.track(fills.back().requestId));
+    }
+    CHECK(deliveries.wait(rejected.requestId, std::chrono::seconds(5)).has_value());
+    processor.stop();
+    for (const auto& fill : fills) CHECK(deliveries.status(fill.requestId) == TradeStatus::SUCCESS);
+    CHECK(processor.resultFlushes() <= 3);
+}
+
+static void slowBrokerCallFlushesFirst() {
+    Logger logger("", LogLevel::ERROR);
+    DelayedBroker broker(std::chrono::milliseconds(40));
+    broker.connect("test", 1, "");
+    DealProcessor processor(broker, logger, batchedConfig(100 * 1000));
+    processor.start();
+
+    // Fills end at 40, 80, 120ms...: the first one's 100ms deadline falls
+    // inside the fourth call, so the worker flushes before making it
+    Deliveries deliveries;
+    std::vector<TradeRequest> fills;
+    for (int i = 0; i < 6; ++i) {
+        fills.push_back(makeRequest("EURUSD"));
+        processor.submit(fills.back(), deliveries.track(fills.back().requestId));
+    }
+    for (const auto& fill : fills) {
+        auto arrived = deliveries.wait(fill.requestId, std::chrono::seconds(5));
+        CHECK(arrived.has_value());
+        if (arrived) CHECK(*arrived - broker.finished(fill.requestId) <= std::chrono::milliseconds(110));
+    }
+    CHECK(processor.resultFlushes() >= 2);
+    processor.stop();
+}
+
+int main() {
+    return runTests({
+        {"idle worker flushes at the deadline", idleWorkerFlushesAtDeadline},
+        {"steady trickle flushes at the deadline", steadyTrickleFlushesAtDeadline},
+        {"fast broker calls batch", fastBrokerCallsBatch},
+        {"flushed before a slow broker call", slowBrokerCallFlushesFirst},
+    });
+}
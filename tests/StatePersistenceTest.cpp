@@ -0,0 +1,211 @@
+#include "TestSupport.h"
+#include "persistence/StatePersistence.h"
+#include "models/RequestId.h"
+
+#include <fstream>
+#include <map>
+
+namespace fs = std::filesystem;
+
+static TradeResult makeResult(uint64_t seq, TradeStatus status, const std::string& ticket) {
+    TradeResult result;
+    result.requestId      = RequestIdFormat::format("CLIENT_1", seq);
+    result.clientId       = "CLIENT_1";
+    result.symbol         = "EURUSD";
+    result.status         = status;
+    result.mtTicketId     = ticket;
+    result.executionPrice = status == TradeStatus::SUCCESS ? 1.08 : 0.0;
+    result.errorMessage   = status == TradeStatus::SUCCESS ? "" : "rejected";
+    result.retryCount     = 0;
+    result.timestamp      = std::chrono::system_clock::now();
+    return result;
+}
+
+static AccountState makeAccount(const std::string& server, int login, double balance) {
+    AccountState state;
+    state.server  = server;
+    state.account = AccountInfo{login, balance, balance, balance, 0.0, "USD"};
+    return state;
+}
+
+/// Everything a restart restores, keyed by request ID (last write wins).
+struct Restored {
+    std::map<std::string, TradeResult>   results;
+    std::vector<AccountState>            accounts;
+    StatePersistence::RestoreStats       stats;
+};
+
+static Restored restore(Logger& logger, const std::string& directory) {
+    Restored restored;
+    StatePersistence persistence(logger, directory);
+    persistence.open();
+    restored.accounts = persistence.restoredAccounts();
+    restored.stats = persistence.restoreResults([&](const TradeResult& result) {
+        restored.results[result.requestId] = result;
+    });
+    return restored;
+}
+
+static void snapshotAndJournalRoundTrip() {
+    Logger logger("", LogLevel::ERROR);
+    TempDir dir("state_roundtrip");
+    {
+        StatePersistence persistence(logger, dir.path());
+        persistence.open();
+        persistence.restoreResults([](const TradeResult&) {});
+        persistence.setAccountSource([] {
+            return std::vector<AccountState>{makeAccount("primary", 1001, 5000.0),
+                                             makeAccount("backup", 1001, 7000.0)};
+        });
+        StateJournal& journal = persistence.journal();
+        persistence.start([&](uint64_t& closed, std::string& error) { return journal.rotate(closed, error); },
+                          std::chrono::milliseconds(0));
+
+        for (uint64_t seq = 1; seq <= 3; ++seq) journal.append(makeResult(seq, TradeStatus::SUCCESS, "T" + std::to_string(seq)));
+        CHECK(journal.commit());
+        CHECK(persistence.snapshotNow());
+
+        // Folded segments are deleted once the snapshot is in place
+        CHECK(fs::exists(fs::path(dir.path()) / "state.snap"));
+        CHECK(StateJournal::listSegments(dir.path()) == std::vector<uint64_t>{1});
+
+        // After the snapshot: one replacement and one new result
+        journal.append(makeResult(2, TradeStatus::REJECTED, ""));
+        journal.append(makeResult(4, TradeStatus::SUCCESS, "T4"));
+        CHECK(journal.commit());
+        // No rotate function left, so no final snapshot: the tail stays in
+        // the journal, as after a crash
+        persistence.start(nullptr, std::chrono::milliseconds(0));
+    }
+
+    Restored restored = restore(logger, dir.path());
+    CHECK(restored.stats.snapshotResults == 3);
+    CHECK(restored.stats.journalResults == 2);
+    CHECK(restored.stats.anySequence && restored.stats.maxSequence == 4);
+    CHECK(restored.results.size() == 4);
+
+    const TradeResult& replaced = restored.results[RequestIdFormat::format("CLIENT_1", 2)];
+    CHECK(replaced.status == TradeStatus::REJECTED);
+    CHECK(replaced.errorMessage == "rejected");
+    const TradeResult& kept = restored.results[RequestIdFormat::format("CLIENT_1", 3)];
+    CHECK(kept.status == TradeStatus::SUCCESS);
+    CHECK(kept.mtTicketId == "T3");
+    CHECK(kept.symbol == "EURUSD");
+    CHECK(kept.executionPrice == 1.08);
+
+    // Accounts are keyed by (server, login)
+    CHECK(restored.accounts.size() == 2);
+    for (const auto& state : restored.accounts) {
+        CHECK(state.account.login == 1001);
+        CHECK(state.account.balance == (state.server == "primary" ? 5000.0 : 7000.0));
+        CHECK(state.account.currency == "USD");
+    }
+}
+
+static void tornTailIsDropped() {
+    Logger logger("", LogLevel::ERROR);
+    TempDir dir("state_torn");
+    std::string segmentPath;
+    {
+        StateJournal journal(dir.path(), StateJournal::Options{});
+        std::string error;
+        CHECK(journal.open(0, error));
+        journal.append(makeResult(1, TradeStatus::SUCCESS, "T1"));
+        journal.append(makeResult(2, TradeStatus::SUCCESS, "T2"));
+        CHECK(journal.commit());
+        segmentPath = journal.segmentPath(0);
+    }
+    uint64_t intact = fs::file_size(segmentPath);
+
+    // A crash mid-write: half a record header at the end
+    {
+        std::ofstream out(segmentPath, std::ios::binary | std::ios::app);
+        out.write("\x40\x00\x00", 3);
+    }
+    CHECK(StateJournal::replay(segmentPath, [](TradeResult&&) {}) == intact);
+
+    Restored restored = restore(logger, dir.path());
+    CHECK(restored.stats.journalResults == 2);
+    CHECK(restored.results.size() == 2);
+}
+
+static void rotationFailureKeepsAppending() {
+    Logger logger("", LogLevel::ERROR);
+    TempDir dir("state_rotation");
+    {
+        StatePersistence persistence(logger, dir.path());
+        persistence.open();
+        persistence.restoreResults([](const TradeResult&) {});
+        StateJournal& journal = persistence.journal();
+        persistence.start([&](uint64_t& closed, std::string& error) { return journal.rotate(closed, error); },
+                          std::chrono::milliseconds(0));
+        CHECK(journal.segment() == 0);
+
+        // The next segment cannot be created: a directory is in its place
+        fs::create_directories(journal.segmentPath(1));
+        journal.append(makeResult(1, TradeStatus::SUCCESS, "T1"));
+        CHECK(journal.commit());
+        CHECK(!persistence.snapshotNow());
+        CHECK(journal.segment() == 0);
+        CHECK(!fs::exists(fs::path(dir.path()) / "state.snap"));
+
+        // Still appending to segment 0
+        journal.append(makeResult(2, TradeStatus::SUCCESS, "T2"));
+        CHECK(journal.commit());
+        CHECK(journal.recordsInSegment() == 2);
+
+        // The retry folds everything written meanwhile
+        fs::remove(journal.segmentPath(1));
+        CHECK(persistence.snapshotNow());
+        CHECK(journal.segment() == 1);
+        journal.append(makeResult(3, TradeStatus::SUCCESS, "T3"));
+        persistence.stop();
+    }
+
+    Restored restored = restore(logger, dir.path());
+    CHECK(restored.results.size() == 3);
+    CHECK(restored.stats.snapshotResults == 3);
+    CHECK(restored.stats.journalResults == 0);
+}
+
+static void snapshotKeepsNewestResults() {
+    Logger logger("", LogLevel::ERROR);
+    TempDir dir("state_retention");
+    {
+        StatePersistence persistence(logger, dir.path());
+        persistence.setRetainResults(100);
+        persistence.open();
+        persistence.restoreResults([](const TradeResult&) {});
+        persistence.setAccountSource([] { return std::vector<AccountState>{makeAccount("primary", 1001, 5000.0)}; });
+        StateJournal& journal = persistence.journal();
+        persistence.start([&](uint64_t& closed, std::string& error) { return journal.rotate(closed, error); },
+                          std::chrono::milliseconds(0));
+
+        // Each round adds 60 results; the snapshot never holds more than 100
+        for (uint64_t round = 0; round < 5; ++round) {
+            for (uint64_t seq = round * 60 + 1; seq <= round * 60 + 60; ++seq) {
+                journal.append(makeResult(seq, TradeStatus::SUCCESS, "T" + std::to_string(seq)));
+            }
+            CHECK(journal.commit());
+            CHECK(persistence.snapshotNow());
+        }
+        persistence.stop();
+    }
+
+    Restored restored = restore(logger, dir.path());
+    CHECK(restored.stats.snapshotResults == 100);
+    CHECK(restored.results.size() == 100);
+    CHECK(restored.stats.maxSequence == 300);
+    CHECK(restored.results.count(RequestIdFormat::format("CLIENT_1", 200)) == 0);
+    CHECK(restored.results[RequestIdFormat::format("CLIENT_1", 201)].mtTicketId == "T201");
+    CHECK(restored.accounts.size() == 1);
+}
+
+int main() {
+    return runTests({
+        {"snapshot and journal round trip", snapshotAndJournalRoundTrip},
+        {"torn tail is dropped", tornTailIsDropped},
+        {"rotation failure keeps appending", rotationFailureKeepsAppending},
+        {"snapshot keeps the newest results", snapshotKeepsNewestResults},
+    });
+}
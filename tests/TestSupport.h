@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <unistd.h>
+
+/// Minimal test support: CHECK records a failure (with file:line) and goes
+/// on; runTests() runs each case and returns the exit code for main().
+
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(...)                                                             \
+    do {                                                                       \
+        if (!(__VA_ARGS__)) {                                                  \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n",                  \
+                         __FILE__, __LINE__, #__VA_ARGS__);                    \
+            ++testFailures();                                                  \
+        }                                                                      \
+    } while (0)
+
+struct TestCase {
+    const char*           name;
+    std::function<void()> run;
+};
+
+inline int runTests(std::initializer_list<TestCase> tests) {
+    for (const auto& test : tests) {
+        int before = testFailures();
+        test.run();
+        std::printf("%s %s\n", testFailures() == before ? "PASS" : "FAIL", test.name);
+    }
+    return testFailures() == 0 ? 0 : 1;
+}
+
+/// A fresh directory under the system temp dir, removed on destruction.
+class TempDir {
+public:
+    explicit TempDir(const std::string& name) {
+        path_ = (std::filesystem::temp_directory_path() /
+                 (name + "." + std::to_string(::getpid()) + "." +
+                  std::to_string(std::chrono::steady_clock::now().time_since_epoch().count())))
+                    .string();
+        std::filesystem::create_directories(path_);
+    }
+    ~TempDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(path_, ec);
+    }
+
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};